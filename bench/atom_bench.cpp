@@ -0,0 +1,45 @@
+﻿#include <xercesc/xercesc_utils.hpp>
+#include "bench.hpp"
+
+using namespace xercesc_utils;
+using namespace xercesc_utils::bench;
+
+/// Name-heavy traversal of 10000 item catalog: walk all items and find their children,
+/// with string names(prefixes resolved on each call) against interned atoms and compiled atom paths.
+XERCESC_BENCHMARK(atom_traversal)
+{
+	const std::size_t items = 10000;
+	auto doc = load(make_catalog(items));
+	auto * root = doc->getDocumentElement();
+
+	measure("find_child/next_sibling, string names", [&]
+	{
+		for (auto * item = find_child(root, "c:item"); item; item = next_sibling(item, "c:item"))
+			consume(find_child(item, "m:note"));
+	}, 0, items);
+
+	auto item_atom = intern_name(root, "c:item");
+	auto note_atom = intern_name(root, "m:note");
+	measure("find_child/next_sibling, atoms", [&]
+	{
+		for (auto * item = find_child(root, item_atom); item; item = next_sibling(item, item_atom))
+			consume(find_child(item, note_atom));
+	}, 0, items);
+
+	measure("find_path, string path", [&]
+	{
+		for (auto * item = find_child(root, "c:item"); item; item = next_sibling(item, "c:item"))
+			consume(find_path(item, "m:note"));
+	}, 0, items);
+
+	auto note_path = compile_path(root, "c:item/m:note");
+	auto item_note_path = compile_path(find_child(root, item_atom), "m:note");
+	measure("find_path, atom_path", [&]
+	{
+		for (auto * item = find_child(root, item_atom); item; item = next_sibling(item, item_atom))
+			consume(find_path(item, item_note_path));
+	}, 0, items);
+
+	measure("find_path from root, string path", [&] { consume(find_path(root, "c:item/m:note")); });
+	measure("find_path from root, atom_path",   [&] { consume(find_path(root, note_path)); });
+}
@@ -0,0 +1,83 @@
+﻿#pragma once
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace xercesc_utils::bench
+{
+	/************************************************************************/
+	/*                     minimal benchmark harness                        */
+	/************************************************************************/
+	/// XERCESC_BENCHMARK functions are registered at startup and run by main in registration order,
+	/// optional command line argument selects benchmarks whose name contains it:
+	///
+	///   xercesc-utils-bench frozen
+	///
+	/// Xercesc is initialized with counting memory manager, so DOM memory can be measured, see xercesc_allocated.
+	struct benchmark
+	{
+		const char * name;
+		void (*run)();
+	};
+
+	std::vector<benchmark> & registry();
+
+	struct registrar
+	{
+		registrar(const char * name, void (*run)()) { registry().push_back({name, run}); }
+	};
+
+	struct result
+	{
+		double seconds;         // per operation
+		std::size_t iterations;
+	};
+
+	/// value sink, keeps results of measured operations from being optimized away
+	void consume(std::size_t value) noexcept;
+	inline void consume(const void * ptr) noexcept { consume(reinterpret_cast<std::size_t>(ptr)); }
+
+	/// prints label, time per operation and throughput, if bytes or items per operation are given
+	void report(std::string_view label, const result & res, std::size_t bytes = 0, std::size_t items = 0);
+	void report_memory(std::string_view label, std::size_t bytes);
+
+	/// bytes currently allocated through xercesc memory manager: documents, parsers, serializers, etc.
+	std::size_t xercesc_allocated() noexcept;
+
+	/// catalog document used by most benchmarks: items with attributes, namespaced children, text and entities
+	///   <c:catalog xmlns:c="urn:catalog" xmlns:m="urn:meta">
+	///     <c:item id="1" m:flag="yes"><c:name>item 1</c:name><c:price>1.50</c:price><m:note>note &amp; 1</m:note></c:item>
+	std::string make_catalog(std::size_t items);
+
+	/// runs op in growing batches until min_time has passed, time is averaged over all runs except warm up one
+	template <class Op>
+	result measure(std::string_view label, Op && op, std::size_t bytes = 0, std::size_t items = 0, double min_time = 0.5)
+	{
+		using clock = std::chrono::steady_clock;
+		op();
+
+		std::size_t iterations = 0, batch = 1;
+		double elapsed = 0;
+		auto start = clock::now();
+		for (;;)
+		{
+			for (std::size_t i = 0; i < batch; ++i) op();
+			iterations += batch;
+
+			elapsed = std::chrono::duration<double>(clock::now() - start).count();
+			if (elapsed >= min_time) break;
+			if (batch < 1024 * 1024) batch *= 2;
+		}
+
+		result res {elapsed / iterations, iterations};
+		report(label, res, bytes, items);
+		return res;
+	}
+}
+
+#define XERCESC_BENCHMARK(name)                                                           \
+	static void name();                                                                   \
+	static const ::xercesc_utils::bench::registrar name##_registrar(#name, &name);        \
+	static void name()
@@ -0,0 +1,92 @@
+﻿#include <optional>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_binding.hpp>
+#include "bench.hpp"
+
+using namespace xercesc_utils;
+using namespace xercesc_utils::bench;
+
+namespace
+{
+	struct catalog_item
+	{
+		long id = 0;
+		std::string flag;
+		std::string name;
+		double price = 0;
+		std::optional<std::string> note;
+	};
+}
+
+template <> struct xercesc_utils::xml_binding<catalog_item>
+{
+	static constexpr xml_field fields[] = {
+		bind_field<&catalog_item::id>("@id"),
+		bind_field<&catalog_item::flag>("@m:flag"),
+		bind_field<&catalog_item::name>("c:name"),
+		bind_field<&catalog_item::price>("c:price"),
+		bind_field<&catalog_item::note>("m:note"),
+	};
+};
+
+namespace
+{
+	// the same with path helpers, as written before data binding
+	void load_item(xercesc::DOMElement * element, catalog_item & item)
+	{
+		item.id = std::stol(get_attribute_text(element, "id"));
+		item.flag = get_attribute_text(element, "m:flag");
+		item.name = get_path_text(element, "c:name");
+		item.price = std::stod(get_path_text(element, "c:price"));
+
+		if (auto * note = find_path(element, "m:note")) item.note = get_text_content(note);
+		else item.note.reset();
+	}
+
+	void save_item(xercesc::DOMElement * element, const catalog_item & item)
+	{
+		set_attribute_text(element, "id", std::to_string(item.id));
+		set_attribute_text(element, "m:flag", item.flag);
+		set_path_text(element, "c:name", item.name);
+		set_path_text(element, "c:price", std::to_string(item.price));
+		if (item.note) set_path_text(element, "m:note", *item.note);
+	}
+}
+
+/// load_struct/save_struct against hand-written path helper calls on all items of 10000 item catalog
+XERCESC_BENCHMARK(binding_vs_helpers)
+{
+	const std::size_t items = 10000;
+	auto doc = load(make_catalog(items));
+	auto * root = doc->getDocumentElement();
+
+	std::vector<xercesc::DOMElement *> elements;
+	for (auto * element = find_child(root, "c:item"); element; element = next_sibling(element, "c:item"))
+		elements.push_back(element);
+
+	std::vector<catalog_item> objects(elements.size());
+
+	measure("hand-written load", [&]
+	{
+		for (std::size_t i = 0; i < elements.size(); ++i) load_item(elements[i], objects[i]);
+		consume(objects.back().name.size());
+	}, 0, items);
+
+	measure("load_struct", [&]
+	{
+		for (std::size_t i = 0; i < elements.size(); ++i) load_struct(elements[i], objects[i]);
+		consume(objects.back().name.size());
+	}, 0, items);
+
+	measure("hand-written save", [&]
+	{
+		for (std::size_t i = 0; i < elements.size(); ++i) save_item(elements[i], objects[i]);
+		consume(elements.back());
+	}, 0, items);
+
+	measure("save_struct", [&]
+	{
+		for (std::size_t i = 0; i < elements.size(); ++i) save_struct(elements[i], objects[i]);
+		consume(elements.back());
+	}, 0, items);
+}
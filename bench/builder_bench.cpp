@@ -0,0 +1,42 @@
+﻿#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_builder.hpp>
+#include "bench.hpp"
+
+using namespace xercesc_utils;
+using namespace xercesc_utils::bench;
+
+/// Generating document with 10000 fields(1000 records of 10 fields, data/rN/fM) from empty document:
+/// set_path_text from document for each field against document_builder set_text and apply.
+XERCESC_BENCHMARK(builder_10k_fields)
+{
+	const std::size_t records = 1000, fields = 10;
+
+	std::vector<std::pair<xml_string, std::string>> values;
+	for (std::size_t r = 0; r < records; ++r)
+		for (std::size_t f = 0; f < fields; ++f)
+			values.emplace_back(to_xmlch("data/r" + std::to_string(r) + "/f" + std::to_string(f)), std::to_string(r * fields + f));
+
+	auto count = values.size();
+
+	measure("set_path_text from document", [&]
+	{
+		auto doc = create_empty_document();
+		for (auto & [path, value] : values) set_path_text(doc.get(), path, value);
+		consume(doc.get());
+	}, 0, count);
+
+	measure("document_builder::set_text", [&]
+	{
+		auto doc = create_empty_document();
+		document_builder builder(doc.get());
+		for (auto & [path, value] : values) builder.set_text(xml_string_view(path), value);
+		consume(doc.get());
+	}, 0, count);
+
+	measure("document_builder::apply", [&]
+	{
+		auto doc = create_empty_document();
+		document_builder(doc.get()).apply(values);
+		consume(doc.get());
+	}, 0, count);
+}
@@ -0,0 +1,43 @@
+﻿#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_frozen.hpp>
+#include "bench.hpp"
+
+using namespace xercesc_utils;
+using namespace xercesc_utils::bench;
+
+/// frozen_document against DOM: path lookup latency, text of all items and memory of 10000 item catalog.
+/// DOM memory is what xercesc memory manager holds for the document, frozen one - memory_size.
+XERCESC_BENCHMARK(frozen_vs_dom)
+{
+	const std::size_t items = 10000;
+	auto xml = make_catalog(items);
+	load(xml); // parser and other one time allocations
+
+	auto before = xercesc_allocated();
+	auto doc = load(xml);
+	report_memory("DOM document", xercesc_allocated() - before);
+
+	auto frozen = freeze(doc.get());
+	report_memory("frozen_document", frozen.memory_size());
+
+	measure("freeze", [&] { consume(freeze(doc.get()).memory_size()); }, 0, items);
+
+	for (auto * path : {"c:catalog/c:item/c:name", "c:catalog/c:item/m:missing"})
+	{
+		auto suffix = std::string(", ") + path;
+		measure("DOM find_path" + suffix,    [&] { consume(find_path(doc.get(), path)); });
+		measure("frozen find_path" + suffix, [&] { consume(frozen.find_path(path) ? 1 : 0); });
+	}
+
+	measure("DOM get_path_text of all items", [&]
+	{
+		for (auto * item = find_path(doc.get(), "c:catalog/c:item"); item; item = next_sibling(item, "c:item"))
+			consume(get_path_text(item, "c:name").size());
+	}, 0, items);
+
+	measure("frozen get_path_text of all items", [&]
+	{
+		for (auto item = frozen.find_path("c:catalog/c:item"); item; item = item.next_sibling("c:item"))
+			consume(item.get_path_text("c:name").size());
+	}, 0, items);
+}
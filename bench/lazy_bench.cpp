@@ -0,0 +1,46 @@
+﻿#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_lazy.hpp>
+#include "bench.hpp"
+
+using namespace xercesc_utils;
+using namespace xercesc_utils::bench;
+
+/// lazy_document against full load of 10000 item catalog held in memory:
+/// time to first query(open and get text of one item) and memory of index plus one materialized item against DOM.
+XERCESC_BENCHMARK(lazy_vs_load)
+{
+	const std::size_t items = 10000;
+	auto storage = std::make_shared<const std::string>(make_catalog(items));
+	const std::string & xml = *storage;
+	load(xml); // parser and other one time allocations
+
+	{
+		auto before = xercesc_allocated();
+		auto doc = load(xml);
+		report_memory("DOM document", xercesc_allocated() - before);
+	}
+
+	{
+		lazy_document doc(xml, storage);
+		auto before = xercesc_allocated();
+		consume(doc.element(items / 2));
+		report_memory("lazy index", doc.index_memory_size());
+		report_memory("lazy materialized item", xercesc_allocated() - before);
+	}
+
+	measure("load + get_path_text of middle item", [&]
+	{
+		auto doc = load(xml);
+		auto * item = find_path(doc.get(), "c:catalog/c:item");
+		for (std::size_t i = 0; i < items / 2; ++i) item = next_sibling(item, "c:item");
+		consume(get_path_text(item, "c:name").size());
+	}, xml.size());
+
+	measure("lazy open + get_path_text of middle item", [&]
+	{
+		lazy_document doc(xml, storage);
+		consume(get_path_text(doc.element(items / 2), "c:name").size());
+	}, xml.size());
+
+	measure("lazy open, index only", [&] { consume(lazy_document(xml, storage).size()); }, xml.size());
+}
@@ -0,0 +1,120 @@
+﻿#include <atomic>
+#include <cstdio>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/framework/MemoryManager.hpp>
+#include <xercesc/util/XMLUni.hpp>
+#include "bench.hpp"
+
+namespace xercesc_utils::bench
+{
+	namespace
+	{
+		/// counts bytes allocated by xercesc, size of each block is kept in front of it
+		class counting_memory_manager : public xercesc::MemoryManager
+		{
+			static constexpr std::size_t header_size = alignof(std::max_align_t);
+			std::atomic_size_t m_allocated = 0;
+
+		public:
+			std::size_t allocated() const noexcept { return m_allocated.load(std::memory_order_relaxed); }
+
+			xercesc::MemoryManager * getExceptionMemoryManager() override { return this; }
+
+			void * allocate(XMLSize_t size) override
+			{
+				auto * block = static_cast<char *>(::operator new(size + header_size));
+				*reinterpret_cast<std::size_t *>(block) = size;
+				m_allocated.fetch_add(size, std::memory_order_relaxed);
+				return block + header_size;
+			}
+
+			void deallocate(void * ptr) override
+			{
+				if (not ptr) return;
+
+				auto * block = static_cast<char *>(ptr) - header_size;
+				m_allocated.fetch_sub(*reinterpret_cast<std::size_t *>(block), std::memory_order_relaxed);
+				::operator delete(block);
+			}
+		};
+
+		counting_memory_manager g_memory_manager;
+		volatile std::size_t g_sink = 0;
+	}
+
+	std::vector<benchmark> & registry()
+	{
+		static std::vector<benchmark> benchmarks;
+		return benchmarks;
+	}
+
+	void consume(std::size_t value) noexcept
+	{
+		g_sink = g_sink + value;
+	}
+
+	std::size_t xercesc_allocated() noexcept
+	{
+		return g_memory_manager.allocated();
+	}
+
+	void report(std::string_view label, const result & res, std::size_t bytes /* = 0 */, std::size_t items /* = 0 */)
+	{
+		std::printf("  %-56.*s %12.3f us/op", static_cast<int>(label.size()), label.data(), res.seconds * 1e6);
+		if (bytes) std::printf(" %10.1f MB/s", static_cast<double>(bytes) / res.seconds / (1024 * 1024));
+		if (items) std::printf(" %14.0f items/s", static_cast<double>(items) / res.seconds);
+		std::printf("\n");
+	}
+
+	void report_memory(std::string_view label, std::size_t bytes)
+	{
+		std::printf("  %-56.*s %12.1f KB\n", static_cast<int>(label.size()), label.data(), static_cast<double>(bytes) / 1024);
+	}
+
+	std::string make_catalog(std::size_t items)
+	{
+		std::string xml = R"(<?xml version="1.0" encoding="utf-8"?>)" "\n"
+		                  R"(<c:catalog xmlns:c="urn:catalog" xmlns:m="urn:meta">)" "\n";
+
+		for (std::size_t i = 1; i <= items; ++i)
+		{
+			auto number = std::to_string(i);
+			xml += "  <c:item id=\"" + number + "\" m:flag=\"yes\"><c:name>item " + number + "</c:name>"
+			       "<c:price>" + number + ".50</c:price><m:note>note &amp; " + number + "</m:note></c:item>\n";
+		}
+
+		xml += "</c:catalog>\n";
+		return xml;
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	using namespace xercesc_utils::bench;
+	std::string_view filter = argc > 1 ? argv[1] : "";
+
+	xercesc::XMLPlatformUtils::Initialize(xercesc::XMLUni::fgXercescDefaultLocale, nullptr, nullptr, &g_memory_manager);
+
+	int exit_code = 0;
+	for (auto & item : registry())
+	{
+		if (std::string_view(item.name).find(filter) == std::string_view::npos) continue;
+
+		std::printf("%s\n", item.name);
+		try
+		{
+			item.run();
+		}
+		catch (std::exception & ex)
+		{
+			std::fprintf(stderr, "  %s failed: %s\n", item.name, ex.what());
+			exit_code = 1;
+		}
+	}
+
+	xercesc_utils::xercesc_free();
+	return exit_code;
+}
@@ -0,0 +1,27 @@
+﻿#include <xercesc/xercesc_utils.hpp>
+#include "bench.hpp"
+
+using namespace xercesc_utils;
+using namespace xercesc_utils::bench;
+
+/// rename_subtree of whole ~100k node document(elements, attributes and text nodes), in_place against rebuild.
+/// Rename changes document, so each operation parses it again: parse alone is measured as baseline to subtract.
+XERCESC_BENCHMARK(rename_subtree_100k)
+{
+	// item: 4 elements, 3 text nodes, 2 attributes, plus whitespace text after it, 10 nodes
+	const std::size_t items = 10000;
+	auto xml = make_catalog(items);
+
+	measure("parse only", [&] { consume(load(xml).get()); });
+	measure("parse + rename_subtree, in_place", [&]
+	{
+		auto doc = load(xml);
+		consume(rename_subtree(doc->getDocumentElement(), "urn:renamed", "r", rename_mode::in_place));
+	}, 0, items);
+
+	measure("parse + rename_subtree, rebuild", [&]
+	{
+		auto doc = load(xml);
+		consume(rename_subtree(doc->getDocumentElement(), "urn:renamed", "r", rename_mode::rebuild));
+	}, 0, items);
+}
@@ -0,0 +1,48 @@
+﻿#include <xercesc/xercesc_utils.hpp>
+#include "bench.hpp"
+
+using namespace xercesc_utils;
+using namespace xercesc_utils::bench;
+
+/// DOMXPathNSResolverImpl lookups with typical number of bindings: 8 prefixes plus one missing,
+/// through virtual DOMXPathNSResolver interface(null terminated strings) and through xml_string_view overloads.
+XERCESC_BENCHMARK(resolver_lookup)
+{
+	auto resolver = create_resolver({
+		{"c", "urn:catalog"}, {"m", "urn:meta"}, {"xsi", "http://www.w3.org/2001/XMLSchema-instance"},
+		{"soap", "http://schemas.xmlsoap.org/soap/envelope/"}, {"wsa", "http://www.w3.org/2005/08/addressing"},
+		{"ds", "http://www.w3.org/2000/09/xmldsig#"}, {"o", "urn:orders"}, {"p", "urn:payments"},
+	});
+
+	std::vector<xml_string> prefixes, uris;
+	for (auto * prefix : {"c", "m", "xsi", "soap", "wsa", "ds", "o", "p", "missing"})
+	{
+		prefixes.push_back(to_xmlch(prefix));
+		auto * uri = resolver->lookupNamespaceURI(prefixes.back());
+		uris.push_back(uri ? xml_string(uri) : to_xmlch("urn:missing"));
+	}
+
+	const xercesc::DOMXPathNSResolver & base = *resolver;
+	auto count = prefixes.size();
+
+	measure("lookupNamespaceURI, virtual", [&]
+	{
+		for (auto & prefix : prefixes) consume(base.lookupNamespaceURI(prefix.c_str()));
+	}, 0, count);
+
+	measure("lookupNamespaceURI, xml_string_view", [&]
+	{
+		for (auto & prefix : prefixes) consume(resolver->lookupNamespaceURI(xml_string_view(prefix)));
+	}, 0, count);
+
+	measure("lookupPrefix, virtual", [&]
+	{
+		for (auto & uri : uris) consume(base.lookupPrefix(uri.c_str()));
+	}, 0, count);
+
+	measure("clone + release", [&]
+	{
+		DOMXPathNSResolverImplPtr clone(resolver->clone());
+		consume(clone.get());
+	});
+}
@@ -0,0 +1,61 @@
+﻿#include <thread>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_serializer.hpp>
+#include "bench.hpp"
+
+using namespace xercesc_utils;
+using namespace xercesc_utils::bench;
+
+/// save with per-thread cached DOMLSSerializer against serializer created and configured for each call.
+/// Small documents show setup cost, big ones - serialization itself.
+XERCESC_BENCHMARK(serializer_reuse)
+{
+	for (std::size_t items : {1, 10, 10000})
+	{
+		auto doc = load(make_catalog(items));
+		auto size = save(doc.get()).size();
+		auto suffix = ", " + std::to_string(items) + " items";
+
+		measure("save, cached serializer" + suffix, [&] { consume(save(doc.get()).size()); }, size);
+		measure("save, new serializer"    + suffix, [&]
+		{
+			clear_serializer_cache();
+			consume(save(doc.get()).size());
+		}, size);
+
+		std::string str;
+		measure("save into reused string" + suffix, [&]
+		{
+			str.clear();
+			save(str, doc.get(), pretty_print, XERCESC_LIT("utf-8"), size);
+			consume(str.size());
+		}, size);
+	}
+}
+
+/// native_save_parallel scaling across cores against sequential native_save on 100000 item catalog
+XERCESC_BENCHMARK(native_save_parallel_scaling)
+{
+	const std::size_t items = 100000;
+	auto doc = load(make_catalog(items));
+	auto size = native_save(doc.get()).size();
+
+	std::string str;
+	measure("native_save", [&]
+	{
+		str.clear();
+		native_save(str, doc.get());
+		consume(str.size());
+	}, size, items);
+
+	auto max_threads = std::max(2u, std::thread::hardware_concurrency());
+	for (unsigned nthreads = 2; nthreads <= max_threads; nthreads *= 2)
+	{
+		measure("native_save_parallel, " + std::to_string(nthreads) + " threads", [&]
+		{
+			str.clear();
+			native_save_parallel(str, doc.get(), pretty_print, nthreads);
+			consume(str.size());
+		}, size, items);
+	}
+}
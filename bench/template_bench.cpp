@@ -0,0 +1,96 @@
+﻿#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_serializer.hpp>
+#include <xercesc/xercesc_template.hpp>
+#include "bench.hpp"
+
+using namespace xercesc_utils;
+using namespace xercesc_utils::bench;
+
+namespace
+{
+	const char * const skeleton_xml = R"(<?xml version="1.0" encoding="utf-8"?>
+<response version="2">
+  <header>
+    <id/>
+    <created/>
+    <source system="billing" node="main">billing</source>
+  </header>
+  <status code="0">
+    <text>ok</text>
+  </status>
+  <body>
+    <account/>
+    <balance currency="EUR"/>
+    <limits><daily>1000</daily><monthly>10000</monthly></limits>
+    <comment/>
+  </body>
+</response>)";
+
+	const std::vector<std::string> slots = {
+		"response/header/id", "response/header/created", "response/status/@code",
+		"response/body/account", "response/body/balance", "response/body/comment",
+	};
+}
+
+/// document_template::render against DOM build path for small response document with 6 slots:
+/// filling clone of skeleton with set_path_text, or building the whole document from scratch, then native_save.
+XERCESC_BENCHMARK(template_vs_dom)
+{
+	auto skeleton = load(skeleton_xml);
+	document_template tmpl(skeleton.get(), slots);
+
+	std::vector<std::string_view> values = {"123456789", "2024-01-01T10:00:00", "17", "40817810099910004312", "1520.35", "a < b & c"};
+
+	std::string str;
+	tmpl.render(str, values);
+	auto size = str.size();
+
+	measure("document_template::render", [&]
+	{
+		str.clear();
+		tmpl.render(str, values);
+		consume(str.size());
+	}, size);
+
+	measure("clone skeleton + set_path_text + native_save", [&]
+	{
+		DOMDocumentPtr doc(static_cast<xercesc::DOMDocument *>(skeleton->cloneNode(true)));
+		auto * root = doc->getDocumentElement();
+		set_path_text(root, "header/id", values[0]);
+		set_path_text(root, "header/created", values[1]);
+		set_attribute_text(get_path(root, "status"), "code", values[2]);
+		set_path_text(root, "body/account", values[3]);
+		set_path_text(root, "body/balance", values[4]);
+		set_path_text(root, "body/comment", values[5]);
+
+		str.clear();
+		native_save(str, doc.get());
+		consume(str.size());
+	}, size);
+
+	measure("build from scratch + native_save", [&]
+	{
+		auto doc = create_empty_document();
+		auto * root = acquire_path(doc.get(), "response");
+		set_attribute_text(root, "version", "2");
+		set_path_text(root, "header/id", values[0]);
+		set_path_text(root, "header/created", values[1]);
+		auto * source = acquire_path(root, "header/source");
+		set_attribute_text(source, "system", "billing");
+		set_attribute_text(source, "node", "main");
+		set_text_content(source, "billing");
+		auto * status = acquire_path(root, "status");
+		set_attribute_text(status, "code", values[2]);
+		set_path_text(status, "text", "ok");
+		set_path_text(root, "body/account", values[3]);
+		set_path_text(root, "body/balance", values[4]);
+		set_attribute_text(get_path(root, "body/balance"), "currency", "EUR");
+		set_path_text(root, "body/limits/daily", "1000");
+		set_path_text(root, "body/limits/monthly", "10000");
+		set_path_text(root, "body/comment", values[5]);
+
+		str.clear();
+		native_save(str, doc.get());
+		consume(str.size());
+	}, size);
+}
@@ -0,0 +1,87 @@
+﻿#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_serializer.hpp>
+#include <xercesc/xercesc_writer.hpp>
+#include "bench.hpp"
+
+using namespace xercesc_utils;
+using namespace xercesc_utils::bench;
+
+namespace
+{
+	// same content as make_catalog
+	void write_catalog(std::string & str, std::size_t items)
+	{
+		xml_writer writer(str);
+		writer.write_declaration();
+		writer.start_element("urn:catalog", "c:catalog");
+		writer.namespace_declaration("m", "urn:meta");
+
+		for (std::size_t i = 1; i <= items; ++i)
+		{
+			auto number = std::to_string(i);
+			writer.start_element("urn:catalog", "c:item");
+			writer.attribute("id", number);
+			writer.attribute("urn:meta", "m:flag", "yes");
+			writer.start_element("urn:catalog", "c:name");  writer.text("item " + number);   writer.end_element();
+			writer.start_element("urn:catalog", "c:price"); writer.text(number + ".50");     writer.end_element();
+			writer.start_element("urn:meta", "m:note");     writer.text("note & " + number); writer.end_element();
+			writer.end_element();
+		}
+
+		writer.finish();
+	}
+
+	void build_and_save_catalog(std::string & str, std::size_t items)
+	{
+		auto doc = load(R"(<c:catalog xmlns:c="urn:catalog" xmlns:m="urn:meta"/>)");
+		auto * root = doc->getDocumentElement();
+
+		auto append = [](xercesc::DOMElement * parent, const char * namespace_uri, const char * name, std::string_view text)
+		{
+			auto * element = create_element_ns(parent, namespace_uri, name);
+			parent->appendChild(element);
+			set_text_content(element, text);
+		};
+
+		for (std::size_t i = 1; i <= items; ++i)
+		{
+			auto number = std::to_string(i);
+			auto * item = create_element_ns(root, "urn:catalog", "c:item");
+			root->appendChild(item);
+			set_attribute_text(item, "id", number);
+			set_attribute_ns(item, "urn:meta", "m:flag", "yes");
+			append(item, "urn:catalog", "c:name", "item " + number);
+			append(item, "urn:catalog", "c:price", number + ".50");
+			append(item, "urn:meta", "m:note", "note & " + number);
+		}
+
+		native_save(str, doc.get());
+	}
+}
+
+/// xml_writer against building DOM with create helpers and native_save, output is the same.
+/// DOM path also includes document creation and release, xml_writer - nothing but writing.
+XERCESC_BENCHMARK(writer_vs_dom)
+{
+	for (std::size_t items : {10, 10000})
+	{
+		std::string str;
+		write_catalog(str, items);
+		auto size = str.size();
+		auto suffix = ", " + std::to_string(items) + " items";
+
+		measure("xml_writer" + suffix, [&]
+		{
+			str.clear();
+			write_catalog(str, items);
+			consume(str.size());
+		}, size, items);
+
+		measure("DOM build + native_save" + suffix, [&]
+		{
+			str.clear();
+			build_and_save_catalog(str, items);
+			consume(str.size());
+		}, size, items);
+	}
+}
@@ -0,0 +1,40 @@
+﻿#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_xpath.hpp>
+#include "bench.hpp"
+
+using namespace xercesc_utils;
+using namespace xercesc_utils::bench;
+
+/// native_xpath against find_xpath/select_xpath(Xerces xpath) on expressions both support,
+/// native_xpath is measured both precompiled and parsed on each call(native_find_xpath).
+/// Predicates are not supported by Xerces xpath, so predicate query is compared with equivalent find_child loop.
+XERCESC_BENCHMARK(xpath_native_vs_xerces)
+{
+	const std::size_t items = 10000;
+	auto doc = load(make_catalog(items));
+	auto * root = doc->getDocumentElement();
+
+	for (auto * expression : {"c:item/c:name", "//m:note"})
+	{
+		auto suffix = std::string(", ") + expression;
+		native_xpath query(expression);
+
+		measure("find_xpath" + suffix,         [&] { consume(find_xpath(root, expression)); });
+		measure("native_find_xpath" + suffix,  [&] { consume(native_find_xpath(root, expression)); });
+		measure("native_xpath::find" + suffix, [&] { consume(query.find(root)); });
+
+		measure("select_xpath" + suffix,         [&] { for (auto * node : select_xpath(root, expression)) consume(node); }, 0, items);
+		measure("native_xpath::select" + suffix, [&] { for (auto * node : query.select(root)) consume(node); }, 0, items);
+	}
+
+	auto id = std::to_string(items / 2);
+	native_xpath query("c:item[@id='" + id + "']/c:name");
+
+	measure("native_xpath::find, c:item[@id='n']/c:name", [&] { consume(query.find(root)); });
+	measure("find_child loop, same query", [&]
+	{
+		auto * item = find_child(root, "c:item");
+		while (item and find_attribute_text(item, "id") != id) item = next_sibling(item, "c:item");
+		consume(item ? find_child(item, "c:name") : nullptr);
+	});
+}
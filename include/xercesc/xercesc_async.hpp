@@ -0,0 +1,183 @@
+﻿#pragma once
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+#include <vector>
+#include <string>
+#include <xercesc/xercesc_utils.hpp>
+
+namespace xercesc_utils
+{
+	/************************************************************************/
+	/*                          executors                                   */
+	/************************************************************************/
+	/// Abstract executor, runs submitted tasks somewhere else, not in the calling thread.
+	/// Tasks must not throw, async helpers below catch everything themselves.
+	class executor
+	{
+	public:
+		using task_type = std::function<void()>;
+
+	public:
+		virtual void submit(task_type task) = 0;
+		virtual ~executor() = default;
+	};
+
+	/// Simple fixed size thread pool.
+	/// On destruction already queued tasks are completed, then threads are joined.
+	class thread_pool_executor : public executor
+	{
+		std::mutex m_mutex;
+		std::condition_variable m_event;
+		std::deque<task_type> m_tasks;
+		std::vector<std::thread> m_threads;
+		bool m_stopped = false;
+
+	private:
+		void thread_proc();
+
+	public:
+		void submit(task_type task) override;
+		std::size_t nthreads() const noexcept { return m_threads.size(); }
+
+	public:
+		/// nthreads == 0 means std::thread::hardware_concurrency()
+		explicit thread_pool_executor(unsigned nthreads = 0);
+		~thread_pool_executor();
+
+		thread_pool_executor(const thread_pool_executor &) = delete;
+		thread_pool_executor & operator =(const thread_pool_executor &) = delete;
+	};
+
+	/// Executor that passes tasks to user provided callback,
+	/// for example posting them into event loop worker queue or some already existing pool.
+	class callback_executor : public executor
+	{
+	public:
+		using post_function = std::function<void(task_type task)>;
+
+	private:
+		post_function m_post;
+
+	public:
+		void submit(task_type task) override { m_post(std::move(task)); }
+
+	public:
+		explicit callback_executor(post_function post);
+	};
+
+
+	/************************************************************************/
+	/*                    cancellation and limits                           */
+	/************************************************************************/
+	class async_cancelled : public std::runtime_error
+	{
+	public:
+		async_cancelled();
+	};
+
+	class async_overloaded : public std::runtime_error
+	{
+	public:
+		async_overloaded(const std::string & msg);
+	};
+
+	/// Observing side of cancellation, default constructed token is never cancelled.
+	/// Checked before task starts and periodically while parsing/serializing, so long operations are interrupted too.
+	class cancellation_token
+	{
+		friend class cancellation_source;
+		std::shared_ptr<const std::atomic_bool> m_flag;
+
+	public:
+		bool cancelled() const noexcept { return m_flag and m_flag->load(std::memory_order_relaxed); }
+		void throw_if_cancelled() const { if (cancelled()) throw async_cancelled(); }
+	};
+
+	class cancellation_source
+	{
+		std::shared_ptr<std::atomic_bool> m_flag = std::make_shared<std::atomic_bool>(false);
+
+	public:
+		void cancel() noexcept { m_flag->store(true, std::memory_order_relaxed); }
+		cancellation_token token() const { cancellation_token tok; tok.m_flag = m_flag; return tok; }
+	};
+
+	struct async_limits
+	{
+		enum overload_policy : bool
+		{
+			reject, // new operation completes immediately with async_overloaded, handler is invoked from submitting thread
+			wait,   // submitting thread blocks until enough in-flight operations complete
+		};
+
+		// 0 means unlimited. Load operations are accounted by input size(file size for load_from_file),
+		// save operations - only by tasks count, output size is not known until serialization is done.
+		// An operation is always admitted if nothing else is in flight, even if it is bigger than the limit.
+		std::size_t max_inflight_bytes = 0;
+		std::size_t max_inflight_tasks = 0;
+		overload_policy policy = reject;
+	};
+
+
+	/************************************************************************/
+	/*                      async load/save                                 */
+	/************************************************************************/
+	/// Offloads load/save operations to given executor.
+	/// Completion handlers are invoked from executor thread with std::exception_ptr as first argument,
+	/// non null in case of error(async_cancelled, async_overloaded, parse/serialization errors).
+	/// Handlers should not throw, exceptions escaping them are swallowed.
+	///
+	/// NOTE: xercesc DOM is not thread safe, document passed to save must not be modified until operation completes.
+	///       executor and this object must outlive all submitted operations.
+	class async_xml_processor
+	{
+	public:
+		using document_ptr  = std::shared_ptr<xercesc::DOMDocument>;
+		using load_handler  = std::function<void(std::exception_ptr, document_ptr)>;
+		using save_handler  = std::function<void(std::exception_ptr, std::string)>;
+		using write_handler = std::function<void(std::exception_ptr)>;
+
+	private:
+		executor * m_executor;
+		async_limits m_limits;
+
+		mutable std::mutex m_mutex;
+		std::condition_variable m_event;
+		std::size_t m_inflight_bytes = 0;
+		std::size_t m_inflight_tasks = 0;
+
+	private:
+		bool try_admit(std::size_t bytes, std::unique_lock<std::mutex> & lk);
+		void admit(std::size_t bytes);
+		void complete(std::size_t bytes);
+		void submit(std::size_t bytes, std::function<std::function<void()>()> task, std::function<void(std::exception_ptr)> fail);
+
+	public:
+		void load(std::string data, load_handler handler, cancellation_token token = {});
+		void load_from_file(std::string file, load_handler handler, cancellation_token token = {});
+		void save(document_ptr doc, save_handler handler, save_option save_option = pretty_print, xml_string encoding = XERCESC_LIT("utf-8"), cancellation_token token = {});
+		void save_to_file(document_ptr doc, std::string file, write_handler handler, save_option save_option = pretty_print, xml_string encoding = XERCESC_LIT("utf-8"), cancellation_token token = {});
+
+		std::future<document_ptr> load(std::string data, cancellation_token token = {});
+		std::future<document_ptr> load_from_file(std::string file, cancellation_token token = {});
+		std::future<std::string>  save(document_ptr doc, save_option save_option = pretty_print, xml_string encoding = XERCESC_LIT("utf-8"), cancellation_token token = {});
+		std::future<void> save_to_file(document_ptr doc, std::string file, save_option save_option = pretty_print, xml_string encoding = XERCESC_LIT("utf-8"), cancellation_token token = {});
+
+	public:
+		std::size_t inflight_bytes() const;
+		std::size_t inflight_tasks() const;
+		auto limits() const noexcept -> const async_limits & { return m_limits; }
+
+	public:
+		explicit async_xml_processor(executor & executor, async_limits limits = {});
+		async_xml_processor(const async_xml_processor &) = delete;
+		async_xml_processor & operator =(const async_xml_processor &) = delete;
+	};
+}
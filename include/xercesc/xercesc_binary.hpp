@@ -0,0 +1,51 @@
+﻿#pragma once
+#include <cstddef>
+#include <streambuf>
+#include <vector>
+#include <xercesc/xercesc_utils.hpp>
+
+namespace xercesc_utils
+{
+	/************************************************************************/
+	/*                    binary payload helpers                            */
+	/************************************************************************/
+	/// Binary data carried as element text(xs:base64Binary, xs:hexBinary), decoded straight from utf-16 text nodes:
+	/// no getTextContent copy in document pool, no utf-8 conversion, no intermediate strings.
+	/// All text and CDATA nodes of element subtree are decoded in document order as one stream, whitespace anywhere is ignored.
+	/// Base64 uses standard alphabet with optional '=' padding, hex digits are case insensitive.
+	/// Invalid data throws std::runtime_error, part of bytes decoded before error may be already written to sink.
+	///
+	/// Vector sinks are appended, streambuf sinks receive data by blocks, so multi-MB payloads need no full size buffer.
+	enum class binary_encoding : unsigned char
+	{
+		base64,
+		hex,
+	};
+
+	std::vector<unsigned char> get_text_binary(xercesc::DOMElement * element, binary_encoding encoding = binary_encoding::base64);
+	void get_text_binary(xercesc::DOMElement * element, std::vector<unsigned char> & data, binary_encoding encoding = binary_encoding::base64);
+	void get_text_binary(xercesc::DOMElement * element, std::streambuf & sb, binary_encoding encoding = binary_encoding::base64);
+
+	/// missing path throws xml_path_exception
+	std::vector<unsigned char> get_path_binary(xercesc::DOMDocument * doc,    xml_string_view path, binary_encoding encoding = binary_encoding::base64);
+	std::vector<unsigned char> get_path_binary(xercesc::DOMElement * element, xml_string_view path, binary_encoding encoding = binary_encoding::base64);
+	void get_path_binary(xercesc::DOMDocument * doc,    xml_string_view path, std::streambuf & sb, binary_encoding encoding = binary_encoding::base64);
+	void get_path_binary(xercesc::DOMElement * element, xml_string_view path, std::streambuf & sb, binary_encoding encoding = binary_encoding::base64);
+
+	/// false if path is not found, sink is not touched then
+	bool find_path_binary(xercesc::DOMDocument * doc,    xml_string_view path, std::vector<unsigned char> & data, binary_encoding encoding = binary_encoding::base64);
+	bool find_path_binary(xercesc::DOMElement * element, xml_string_view path, std::vector<unsigned char> & data, binary_encoding encoding = binary_encoding::base64);
+	bool find_path_binary(xercesc::DOMDocument * doc,    xml_string_view path, std::streambuf & sb, binary_encoding encoding = binary_encoding::base64);
+	bool find_path_binary(xercesc::DOMElement * element, xml_string_view path, std::streambuf & sb, binary_encoding encoding = binary_encoding::base64);
+
+
+	template <class String> inline std::vector<unsigned char> get_path_binary(xercesc::DOMDocument * doc,    const String & path, binary_encoding encoding = binary_encoding::base64) { return get_path_binary(doc,     forward_xml_string_view(path), encoding); }
+	template <class String> inline std::vector<unsigned char> get_path_binary(xercesc::DOMElement * element, const String & path, binary_encoding encoding = binary_encoding::base64) { return get_path_binary(element, forward_xml_string_view(path), encoding); }
+	template <class String> inline void get_path_binary(xercesc::DOMDocument * doc,    const String & path, std::streambuf & sb, binary_encoding encoding = binary_encoding::base64) { return get_path_binary(doc,     forward_xml_string_view(path), sb, encoding); }
+	template <class String> inline void get_path_binary(xercesc::DOMElement * element, const String & path, std::streambuf & sb, binary_encoding encoding = binary_encoding::base64) { return get_path_binary(element, forward_xml_string_view(path), sb, encoding); }
+
+	template <class String> inline bool find_path_binary(xercesc::DOMDocument * doc,    const String & path, std::vector<unsigned char> & data, binary_encoding encoding = binary_encoding::base64) { return find_path_binary(doc,     forward_xml_string_view(path), data, encoding); }
+	template <class String> inline bool find_path_binary(xercesc::DOMElement * element, const String & path, std::vector<unsigned char> & data, binary_encoding encoding = binary_encoding::base64) { return find_path_binary(element, forward_xml_string_view(path), data, encoding); }
+	template <class String> inline bool find_path_binary(xercesc::DOMDocument * doc,    const String & path, std::streambuf & sb, binary_encoding encoding = binary_encoding::base64) { return find_path_binary(doc,     forward_xml_string_view(path), sb, encoding); }
+	template <class String> inline bool find_path_binary(xercesc::DOMElement * element, const String & path, std::streambuf & sb, binary_encoding encoding = binary_encoding::base64) { return find_path_binary(element, forward_xml_string_view(path), sb, encoding); }
+}
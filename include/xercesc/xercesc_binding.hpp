@@ -0,0 +1,234 @@
+﻿#pragma once
+#include <cstddef>
+#include <charconv>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <xercesc/xercesc_utils.hpp>
+
+namespace xercesc_utils
+{
+	/************************************************************************/
+	/*                      struct to xml binding                           */
+	/************************************************************************/
+	/// Mapping of C++ struct fields to element texts and attributes, declared once per struct:
+	///
+	///   struct person { std::string name; int age; std::optional<std::string> email; long id; };
+	///
+	///   template <> struct xercesc_utils::xml_binding<person>
+	///   {
+	///       static constexpr xml_field fields[] = {
+	///           bind_field<&person::name>("info/name"),
+	///           bind_field<&person::age>("info/age"),
+	///           bind_field<&person::email>("contacts/m:email"),
+	///           bind_field<&person::id>("@id"),
+	///       };
+	///   };
+	///
+	///   auto p = load_struct<person>(element);
+	///   save_struct(other_element, p);
+	///
+	/// Paths are relative to bound element, have path helpers syntax, last segment can be @attribute, empty path is element itself.
+	/// Prefixes are resolved once per load/save against bound element: via associated resolver or namespaces in its scope.
+	/// Paths are compiled into trie on first use of struct binding, load fills struct in one pass over the tree,
+	/// taking first matching element for each path as find_path does. Missing non optional field throws xml_path_exception.
+	/// std::optional fields are optional: missing ones are reset on load, empty ones are not written on save.
+	///
+	/// Values are converted by xml_value_traits, which can be specialized for other types.
+	template <class Type, class Enable = void>
+	struct xml_value_traits;
+
+	template <>
+	struct xml_value_traits<std::string>
+	{
+		static void parse(std::string_view text, std::string & value) { value.assign(text.data(), text.size()); }
+		static void format(const std::string & value, std::string & text) { text = value; }
+	};
+
+	template <>
+	struct xml_value_traits<bool>
+	{
+		static void parse(std::string_view text, bool & value)
+		{
+			if (text == "true" or text == "1") value = true;
+			else if (text == "false" or text == "0") value = false;
+			else throw std::invalid_argument("xercesc_utils::xml_value_traits: invalid boolean value " + std::string(text));
+		}
+
+		static void format(bool value, std::string & text) { text = value ? "true" : "false"; }
+	};
+
+	/// integral and floating point types, in C locale
+	template <class Type>
+	struct xml_value_traits<Type, std::enable_if_t<std::is_arithmetic_v<Type> and not std::is_same_v<Type, bool>>>
+	{
+		static void parse(std::string_view text, Type & value)
+		{
+			auto * first = text.data();
+			auto * last = first + text.size();
+			if (first != last and *first == '+') ++first;
+
+			auto res = std::from_chars(first, last, value);
+			if (res.ec != std::errc() or res.ptr != last or first == last)
+				throw std::invalid_argument("xercesc_utils::xml_value_traits: invalid numeric value " + std::string(text));
+		}
+
+		static void format(Type value, std::string & text)
+		{
+			char buffer[64];
+			auto res = std::to_chars(buffer, buffer + sizeof(buffer), value);
+			text.assign(buffer, res.ptr);
+		}
+	};
+
+	/// field descriptor, created by bind_field
+	struct xml_field
+	{
+		std::string_view path;
+		bool optional;
+		/// assigns text to field, text is nullptr for missing optional field
+		void (*load)(void * object, const std::string * text);
+		/// formats field, false if optional field is empty
+		bool (*save)(const void * object, std::string & text);
+	};
+
+	template <class Struct>
+	struct xml_binding; // specialized with static constexpr xml_field fields[]
+
+	namespace detail
+	{
+		template <class Class, class Type> Class member_class(Type Class::*);
+		template <class Class, class Type> Type  member_type(Type Class::*);
+
+		template <class Type> struct is_optional : std::false_type {};
+		template <class Type> struct is_optional<std::optional<Type>> : std::true_type {};
+
+		template <auto Member>
+		void load_member(void * object, const std::string * text)
+		{
+			using class_type = decltype(member_class(Member));
+			using value_type = decltype(member_type(Member));
+			auto & value = static_cast<class_type *>(object)->*Member;
+
+			if constexpr (is_optional<value_type>::value)
+			{
+				if (not text) return value.reset();
+				xml_value_traits<typename value_type::value_type>::parse(*text, value.emplace());
+			}
+			else
+			{
+				xml_value_traits<value_type>::parse(*text, value);
+			}
+		}
+
+		template <auto Member>
+		bool save_member(const void * object, std::string & text)
+		{
+			using class_type = decltype(member_class(Member));
+			using value_type = decltype(member_type(Member));
+			auto & value = static_cast<const class_type *>(object)->*Member;
+
+			if constexpr (is_optional<value_type>::value)
+			{
+				if (not value) return false;
+				xml_value_traits<typename value_type::value_type>::format(*value, text);
+			}
+			else
+			{
+				xml_value_traits<value_type>::format(value, text);
+			}
+
+			return true;
+		}
+
+		/// binding paths compiled into trie of element names
+		class compiled_binding
+		{
+		public:
+			struct node
+			{
+				xml_string prefix, local_name;      // empty prefix - no namespace
+				std::vector<std::size_t> children;  // node indexes, children always follow their parent
+				std::vector<std::size_t> text_fields;
+				std::vector<std::pair<xml_string, std::size_t>> attribute_fields; // qualified attribute name, field index
+			};
+
+		private:
+			const xml_field * m_fields;
+			std::size_t m_field_count;
+			std::vector<node> m_nodes; // m_nodes[0] is bound element
+
+		private:
+			void load(std::size_t index, xercesc::DOMElement * element, void * object,
+			          const std::vector<xml_string> & namespaces, std::vector<char> & loaded) const;
+			void save(std::size_t index, xercesc::DOMElement * element, const std::vector<std::string> & values,
+			          const std::vector<char> & has_values, const std::vector<char> & has_nodes) const;
+
+		public:
+			const std::vector<node> & nodes() const noexcept { return m_nodes; }
+
+			void load(xercesc::DOMElement * element, void * object) const;
+			void save(xercesc::DOMElement * element, const void * object) const;
+
+		public:
+			/// throws std::invalid_argument on invalid path
+			compiled_binding(const xml_field * fields, std::size_t count);
+		};
+
+		template <class Struct>
+		const compiled_binding & compiled_binding_of()
+		{
+			static const compiled_binding binding(std::data(xml_binding<Struct>::fields), std::size(xml_binding<Struct>::fields));
+			return binding;
+		}
+	}
+
+	template <auto Member>
+	constexpr xml_field bind_field(std::string_view path)
+	{
+		using value_type = decltype(detail::member_type(Member));
+		return xml_field {path, detail::is_optional<value_type>::value, &detail::load_member<Member>, &detail::save_member<Member>};
+	}
+
+	template <class Struct>
+	void load_struct(xercesc::DOMElement * element, Struct & object)
+	{
+		if (not element) throw std::invalid_argument("xercesc_utils::load_struct: element is null");
+		detail::compiled_binding_of<Struct>().load(element, &object);
+	}
+
+	template <class Struct>
+	Struct load_struct(xercesc::DOMElement * element)
+	{
+		Struct object {};
+		load_struct(element, object);
+		return object;
+	}
+
+	/// elements are created as acquire_path does, existing texts and attributes are overwritten
+	template <class Struct>
+	void save_struct(xercesc::DOMElement * element, const Struct & object)
+	{
+		if (not element) throw std::invalid_argument("xercesc_utils::save_struct: element is null");
+		detail::compiled_binding_of<Struct>().save(element, &object);
+	}
+
+	/// bound element is document element
+	template <class Struct>
+	void load_struct(xercesc::DOMDocument * doc, Struct & object)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::load_struct: document is null");
+		load_struct(doc->getDocumentElement(), object);
+	}
+
+	template <class Struct>
+	void save_struct(xercesc::DOMDocument * doc, const Struct & object)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::save_struct: document is null");
+		save_struct(doc->getDocumentElement(), object);
+	}
+}
@@ -0,0 +1,106 @@
+﻿#pragma once
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <xercesc/xercesc_utils.hpp>
+
+namespace xercesc_utils
+{
+	/************************************************************************/
+	/*                        document builder                              */
+	/************************************************************************/
+	/// Cursor for filling documents, replacement for series of set_path_text/acquire_path calls from document root.
+	/// Paths and names have the same syntax and semantics as in acquire_path/set_attribute_text,
+	/// relative paths start at cursor, paths starting with '/' - at document.
+	///
+	/// Builder remembers children it has found or created and prefix resolution/create_element_ns decisions per namespace scope:
+	/// elements it creates share scope of their parent unless they introduce new prefix binding.
+	/// Children are remembered by resolved namespace and local name, so a/p:x and a/q:x with one namespace are the same element, as for find_child.
+	/// So document must not be changed by other means while builder is used, otherwise reset must be called.
+	///
+	///   document_builder builder(doc);
+	///   builder.acquire("/root/header").set_text("id", id).set_text("date", date).up();
+	///   builder.apply({{"body/a/x", "1"}, {"body/a/y", "2"}, {"body/b", "3"}});
+	class document_builder
+	{
+		/// how name written in path is resolved and created in some namespace scope
+		struct name_decision
+		{
+			xml_string namespace_uri;
+			xml_string child_key;       // namespace_uri \0 local name, different prefixes of one namespace give the same key
+			xml_string qualified_name;  // as passed to createElementNS, empty until first element is created
+			bool new_scope = false;     // created element introduces its own prefix binding
+		};
+
+		struct element_state
+		{
+			const xercesc::DOMElement * scope;  // element whose in-scope namespaces apply to children
+			bool created;                       // created by builder, all its children are known
+			std::unordered_map<xml_string, xercesc::DOMElement *> children; // by name_decision::child_key
+		};
+
+		using decision_map = std::unordered_map<xml_string, name_decision>;
+
+		xercesc::DOMDocument * m_doc = nullptr;
+		xercesc::DOMElement * m_current = nullptr; // nullptr - document level
+		std::unordered_map<const xercesc::DOMElement *, element_state> m_elements;
+		std::unordered_map<const xercesc::DOMElement *, decision_map> m_decisions; // by scope element
+		xml_string m_key; // reused lookup key
+
+	private:
+		element_state & state(xercesc::DOMElement * element);
+		name_decision & decide(xercesc::DOMElement * parent, element_state & parent_state, xml_string_view name);
+		xercesc::DOMElement * create(xercesc::DOMElement * parent, element_state & parent_state, name_decision & decision, xml_string_view name);
+		xercesc::DOMElement * child(xercesc::DOMElement * parent, xml_string_view name);
+		xercesc::DOMElement * walk(xercesc::DOMElement * element, xml_string_view path);
+
+		template <class Iterator>
+		void apply_sorted(Iterator first, Iterator last);
+
+	public:
+		xercesc::DOMDocument * document() const noexcept { return m_doc; }
+		/// current element, nullptr at document level
+		xercesc::DOMElement * current() const noexcept { return m_current; }
+
+		/// moves cursor to path, creating missing elements
+		document_builder & acquire(xml_string_view path);
+		/// appends new child element even if there is one with the same name and moves cursor to it
+		document_builder & append(xml_string_view name);
+		/// moves cursor levels up, above document element cursor is at document level
+		document_builder & up(std::size_t levels = 1);
+		/// moves cursor to element of the same document
+		document_builder & move_to(xercesc::DOMElement * element);
+
+		/// sets text of current element, child elements are released
+		document_builder & set_text(std::string_view value);
+		/// sets text of element at path relative to cursor, cursor is not moved
+		document_builder & set_text(xml_string_view path, std::string_view value);
+		/// sets attribute of current element as set_attribute_text
+		document_builder & set_attribute(xml_string_view name, std::string_view value);
+
+		/// Sets text of elements at paths relative to cursor, cursor is not moved.
+		/// Paths are processed in sorted order, common leading segments of consecutive paths are walked once.
+		document_builder & apply(const std::map<xml_string, std::string> & values);
+		document_builder & apply(const std::map<std::string, std::string> & values);
+		document_builder & apply(std::vector<std::pair<xml_string, std::string>> values);
+		document_builder & apply(std::initializer_list<std::pair<std::string_view, std::string_view>> values);
+
+		/// drops remembered children and namespace decisions
+		void reset() noexcept;
+
+		template <class String> document_builder & acquire(const String & path) { return acquire(forward_xml_string_view(path)); }
+		template <class String> document_builder & append(const String & name)  { return append(forward_xml_string_view(name)); }
+		template <class String> document_builder & set_text(const String & path, std::string_view value)      { return set_text(forward_xml_string_view(path), value); }
+		template <class String> document_builder & set_attribute(const String & name, std::string_view value) { return set_attribute(forward_xml_string_view(name), value); }
+
+	public:
+		/// cursor at document level
+		explicit document_builder(xercesc::DOMDocument * doc);
+		/// cursor at element
+		explicit document_builder(xercesc::DOMElement * element);
+	};
+}
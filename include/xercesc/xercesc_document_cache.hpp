@@ -0,0 +1,165 @@
+﻿#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_frozen.hpp>
+
+namespace xercesc_utils
+{
+	/************************************************************************/
+	/*                      shared parsed documents cache                   */
+	/************************************************************************/
+	/// Cache of parsed files shared by independent components: each file is parsed once and handed out as shared cached_document.
+	/// Entries are keyed by path and validated by file identity(device/inode, mtime and size) on each request,
+	/// changed file is parsed again, holders of old document keep it.
+	/// Concurrent requests of the same file wait for single parse, parse errors are reported to all of them and are not cached.
+	///
+	/// Evicted documents stay alive while there are holders.
+	/// Xerces does not report DOM memory usage, so document cost is estimated from source size, see memory_factor.
+	///
+	///   auto doc = load_cached("settings.xml");
+	///   auto port = doc->frozen().get_path_text("settings/port");        // lock free
+	///   auto text = get_path_text(doc->lock().get(), "settings/motd");   // DOM helpers under document lock
+	struct document_cache_options
+	{
+		/// cached documents are evicted in LRU order when total estimated size exceeds budget, 0 disables caching
+		std::size_t memory_budget = 256 * 1024 * 1024;
+		/// estimated DOM size per source byte: utf-16 strings plus node overhead
+		double memory_factor = 4.0;
+	};
+
+	struct document_cache_statistics
+	{
+		std::uint64_t hits, misses;  // misses include reloads of changed files
+		std::uint64_t waits;         // requests which waited for concurrent parse of the same file
+		std::uint64_t evictions;
+		std::size_t size;            // number of cached documents
+		std::size_t memory, memory_budget;
+
+		double hit_rate() const noexcept { auto total = hits + misses + waits; return total ? double(hits + waits) / total : 0.0; }
+	};
+
+	/// Document shared through cache. Xerces DOM is not safe for concurrent reading even through read-only helpers:
+	/// getTextContent allocates from document pool, name atoms and namespace cache are stored in document user data, etc.
+	/// So DOM is reachable only through lock(), which serializes all holders of the document,
+	/// and must not be modified. frozen() is immutable snapshot of document built on first call, it's read without any locking.
+	/// Document lock is recursive: frozen() can be called while holding lock().
+	class cached_document
+	{
+		std::shared_ptr<xercesc::DOMDocument> m_document;
+		mutable std::recursive_mutex m_mutex;
+		mutable std::atomic<bool> m_frozen_ready {false};
+		mutable frozen_document m_frozen;
+
+	public:
+		/// DOM document with held document lock
+		class locked_document
+		{
+			std::unique_lock<std::recursive_mutex> m_lock;
+			xercesc::DOMDocument * m_document;
+
+		public:
+			xercesc::DOMDocument * get() const noexcept { return m_document; }
+			xercesc::DOMDocument * operator ->() const noexcept { return m_document; }
+
+		public:
+			locked_document(std::recursive_mutex & mutex, xercesc::DOMDocument * document) : m_lock(mutex), m_document(document) {}
+		};
+
+	public:
+		locked_document lock() const { return locked_document(m_mutex, m_document.get()); }
+		/// snapshot is built once under document lock, its memory is not accounted in cache budget.
+		/// Build takes document lock, so it waits for other threads holding lock(), but not for own one
+		const frozen_document & frozen() const;
+
+	public:
+		explicit cached_document(std::shared_ptr<xercesc::DOMDocument> document) : m_document(std::move(document)) {}
+
+		cached_document(const cached_document &) = delete;
+		cached_document & operator =(const cached_document &) = delete;
+	};
+
+	class document_cache
+	{
+	public:
+		using document_ptr = std::shared_ptr<const cached_document>;
+
+		/// file identity, validates cached entries
+		struct file_identity
+		{
+			std::uint64_t device, inode, size;
+			std::int64_t mtime;
+
+			bool operator ==(const file_identity & other) const noexcept
+			{
+				return device == other.device and inode == other.inode and size == other.size and mtime == other.mtime;
+			}
+
+			bool operator !=(const file_identity & other) const noexcept { return not operator ==(other); }
+		};
+
+	private:
+		struct entry;
+		using entry_ptr = std::shared_ptr<entry>;
+		using lru_list = std::list<entry_ptr>;
+
+		struct entry
+		{
+			std::string path;
+			file_identity identity;
+			std::shared_future<document_ptr> document;
+			std::size_t cost = 0;
+			bool ready = false;   // loaded and accounted in LRU
+			lru_list::iterator lru;
+		};
+
+		mutable std::mutex m_mutex;
+		document_cache_options m_options;
+		std::unordered_map<std::string, entry_ptr> m_entries; // ready and loading entries
+		lru_list m_lru; // ready entries, most recently used first
+		std::size_t m_memory = 0;
+		std::uint64_t m_hits = 0, m_misses = 0, m_waits = 0, m_evictions = 0;
+
+	private:
+		void remove(const entry_ptr & ent);
+		void shrink(std::size_t budget, std::vector<entry_ptr> & evicted);
+		document_ptr load(const std::string & path, const xml_string * wpath);
+
+	public:
+		/// parsed file from cache, file is parsed if it's not cached or has changed since
+		document_ptr load_from_file(const std::string & file);
+		document_ptr load_from_file(const xml_string  & file);
+
+		/// drops cached document of file, if there is one
+		void erase(const std::string & file);
+		void clear();
+
+		document_cache_options options() const;
+		void set_options(const document_cache_options & options);
+		document_cache_statistics statistics() const;
+
+		/// identity of file, throws std::system_error
+		static file_identity identify(const std::string & file);
+
+	public:
+		explicit document_cache(const document_cache_options & options = {});
+
+		document_cache(const document_cache &) = delete;
+		document_cache & operator =(const document_cache &) = delete;
+	};
+
+	/// Process wide cache instance, it's never destroyed: documents can't outlive Xercesc termination,
+	/// xercesc_free clears it.
+	document_cache & shared_document_cache();
+
+	inline auto load_cached(const std::string & file) { return shared_document_cache().load_from_file(file); }
+	inline auto load_cached(const xml_string  & file) { return shared_document_cache().load_from_file(file); }
+}
@@ -0,0 +1,235 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <xercesc/xercesc_utils.hpp>
+
+namespace xercesc_utils
+{
+	/************************************************************************/
+	/*                  compact immutable document snapshot                 */
+	/************************************************************************/
+	/// Read-only snapshot of DOMDocument for data which is loaded once and queried a lot.
+	/// Nodes are stored in contiguous array in document order and linked by indexes, names are interned
+	/// and sorted by (namespace, local name), so name comparison during lookup is integer comparison,
+	/// all strings are utf-8 in one arena. Only elements, attributes and text(including CDATA) are kept.
+	/// Text of elements without child elements is stored in element itself, other text is kept as text nodes.
+	///
+	/// Snapshot is immutable and can be freely shared between threads.
+	/// Paths and names have the same syntax as find_path/find_child/find_attribute_text, prefixes are resolved
+	/// via bindings of resolver associated with source document at freeze time, or namespace declarations in snapshot.
+	class frozen_document;
+	class frozen_element;
+
+	namespace frozen
+	{
+		using index_type = std::uint32_t;
+		constexpr index_type npos = ~index_type(0);
+
+		struct string_ref
+		{
+			std::uint32_t offset, size;
+		};
+
+		/// interned (namespace, local name) pair
+		struct name_entry
+		{
+			string_ref namespace_uri;
+			string_ref local_name;
+		};
+
+		struct node_entry
+		{
+			index_type parent, first_child, next_sibling;
+			index_type name;  // npos for text nodes
+			index_type first_attribute, attribute_count;
+			string_ref prefix; // empty for text nodes
+			string_ref text;   // text nodes and elements without child elements
+		};
+
+		struct attribute_entry
+		{
+			index_type name;
+			string_ref prefix;
+			string_ref value;
+		};
+
+		/// raw tables of snapshot, nodes[0] is document element
+		struct tables
+		{
+			const node_entry      * nodes      = nullptr; std::size_t node_count      = 0;
+			const attribute_entry * attributes = nullptr; std::size_t attribute_count = 0;
+			const name_entry      * names      = nullptr; std::size_t name_count      = 0;
+			const char            * arena      = nullptr; std::size_t arena_size      = 0;
+		};
+	}
+
+	/// lightweight element handle, valid while document is alive
+	class frozen_element
+	{
+		friend frozen_document;
+
+		const frozen_document * m_doc = nullptr;
+		frozen::index_type m_index = frozen::npos;
+
+	private:
+		frozen_element(const frozen_document * doc, frozen::index_type index) noexcept : m_doc(doc), m_index(index) {}
+		const frozen::node_entry & entry() const noexcept;
+
+	public:
+		bool valid() const noexcept { return m_index != frozen::npos; }
+		explicit operator bool() const noexcept { return valid(); }
+		frozen::index_type index() const noexcept { return m_index; }
+
+		bool operator ==(const frozen_element & other) const noexcept { return m_doc == other.m_doc and m_index == other.m_index; }
+		bool operator !=(const frozen_element & other) const noexcept { return not operator ==(other); }
+
+		std::string_view local_name() const noexcept;
+		std::string_view namespace_uri() const noexcept;
+		std::string_view prefix() const noexcept;
+
+		/// text content with surrounding spaces trimmed, as get_text_content
+		std::string text() const;
+		/// same for element without child elements, without copying; empty for other elements
+		std::string_view text_view() const noexcept;
+
+		frozen_element parent() const noexcept;
+		frozen_element first_child() const noexcept;
+		frozen_element next_sibling() const noexcept;
+
+		frozen_element find_child(std::string_view name) const;
+		frozen_element next_sibling(std::string_view name) const;
+		frozen_element find_path(std::string_view path) const;
+		frozen_element get_path(std::string_view path) const;
+
+		std::string find_path_text(std::string_view path, std::string_view defval = empty_string) const;
+		std::string get_path_text(std::string_view path) const;
+
+		/// attribute value without copying, defval if there is no such attribute
+		std::string_view find_attribute_view(std::string_view name, std::string_view defval = {}) const;
+		bool has_attribute(std::string_view name) const;
+		std::string find_attribute_text(std::string_view name, std::string_view defval = empty_string) const;
+		std::string  get_attribute_text(std::string_view name) const;
+
+		/// utf-16 overloads
+		frozen_element find_child(xml_string_view name) const { return find_child(to_utf8(name)); }
+		frozen_element find_path(xml_string_view path) const  { return find_path(to_utf8(path)); }
+		std::string find_path_text(xml_string_view path, std::string_view defval = empty_string) const { return find_path_text(to_utf8(path), defval); }
+		std::string find_attribute_text(xml_string_view name, std::string_view defval = empty_string) const { return find_attribute_text(to_utf8(name), defval); }
+
+	public:
+		frozen_element() = default;
+	};
+
+	class frozen_document
+	{
+		friend frozen_element;
+		friend class frozen_builder;
+		friend frozen_document freeze(const xercesc::DOMDocument * doc, namespace_bindings_ptr bindings);
+
+		// storage of snapshot built in memory, tables point into it
+		std::vector<frozen::node_entry> m_nodes;
+		std::vector<frozen::attribute_entry> m_attributes;
+		std::vector<frozen::name_entry> m_names;
+		std::vector<char> m_arena;
+		// or external storage(mapped file, etc.)
+		std::shared_ptr<const void> m_storage;
+
+		frozen::tables m_tables;
+		namespace_bindings_ptr m_bindings;
+
+	private:
+		void attach_tables() noexcept;
+
+		std::string_view str(frozen::string_ref ref) const noexcept { return std::string_view(m_tables.arena + ref.offset, ref.size); }
+		/// index of (namespace, local name) in sorted name table or npos
+		frozen::index_type find_name(std::string_view namespace_uri, std::string_view local_name) const noexcept;
+		/// prefix resolution as DOMElement::lookupNamespaceURI, via bindings if there are any
+		bool lookup_namespace_uri(frozen::index_type element, std::string_view prefix, std::string & uri) const;
+		/// splits prefix:local and resolves prefix, false if there is no element with such name in document
+		bool resolve_name(frozen::index_type element, std::string_view qname, frozen::index_type & name) const;
+
+		frozen::index_type find_child(frozen::index_type parent, frozen::index_type name) const noexcept;
+		frozen::index_type find_sibling(frozen::index_type element, frozen::index_type name) const noexcept;
+		frozen::index_type find_path(frozen::index_type element, std::string_view path) const;
+		const frozen::attribute_entry * find_attribute(frozen::index_type element, std::string_view name) const;
+		void append_text(frozen::index_type node, std::string & out) const;
+
+	public:
+		const frozen::tables & tables() const noexcept { return m_tables; }
+		const namespace_bindings_ptr & bindings() const noexcept { return m_bindings; }
+
+		bool empty() const noexcept { return m_tables.node_count == 0; }
+		std::size_t node_count() const noexcept { return m_tables.node_count; }
+		/// approximate size of snapshot data in bytes
+		std::size_t memory_size() const noexcept;
+
+		frozen_element root() const noexcept { return frozen_element(this, empty() ? frozen::npos : 0); }
+		frozen_element element(frozen::index_type index) const noexcept { return frozen_element(this, index < m_tables.node_count ? index : frozen::npos); }
+
+		/// first path segment is document element, as find_path(DOMDocument *, ...)
+		frozen_element find_path(std::string_view path) const;
+		frozen_element get_path(std::string_view path) const;
+		std::string find_path_text(std::string_view path, std::string_view defval = empty_string) const;
+		std::string get_path_text(std::string_view path) const;
+
+		frozen_element find_path(xml_string_view path) const { return find_path(to_utf8(path)); }
+		std::string find_path_text(xml_string_view path, std::string_view defval = empty_string) const { return find_path_text(to_utf8(path), defval); }
+
+	public:
+		frozen_document() = default;
+		/// snapshot over external tables, storage keeps them alive
+		frozen_document(const frozen::tables & tables, std::shared_ptr<const void> storage, namespace_bindings_ptr bindings = nullptr);
+
+		// tables point into own vectors, which keep their buffers on move
+		frozen_document(frozen_document &&) = default;
+		frozen_document & operator =(frozen_document &&) = default;
+		frozen_document(const frozen_document &) = delete;
+		frozen_document & operator =(const frozen_document &) = delete;
+	};
+
+	/// builds snapshot of document, bindings of associated DOMXPathNSResolverImpl are captured
+	frozen_document freeze(const xercesc::DOMDocument * doc);
+	frozen_document freeze(const xercesc::DOMDocument * doc, namespace_bindings_ptr bindings);
+
+	frozen_document load_frozen(std::string_view str);
+	frozen_document load_frozen_from_file(const xml_string  & file);
+	frozen_document load_frozen_from_file(const std::string & file);
+
+	/************************************************************************/
+	/*                    binary snapshot files                             */
+	/************************************************************************/
+	/// Snapshot tables written as is into versioned binary file, which is opened via mmap without deserialization:
+	/// queries run directly over mapped pages. Header carries magic, format version, byte order mark, table offsets,
+	/// checksum of data and size/mtime of source xml file, so stale or foreign files can be detected.
+	/// Format is native to platform byte order, bindings of associated resolver are not stored.
+	///
+	///   auto doc = load_frozen_cached("reference.xml", "reference.xml.frozen");
+	///   auto code = doc.get_path_text("catalog/header/code");
+	struct frozen_file_info
+	{
+		std::uint64_t source_size = 0;
+		std::int64_t  source_mtime = 0; // native file time ticks
+	};
+
+	/// size and modification time of source file, throws std::filesystem::filesystem_error
+	frozen_file_info source_file_info(const std::string & source);
+
+	/// writes snapshot atomically(via temporary file and rename)
+	void save_frozen(const frozen_document & doc, const std::string & file, const frozen_file_info & info = {});
+	void save_frozen(const xercesc::DOMDocument * doc, const std::string & file, const frozen_file_info & info = {});
+
+	/// maps snapshot file, throws std::runtime_error if file is not a valid snapshot of current format version.
+	/// Header, table bounds and every table entry(indexes, string bounds in arena) are checked, so corrupted file can't cause
+	/// out of bounds reads, but text data is not read. Checksum verification reads whole file, it's opt-in for integrity checks.
+	frozen_document open_frozen(const std::string & file, bool verify_checksum = false, namespace_bindings_ptr bindings = nullptr);
+	/// reads only header, false if file does not exist or is not a snapshot of current format version
+	bool read_frozen_info(const std::string & file, frozen_file_info & info);
+
+	/// maps cache if it was written for current size/mtime of source, otherwise loads source and rewrites cache.
+	/// Cache is opened without checksum verification: warm start does not read whole file.
+	frozen_document load_frozen_cached(const std::string & source, const std::string & cache, namespace_bindings_ptr bindings = nullptr);
+}
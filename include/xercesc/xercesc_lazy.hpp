@@ -0,0 +1,101 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <xercesc/xercesc_utils.hpp>
+
+namespace xercesc_utils
+{
+	/************************************************************************/
+	/*                lazy documents with byte-offset index                 */
+	/************************************************************************/
+	/// Document which is not parsed as a whole: structural pre-scan of file bytes records byte ranges of elements
+	/// at configured depth, and each such subtree is parsed into DOM only when accessed.
+	/// Scanner only tracks markup(tags, comments, CDATA, PIs, DOCTYPE) and does not check well-formedness,
+	/// errors inside subtree are reported when it's loaded.
+	///
+	/// Materialized subtree becomes document element of its own DOMDocument, namespace declarations
+	/// of its ancestors(root namespace context) are applied while parsing and copied onto the element,
+	/// so prefixes resolve as in full document. Entities declared in DOCTYPE internal subset are not available.
+	/// Source must be in utf-8 or other ascii compatible encoding declared in xml declaration.
+	///
+	///   auto doc = open_lazy("catalog.xml");
+	///   for (auto i = doc->find("item"); i != lazy_document::npos; i = doc->find("item", i + 1))
+	///       if (is_interesting(doc->source(i))) process(doc->element(i));
+	struct lazy_index_options
+	{
+		/// depth of indexed elements: 0 - document element, 1 - its children, and so on
+		unsigned depth = 1;
+	};
+
+	class lazy_document
+	{
+	public:
+		struct record
+		{
+			std::size_t offset, size;   // element bytes, from '<' of start tag up to '>' of end tag
+			std::string_view name;      // qualified name as in source
+			std::uint32_t context;      // namespace context of ancestors, see namespace_context
+		};
+
+	private:
+		std::shared_ptr<const void> m_storage;
+		std::string_view m_data;
+		lazy_index_options m_options;
+
+		std::string_view m_root_name;
+		std::string m_encoding;             // from xml declaration, empty for utf-8
+		std::vector<record> m_records;
+		std::vector<std::string> m_contexts; // namespace declarations in attribute syntax: ` xmlns:a="..." xmlns="..."`
+
+		mutable std::mutex m_mutex;
+		mutable std::vector<std::shared_ptr<xercesc::DOMDocument>> m_loaded;
+
+	private:
+		void scan();
+
+	public:
+		std::size_t size() const noexcept { return m_records.size(); }
+		bool empty() const noexcept { return m_records.empty(); }
+		const std::vector<record> & records() const noexcept { return m_records; }
+		const record & operator [](std::size_t index) const noexcept { return m_records[index]; }
+		const record & at(std::size_t index) const { return m_records.at(index); }
+
+		const lazy_index_options & options() const noexcept { return m_options; }
+		std::string_view root_name() const noexcept { return m_root_name; }
+		/// namespace declarations in scope of record, in attribute syntax
+		const std::string & namespace_context(const record & rec) const noexcept { return m_contexts[rec.context]; }
+		/// source bytes of record
+		std::string_view source(std::size_t index) const { auto & rec = at(index); return m_data.substr(rec.offset, rec.size); }
+
+		/// index of first record with qualified name at or after start, npos if there is none
+		std::size_t find(std::string_view name, std::size_t start = 0) const noexcept;
+
+		/// parses record into new document, each call parses again
+		std::shared_ptr<xercesc::DOMDocument> load(std::size_t index) const;
+		/// parses record once and keeps document until release, element is valid while it's kept
+		xercesc::DOMElement * element(std::size_t index) const;
+		void release(std::size_t index) const;
+		void release_all() const;
+
+		/// memory used by index itself, without source data and loaded documents
+		std::size_t index_memory_size() const noexcept;
+
+	public:
+		static constexpr std::size_t npos = std::size_t(-1);
+
+		/// indexes data kept alive by storage(mapped_file, string, etc.), throws std::runtime_error on broken markup
+		lazy_document(std::string_view data, std::shared_ptr<const void> storage, const lazy_index_options & options = {});
+
+		lazy_document(const lazy_document &) = delete;
+		lazy_document & operator =(const lazy_document &) = delete;
+	};
+
+	/// maps file and builds its index
+	std::unique_ptr<lazy_document> open_lazy(const std::string & file, const lazy_index_options & options = {});
+	std::unique_ptr<lazy_document> open_lazy(const xml_string  & file, const lazy_index_options & options = {});
+}
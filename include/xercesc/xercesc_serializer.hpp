@@ -0,0 +1,213 @@
+﻿#pragma once
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include <xercesc/xercesc_utils.hpp>
+
+namespace xercesc_utils
+{
+	/************************************************************************/
+	/*                native utf-8 DOM serializer                           */
+	/************************************************************************/
+	enum class escape_mode : unsigned char
+	{
+		none,
+		text,      // & < > CR
+		attribute, // & < " LF CR TAB
+	};
+
+	/// Buffered utf-8 output used by native serializers.
+	/// Appends either into caller provided std::string, or into internal buffer which is
+	/// written into XMLFormatTarget/std::streambuf when it exceeds buffer_size.
+	/// Buffered data is written into target only by explicit flush, destructor does not flush.
+	class utf8_output
+	{
+		std::string m_own;
+		std::string * m_buffer;
+		xercesc::XMLFormatTarget * m_target = nullptr;
+		std::streambuf * m_sb = nullptr;
+		std::size_t m_buffer_size = 0;
+		char m_last_char = '\n';
+
+	private:
+		void write_through(const char * data, std::size_t size);
+		void overflow();
+		void check_overflow() { if (m_buffer_size and m_buffer->size() >= m_buffer_size) overflow(); }
+
+	public:
+		static constexpr std::size_t default_buffer_size = 64 * 1024;
+
+		void append(char ch) { m_buffer->push_back(m_last_char = ch); check_overflow(); }
+		void append(std::string_view str);
+		/// transcodes utf-16 to utf-8, escaping special characters according to mode
+		void append(const XMLCh * first, const XMLCh * last, escape_mode mode);
+		void append(xml_string_view str, escape_mode mode) { append(str.data(), str.data() + str.size(), mode); }
+		/// escapes already utf-8 encoded string
+		void append_escaped(std::string_view str, escape_mode mode);
+
+		/// true if nothing was written yet or last written char is new line
+		bool at_line_start() const noexcept { return m_last_char == '\n'; }
+		/// sets line start state, used when output continues data written by another output(parallel chunks)
+		void set_line_start(bool line_start) noexcept { m_last_char = line_start ? '\n' : '>'; }
+		/// writes buffered data into target, for string output does nothing
+		void flush();
+
+		/// direct access to underlying buffer, for string output - caller's string
+		std::string & buffer() noexcept { return *m_buffer; }
+
+	public:
+		explicit utf8_output(std::string & str) : m_buffer(&str) {}
+		explicit utf8_output(xercesc::XMLFormatTarget & target, std::size_t buffer_size = default_buffer_size);
+		explicit utf8_output(std::streambuf & sb, std::size_t buffer_size = default_buffer_size);
+
+		utf8_output(const utf8_output &) = delete;
+		utf8_output & operator =(const utf8_output &) = delete;
+	};
+
+	/// Serializes DOM directly into utf-8, without DOMLSSerializer and XMLFormatter.
+	/// Output format follows DOMLSSerializer configured as in save/print:
+	///  * xml declaration: <?xml version="1.0" encoding="utf-8" standalone="no" ?>
+	///  * pretty_print: 2 spaces indentation, "\n" new lines, whitespace only text nodes are skipped,
+	///    elements with only text content are kept on one line;
+	///  * text is escaped as & < > CR, attribute values as & < " LF CR TAB, as XMLFormatter CharEscapes/AttrEscapes do;
+	///  * empty elements are written as <tag/>, unspecified(DTD default) attributes are skipped;
+	///  * attribute values of several nodes(created via DOM) are written from their text and entity references(&name;),
+	///    as DOMLSSerializer with entities feature does. DOMAttr::getValue, which would build such value in document pool, is not called,
+	///    so serializing is pure reading of document.
+	/// Namespace declarations present as xmlns attributes are written as is,
+	/// missing ones required by element/attribute namespaces are added(namespace fixup).
+	/// Namespaced attribute without prefix, or with prefix bound to other namespace, is written with prefix bound to its namespace
+	/// in scope or with generated nsN one.
+	///
+	/// Traversal is iterative, document depth is not limited by stack size.
+	class dom_utf8_serializer
+	{
+		utf8_output * m_out;
+		bool m_pretty;
+		bool m_prev_text = false; // last written sibling was text, end tag is not moved to new line
+
+		// in-scope namespace bindings, prefix -> uri, m_scopes holds m_bindings size on each element start
+		std::vector<std::pair<xml_string_view, xml_string_view>> m_bindings;
+		std::vector<std::size_t> m_scopes;
+		// strings bindings refer to: generated prefixes, values of namespace declarations built from several attribute nodes
+		std::deque<xml_string> m_strings;
+
+	private:
+		void new_line(unsigned level);
+		bool is_bound(xml_string_view prefix, xml_string_view uri) const;
+		/// non empty prefix bound to uri in scope
+		bool find_prefix(xml_string_view uri, xml_string_view & prefix) const;
+		/// nsN prefix not bound in scope
+		xml_string_view unused_prefix();
+		void write_namespace_declaration(xml_string_view prefix, xml_string_view uri);
+		void write_attributes(const xercesc::DOMElement * element);
+		void write_attribute_value(const xercesc::DOMAttr * attr);
+		void write_leaf(const xercesc::DOMNode * node, unsigned level);
+
+	public:
+		/// writes node with all it's children
+		void write(const xercesc::DOMNode * node, unsigned level = 0);
+		void write_document(const xercesc::DOMDocument * doc, bool xml_declaration = true);
+		void write_declaration(const xercesc::DOMDocument * doc);
+
+		/// building blocks for streaming writers:
+		/// start tag opens namespace scope and is written fully closed with '>', end tag closes the scope
+		void write_start_tag(const xercesc::DOMElement * element, unsigned level);
+		void write_end_tag(const xercesc::DOMElement * element, unsigned level);
+		/// new line at the end of document for pretty_print
+		void finish_document();
+
+		/// adds binding into current scope, as if it was declared by some outer element already written
+		void bind_namespace(xml_string_view prefix, xml_string_view uri);
+		/// nullptr if prefix is not bound
+		auto lookup_namespace(xml_string_view prefix) const -> const xml_string_view *;
+		auto namespace_bindings() const noexcept -> const std::vector<std::pair<xml_string_view, xml_string_view>> & { return m_bindings; }
+
+		utf8_output & output() const noexcept { return *m_out; }
+
+		/// last written sibling was text, end tag of parent is written on the same line.
+		/// Allows continuing output produced by another serializer(parallel chunks)
+		bool after_text() const noexcept { return m_prev_text; }
+		void set_after_text(bool after_text) noexcept { m_prev_text = after_text; }
+
+	public:
+		dom_utf8_serializer(utf8_output & out, save_option save_option = pretty_print);
+	};
+
+	/// Writes document fragment at a time, so huge documents do not need to be resident in memory:
+	/// constructor writes xml declaration, root start tag with namespace declarations and children root already has,
+	/// write serializes given subtree as root child and releases it, finish writes root end tag.
+	///
+	///   auto * root = doc->getDocumentElement();
+	///   streaming_document_writer writer(target, root);
+	///   for (...)
+	///   {
+	///       auto * item = create_element_ns(root, ns, "item"); // fill item with acquire_path, set_path_text, etc.
+	///       writer.write(item);                                // item is written, detached and released
+	///   }
+	///   writer.finish();
+	///
+	/// Released nodes are recycled by Xerces document for next fragments, so peak memory stays about one fragment.
+	/// Root element must stay alive and it's name/attributes unchanged until finish.
+	/// Output is the same as native_save of document with all written fragments appended to root children it had at construction,
+	/// so children which existed at construction must not be passed to write.
+	class streaming_document_writer
+	{
+		std::optional<utf8_output> m_own_output;
+		utf8_output * m_out;
+		dom_utf8_serializer m_serializer;
+		const xercesc::DOMElement * m_root;
+		bool m_finished = false;
+
+	private:
+		void start(bool xml_declaration);
+
+	public:
+		/// serializes node(element, text, comment, etc.) as root child, then detaches it from parent and releases it
+		void write(xercesc::DOMNode * node);
+		/// serializes node as root child, node is left untouched
+		void write_copy(const xercesc::DOMNode * node);
+		/// writes root end tag, and for document element - following document children(comments, PIs), flushes output
+		void finish();
+
+		bool finished() const noexcept { return m_finished; }
+		utf8_output & output() const noexcept { return *m_out; }
+
+	public:
+		/// xml_declaration is written only if root is document element
+		streaming_document_writer(utf8_output & out, const xercesc::DOMElement * root, save_option save_option = pretty_print, bool xml_declaration = true);
+		streaming_document_writer(xercesc::XMLFormatTarget & target, const xercesc::DOMElement * root, save_option save_option = pretty_print, bool xml_declaration = true);
+		streaming_document_writer(std::streambuf & sb, const xercesc::DOMElement * root, save_option save_option = pretty_print, bool xml_declaration = true);
+
+		streaming_document_writer(const streaming_document_writer &) = delete;
+		streaming_document_writer & operator =(const streaming_document_writer &) = delete;
+	};
+
+	std::string native_save(xercesc::DOMDocument * doc, save_option save_option = pretty_print);
+	void native_save(std::string & str, xercesc::DOMDocument * doc, save_option save_option = pretty_print); // appends
+	void native_save(std::streambuf & sb, xercesc::DOMDocument * doc, save_option save_option = pretty_print);
+	void native_save(xercesc::XMLFormatTarget & target, xercesc::DOMDocument * doc, save_option save_option = pretty_print);
+	void native_save_to_file(xercesc::DOMDocument * doc, const std::string & file, save_option save_option = pretty_print);
+	void native_save_to_file(xercesc::DOMDocument * doc, const std::string & file, const file_target_options & options, save_option save_option = pretty_print);
+
+	std::string native_print(xercesc::DOMElement * element, save_option save_option = pretty_print);
+	void native_print(std::string & str, xercesc::DOMElement * element, save_option save_option = pretty_print); // appends
+
+	/// Parallel variants of native_save: child subtrees of the document element are split into batches,
+	/// serialized concurrently into separate utf-8 buffers(with namespace bindings in scope of the document element
+	/// and proper indentation) and written into target in document order. Output is identical to native_save.
+	/// Workers run ahead of the writer by limited number of batches, so memory stays bounded.
+	///
+	/// nthreads = 0 - std::thread::hardware_concurrency(). Documents with less than 2 root children are saved sequentially.
+	/// Document must not be modified during the save. Xerces DOM is not generally safe for concurrent reading(some getters
+	/// build values in document heap), workers use only getters which return stored data, see dom_utf8_serializer.
+	std::string native_save_parallel(xercesc::DOMDocument * doc, save_option save_option = pretty_print, unsigned nthreads = 0);
+	void native_save_parallel(std::string & str, xercesc::DOMDocument * doc, save_option save_option = pretty_print, unsigned nthreads = 0); // appends
+	void native_save_parallel(std::streambuf & sb, xercesc::DOMDocument * doc, save_option save_option = pretty_print, unsigned nthreads = 0);
+	void native_save_parallel(xercesc::XMLFormatTarget & target, xercesc::DOMDocument * doc, save_option save_option = pretty_print, unsigned nthreads = 0);
+	void native_save_to_file_parallel(xercesc::DOMDocument * doc, const std::string & file, save_option save_option = pretty_print, unsigned nthreads = 0);
+	void native_save_to_file_parallel(xercesc::DOMDocument * doc, const std::string & file, const file_target_options & options, save_option save_option = pretty_print, unsigned nthreads = 0);
+}
@@ -0,0 +1,83 @@
+﻿#pragma once
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_serializer.hpp>
+
+namespace xercesc_utils
+{
+	/************************************************************************/
+	/*                  precompiled document templates                      */
+	/************************************************************************/
+	/// Skeleton document with variable slots, for producing many near identical documents
+	/// without building and serializing DOM for each of them:
+	///
+	///   auto skeleton = load_from_file("response.xml");
+	///   document_template tmpl(skeleton.get(), {"r:response/r:id", "r:response/r:status/@code", "r:response/r:body/r:text"});
+	///   for (...)
+	///       tmpl.render(out, {id, code, text});
+	///
+	/// Slot paths are find_path paths from document, last segment @attribute addresses attribute, which may not exist in skeleton.
+	/// Text slot replaces whole content of its element, so it can't contain other slots.
+	/// Skeleton is rendered once by native serializer into byte segments, render writes them with escaped slot values in between.
+	/// Output is the same as native_save of skeleton with slots filled, except empty text slot is written as <tag></tag>
+	/// and whitespace only text slot is kept for pretty_print.
+	/// Values are utf-8, given in the order of slot paths.
+	///
+	/// Skeleton must not contain private use characters U+E000 and U+E001, they mark slots while rendering.
+	class document_template
+	{
+		struct slot
+		{
+			std::string path;
+			std::vector<std::size_t> route;  // child node indexes from document to slot element
+			xml_string attribute;            // empty for text slot
+		};
+
+		std::shared_ptr<xercesc::DOMDocument> m_skeleton; // own copy with marked slots
+		std::vector<slot> m_slots;
+		std::vector<std::string> m_segments;   // fixed output, m_segments.size() == m_slots.size() + 1
+		std::vector<std::size_t> m_order;      // slot written after each segment, in document order
+		std::size_t m_fixed_size = 0;
+
+	private:
+		void check_values(std::size_t count) const;
+		void render_values(utf8_output & out, const std::string_view * values) const;
+		std::shared_ptr<xercesc::DOMDocument> instantiate_values(const std::string_view * values) const;
+
+	public:
+		std::size_t slot_count() const noexcept { return m_slots.size(); }
+		const std::string & slot_path(std::size_t index) const { return m_slots.at(index).path; }
+		/// index of slot path, throws std::invalid_argument if there is no such slot
+		std::size_t slot_index(std::string_view path) const;
+		/// total size of fixed segments, output size without values
+		std::size_t fixed_size() const noexcept { return m_fixed_size; }
+
+		/// writes document, throws std::invalid_argument if number of values differs from slot_count
+		void render(utf8_output & out, const std::vector<std::string_view> & values) const;
+		void render(std::string & str, const std::vector<std::string_view> & values) const; // appends
+		void render(std::streambuf & sb, const std::vector<std::string_view> & values) const;
+		void render(xercesc::XMLFormatTarget & target, const std::vector<std::string_view> & values) const;
+		std::string render(const std::vector<std::string_view> & values) const;
+
+		void render(utf8_output & out, std::initializer_list<std::string_view> values) const;
+		std::string render(std::initializer_list<std::string_view> values) const;
+
+		/// clone of skeleton with filled slots, for further DOM modification
+		std::shared_ptr<xercesc::DOMDocument> instantiate(const std::vector<std::string_view> & values) const;
+		std::shared_ptr<xercesc::DOMDocument> instantiate(std::initializer_list<std::string_view> values) const;
+
+	public:
+		/// Skeleton is copied, it can be released or changed afterwards.
+		/// Throws xml_path_exception for missing slot element, std::invalid_argument for invalid slots
+		document_template(const xercesc::DOMDocument * skeleton, const std::vector<std::string> & slots,
+		                  save_option save_option = pretty_print, bool xml_declaration = true);
+
+		document_template(const document_template &) = delete;
+		document_template & operator =(const document_template &) = delete;
+	};
+}
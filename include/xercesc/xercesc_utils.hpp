@@ -1,11 +1,15 @@
 ﻿#pragma once
+#include <cstdint>
 #include <memory>
 #include <utility>
+#include <iterator>
 #include <algorithm>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <vector>
+#include <deque>
 #include <istream>
 #include <ostream>
 #include <xercesc/xercesc_include.h>
@@ -24,7 +28,7 @@ namespace xercesc_utils
 	
 	
 	inline void xercesc_init() { xercesc::XMLPlatformUtils::Initialize(); }
-	inline void xercesc_free() { xercesc::XMLPlatformUtils::Terminate();  }
+	       void xercesc_free();
 
 
 	using xml_string      = std::basic_string<XMLCh>;
@@ -76,6 +80,7 @@ namespace xercesc_utils
 	using DOMLSSerializerPtr = std::unique_ptr<xercesc::DOMLSSerializer, xercesc_release_deleter>;
 	using DOMLSOutputPtr     = std::unique_ptr<xercesc::DOMLSOutput, xercesc_release_deleter>;
 	using DOMXPathResultPtr  = std::unique_ptr<xercesc::DOMXPathResult, xercesc_release_deleter>;
+	using DOMXPathExpressionPtr = std::unique_ptr<xercesc::DOMXPathExpression, xercesc_release_deleter>;
 
 
 	std::string to_ansi(const XMLCh * str, std::size_t len = -1);
@@ -113,13 +118,156 @@ namespace xercesc_utils
 		pretty_print = true, as_is = false,
 	};
 	
+	/// XMLFormatTarget appending serialized bytes directly into caller owned container: std::string, std::vector<char>, etc.
+	/// size_hint, if given, is reserved in addition to current container size.
+	template <class Container>
+	class container_target : public xercesc::XMLFormatTarget
+	{
+		Container * m_cont;
+
+	public:
+		void writeChars(const XMLByte * const toWrite, const XMLSize_t count, xercesc::XMLFormatter * const formatter) override
+		{
+			auto * first = reinterpret_cast<const typename Container::value_type *>(toWrite);
+			m_cont->insert(m_cont->end(), first, first + count);
+		}
+
+	public:
+		container_target(Container & cont, std::size_t size_hint = 0) : m_cont(&cont)
+		{
+			if (size_hint) cont.reserve(cont.size() + size_hint);
+		}
+	};
+
+	using string_target = container_target<std::string>;
+	using vector_target = container_target<std::vector<char>>;
+
+	/// XMLFormatTarget appending serialized bytes into list of fixed capacity chunks,
+	/// already written data is never moved or copied. Good for big outputs which are written out later chunk by chunk.
+	/// size_hint, if given, reserves list for that many bytes of chunks.
+	class chunked_target : public xercesc::XMLFormatTarget
+	{
+		std::vector<std::string> * m_chunks;
+		std::size_t m_chunk_size;
+
+	public:
+		void writeChars(const XMLByte * const toWrite, const XMLSize_t count, xercesc::XMLFormatter * const formatter) override;
+
+	public:
+		static constexpr std::size_t default_chunk_size = 64 * 1024;
+		chunked_target(std::vector<std::string> & chunks, std::size_t chunk_size = default_chunk_size, std::size_t size_hint = 0);
+	};
+
+	enum class fsync_policy : unsigned char
+	{
+		none, // data is left in OS cache
+		data, // fdatasync file before close
+		full, // fsync file, and in atomic mode - also directory after rename
+	};
+
+	struct file_target_options
+	{
+		/// writes are accumulated up to buffer_size, bigger writes go directly together with buffered data(writev)
+		std::size_t buffer_size = 1024 * 1024;
+		/// expected file size, if not 0 - space is reserved with fallocate where supported, unused tail is truncated on commit
+		std::size_t preallocate = 0;
+		/// data is written into temporary file in the same directory, which is renamed over target file on commit.
+		/// Readers observe either old file or completely written new one. On POSIX replaced file keeps its permission bits.
+		bool atomic = false;
+		fsync_policy fsync = fsync_policy::none;
+	};
+
+	/// XMLFormatTarget writing directly into file descriptor with big buffer.
+	/// commit must be called after serialization: it writes buffered data, syncs and closes the file,
+	/// and in atomic mode replaces target file; errors are reported by exceptions(std::system_error).
+	/// Destructor without commit: atomic mode - temporary file is removed, target is untouched;
+	/// otherwise buffered data is written ignoring errors.
+	class file_target : public xercesc::XMLFormatTarget
+	{
+		file_target_options m_options;
+		std::string m_path, m_temp_path; // utf-8/native narrow paths
+		xml_string m_wpath, m_wtemp_path; // utf-16 paths, used on windows
+		std::vector<char> m_buffer;
+		std::size_t m_buffered = 0;
+		std::uint64_t m_written = 0;
+		int m_fd = -1;
+
+	private:
+		void open();
+		void write_all(const char * data1, std::size_t size1, const char * data2, std::size_t size2);
+		void close() noexcept;
+
+	public:
+		void writeChars(const XMLByte * const toWrite, const XMLSize_t count, xercesc::XMLFormatter * const formatter) override;
+		/// writes buffered data into file
+		void flush() override;
+		void commit();
+
+		/// total bytes written so far, including buffered
+		std::uint64_t size() const noexcept { return m_written + m_buffered; }
+		bool is_open() const noexcept { return m_fd >= 0; }
+
+	public:
+		file_target(const std::string & path, const file_target_options & options = {});
+		file_target(const xml_string  & path, const file_target_options & options = {});
+		~file_target();
+
+		file_target(const file_target &) = delete;
+		file_target & operator =(const file_target &) = delete;
+	};
+
+	/// Read-only memory mapping of whole file(mmap/MapViewOfFile), unmapped on destruction.
+	/// Errors are reported by exceptions(std::system_error), empty file gives empty mapping.
+	class mapped_file
+	{
+		const char * m_data = nullptr;
+		std::size_t m_size = 0;
+		void * m_file = nullptr;    // windows file and mapping handles
+		void * m_mapping = nullptr;
+
+	private:
+		void open(const std::string & path, const xml_string & wpath);
+		void close() noexcept;
+
+	public:
+		const char * data() const noexcept { return m_data; }
+		std::size_t size() const noexcept { return m_size; }
+		std::string_view view() const noexcept { return std::string_view(m_data, m_size); }
+
+	public:
+		explicit mapped_file(const std::string & path);
+		explicit mapped_file(const xml_string  & path);
+		~mapped_file();
+
+		mapped_file(const mapped_file &) = delete;
+		mapped_file & operator =(const mapped_file &) = delete;
+	};
+
+	/// print/save functions reuse per-thread cached DOMLSSerializer objects, configured once per save_option and encoding.
+	/// Releases cached serializers of calling thread, xercesc_free does this automatically for the calling thread,
+	/// caches of other threads are invalidated and abandoned(not released) after xercesc_free.
+	void clear_serializer_cache();
+
+	/// serializes element subtree into utf-8, without xml declaration
 	std::string print(xercesc::DOMElement * element, save_option save_option = pretty_print);
+	void print(xercesc::XMLFormatTarget & target, xercesc::DOMElement * element, save_option save_option = pretty_print);
+	void print(std::string & str, xercesc::DOMElement * element, save_option save_option = pretty_print); // appends
+	void print(std::streambuf & sb, xercesc::DOMElement * element, save_option save_option = pretty_print);
+	void print(std::ostream & os, xercesc::DOMElement * element, save_option save_option = pretty_print);
+
 	std::string save(xercesc::DOMDocument * doc, save_option save_option = pretty_print, const XMLCh * encoding = XERCESC_LIT("utf-8"));
 	void save_to_file(xercesc::DOMDocument * doc, const xml_string  & file, save_option save_option = pretty_print, const XMLCh * encoding = XERCESC_LIT("utf-8"));
 	void save_to_file(xercesc::DOMDocument * doc, const std::string & file, save_option save_option = pretty_print, const XMLCh * encoding = XERCESC_LIT("utf-8"));
+	void save_to_file(xercesc::DOMDocument * doc, const xml_string  & file, const file_target_options & options, save_option save_option = pretty_print, const XMLCh * encoding = XERCESC_LIT("utf-8"));
+	void save_to_file(xercesc::DOMDocument * doc, const std::string & file, const file_target_options & options, save_option save_option = pretty_print, const XMLCh * encoding = XERCESC_LIT("utf-8"));
 
 	void save(std::streambuf & sb, xercesc::DOMDocument * doc, save_option save_option = pretty_print, const XMLCh * encoding = XERCESC_LIT("utf-8"));
 	void save(std::ostream & os, xercesc::DOMDocument * doc, save_option save_option = pretty_print, const XMLCh * encoding = XERCESC_LIT("utf-8"));
+	void save(xercesc::XMLFormatTarget & target, xercesc::DOMDocument * doc, save_option save_option = pretty_print, const XMLCh * encoding = XERCESC_LIT("utf-8"));
+	// append serialized document to given container, size_hint - expected output size, reserved in advance
+	void save(std::string & str, xercesc::DOMDocument * doc, save_option save_option = pretty_print, const XMLCh * encoding = XERCESC_LIT("utf-8"), std::size_t size_hint = 0);
+	void save(std::vector<char> & buf, xercesc::DOMDocument * doc, save_option save_option = pretty_print, const XMLCh * encoding = XERCESC_LIT("utf-8"), std::size_t size_hint = 0);
+	void save(std::vector<std::string> & chunks, xercesc::DOMDocument * doc, save_option save_option = pretty_print, const XMLCh * encoding = XERCESC_LIT("utf-8"), std::size_t size_hint = 0);
 
 	std::shared_ptr<xercesc::DOMDocument> load(std::string_view str);
 	std::shared_ptr<xercesc::DOMDocument> load(const char * data, std::size_t size);
@@ -128,19 +276,64 @@ namespace xercesc_utils
 
 	std::shared_ptr<xercesc::DOMDocument> load(std::streambuf & is);
 	std::shared_ptr<xercesc::DOMDocument> load(std::istream & is);
+	std::shared_ptr<xercesc::DOMDocument> load(const xercesc::InputSource & input);
 
 	class DOMXPathNSResolverImpl;
 	using DOMXPathNSResolverImplPtr = std::unique_ptr<DOMXPathNSResolverImpl, xercesc_release_deleter>;
 
+	/// Immutable set of namespace bindings, shared between resolvers.
+	/// Resolvers typically hold few bindings, so they are scanned linearly with precomputed key hashes:
+	/// lookups hash the key and scan for matching hash, without any allocations.
+	/// Mappings are kept in deques, so strings returned by lookups stay valid while bindings live,
+	/// adding bindings through resolver does not move them. Only rebinding the same prefix(uri) replaces previous value.
+	class namespace_bindings
+	{
+		friend class DOMXPathNSResolverImpl;
+
+		struct mapping
+		{
+			std::size_t key_hash;
+			xml_string key, value;
+		};
+
+		std::deque<mapping> m_uri_mappings;    // prefix -> uri
+		std::deque<mapping> m_prefix_mappings; // uri -> prefix
+
+	private:
+		static std::size_t hash(xml_string_view str) noexcept;
+		/// index of mapping with given key, or mappings.size()
+		static std::size_t find(const std::deque<mapping> & mappings, xml_string_view key) noexcept;
+		static void assign(std::deque<mapping> & mappings, xml_string_view key, xml_string_view value);
+
+		void add(xml_string_view prefix, xml_string_view uri);
+
+	public:
+		const XMLCh * lookup_uri(xml_string_view prefix) const noexcept;
+		const XMLCh * lookup_prefix(xml_string_view uri) const noexcept;
+		std::size_t size() const noexcept { return m_uri_mappings.size(); }
+
+	public:
+		static auto create(std::initializer_list<std::pair<std::string_view, std::string_view>> items) -> std::shared_ptr<const namespace_bindings>;
+		static auto create(std::initializer_list<std::pair<xml_string, xml_string>> items) -> std::shared_ptr<const namespace_bindings>;
+	};
+
+	using namespace_bindings_ptr = std::shared_ptr<const namespace_bindings>;
+
+	/// Resolver over shared immutable namespace_bindings: clone and construction from bindings share them,
+	/// addNamespaceBinding copies bindings only if they are shared with other resolvers(copy-on-write).
+	/// Bindings replaced by copy are kept until resolver is released, so strings returned by its lookups stay valid as long as resolver.
 	class DOMXPathNSResolverImpl : public xercesc::DOMXPathNSResolver
 	{
-		std::unordered_map<xml_string, xml_string> m_uri_mappings;
-		std::unordered_map<xml_string, xml_string> m_prefix_mappings;
+		namespace_bindings_ptr m_bindings;
+		std::vector<namespace_bindings_ptr> m_replaced;
+
+	private:
+		void add_binding(xml_string_view prefix, xml_string_view uri);
 
 	public:
-		void addNamespaceBinding(std::string_view prefix, std::string_view uri) { return addNamespaceBinding(to_xmlch(prefix), to_xmlch(uri)); }
-		void addNamespaceBinding(xml_string_view  prefix, xml_string_view  uri) { return addNamespaceBinding(xml_string(prefix.data(), prefix.size()), xml_string(uri.data(), uri.size())); }
-		void addNamespaceBinding(xml_string prefix, xml_string uri);
+		void addNamespaceBinding(std::string_view prefix, std::string_view uri) { return add_binding(to_xmlch(prefix), to_xmlch(uri)); }
+		void addNamespaceBinding(xml_string_view  prefix, xml_string_view  uri) { return add_binding(prefix, uri); }
+		void addNamespaceBinding(xml_string prefix, xml_string uri) { return add_binding(prefix, uri); }
 
 		void addNamespaceBinding(const XMLCh * prefix, const XMLCh * uri) override;
 		void release() override;
@@ -148,17 +341,26 @@ namespace xercesc_utils
 		const XMLCh * lookupNamespaceURI(const XMLCh* prefix) const override;
 		const XMLCh * lookupPrefix(const XMLCh* URI) const override;
 
+		const XMLCh * lookupNamespaceURI(xml_string_view prefix) const noexcept { return m_bindings->lookup_uri(prefix); }
+		const XMLCh * lookupPrefix(xml_string_view uri) const noexcept { return m_bindings->lookup_prefix(uri); }
+
+		/// current bindings, can be used to create other resolvers sharing them
+		const namespace_bindings_ptr & bindings() const noexcept { return m_bindings; }
+
 	public:
+		/// cheap: new resolver shares bindings with this one
 		DOMXPathNSResolverImpl * clone() const;
 
 	public:
-		DOMXPathNSResolverImpl() = default;
+		DOMXPathNSResolverImpl();
+		explicit DOMXPathNSResolverImpl(namespace_bindings_ptr bindings);
 		virtual ~DOMXPathNSResolverImpl() = default;
 	};
 
 
 	DOMXPathNSResolverImplPtr create_resolver(std::initializer_list<std::pair<std::string_view, std::string_view>> items);
 	DOMXPathNSResolverImplPtr create_resolver(std::initializer_list<std::pair<xml_string, xml_string>> items);
+	DOMXPathNSResolverImplPtr create_resolver(namespace_bindings_ptr bindings);
 \
 	/************************************************************************/
 	/*                      namespace helpers                               */
@@ -197,6 +399,8 @@ namespace xercesc_utils
 
 	auto associate_namespaces(xercesc::DOMNode * node, std::initializer_list<std::pair<std::string_view, std::string_view>> items) -> DOMXPathNSResolverImpl *;
 	auto associate_namespaces(xercesc::DOMNode * node, std::initializer_list<std::pair<xml_string, xml_string>> items) -> DOMXPathNSResolverImpl *;
+	/// bindings are shared, prefer this overload when same namespaces are associated with many nodes/documents
+	auto associate_namespaces(xercesc::DOMNode * node, namespace_bindings_ptr bindings) -> DOMXPathNSResolverImpl *;
 
 	void set_namespace(xercesc::DOMElement  * element, xml_string prefix, xml_string uri);
 	void set_namespace(xercesc::DOMDocument * doc,     xml_string prefix, xml_string uri);
@@ -207,6 +411,26 @@ namespace xercesc_utils
 	void set_namespaces(xercesc::DOMDocument * doc, std::initializer_list<std::pair<std::string_view, std::string_view>> items);
 	void set_namespaces(xercesc::DOMDocument * doc, std::initializer_list<std::pair<xml_string, xml_string>> items);
 
+	/// Optional per-document cache of in-scope namespace bindings.
+	/// Without it, each prefix resolution(find_child, next_sibling, find_attribute_node, acquire_path, create_element_ns, etc.
+	/// for documents without associated resolver) walks ancestor chain scanning attributes on each level.
+	/// With it, scope of each element is built lazily once from parent's scope(elements without declarations share parent's scope),
+	/// and lookups become a hash lookup plus short scan. Results are the same as DOMNode lookupNamespaceURI/lookupPrefix/isDefaultNamespace.
+	///
+	/// Cache is invalidated by xercesc_utils mutators which can change namespace scopes(set_namespace, set_attribute_ns with xmlns namespace,
+	/// rename_subtree, etc.), after other modifications of namespace declarations, element prefixes, tree structure or releasing nodes
+	/// invalidate_namespace_cache must be called. Cache is thread safe.
+	void enable_namespace_cache(xercesc::DOMDocument * doc);
+	void disable_namespace_cache(xercesc::DOMDocument * doc);
+	bool has_namespace_cache(const xercesc::DOMDocument * doc);
+	/// drops cached scopes of node owner document, does nothing if cache is not enabled
+	void invalidate_namespace_cache(const xercesc::DOMNode * node);
+
+	/// same as node->lookupNamespaceURI/lookupPrefix/isDefaultNamespace, but through namespace cache if it's enabled
+	const XMLCh * lookup_namespace_uri(const xercesc::DOMNode * node, const XMLCh * prefix);
+	const XMLCh * lookup_prefix(const xercesc::DOMNode * node, const XMLCh * uri);
+	bool is_default_namespace(const xercesc::DOMNode * node, const XMLCh * uri);
+
 	/************************************************************************/
 	/*                    create helpers                                    */
 	/************************************************************************/
@@ -271,6 +495,88 @@ namespace xercesc_utils
 	template <class String> inline void set_path_text(xercesc::DOMElement * element, const String & path, std::string_view value) { return set_path_text(element, forward_xml_string_view(path), value); }
 	template <class String>	inline void set_path_text(xercesc::DOMDocument * doc,    const String & path, std::string_view value) { return set_path_text(doc,     forward_xml_string_view(path), value); }
 
+	/************************************************************************/
+	/*                    interned name atoms                               */
+	/************************************************************************/
+	/// (namespace, local name) pair interned into string pool of document.
+	/// Xerces keeps node names in that pool, so matching element of the same document against atom
+	/// is two pointer comparisons, without reading or measuring strings.
+	/// Atom is valid only for nodes of its document and while document is alive.
+	/// Interning adds strings to the pool for document lifetime and, as any document modification, is not thread safe.
+	///
+	///   auto item = intern_name(doc, XERCESC_LIT("urn:catalog"), XERCESC_LIT("item"));
+	///   for (auto * el = find_child(list, item); el; el = next_sibling(el, item)) ...
+	class name_atom
+	{
+		friend name_atom intern_name(xercesc::DOMDocument * doc, xml_string_view namespace_uri, xml_string_view local_name);
+
+		const xercesc::DOMDocument * m_doc = nullptr;
+		const XMLCh * m_namespace_uri = nullptr; // pooled, nullptr for no namespace
+		const XMLCh * m_local_name = nullptr;    // pooled
+
+	private:
+		name_atom(const xercesc::DOMDocument * doc, const XMLCh * namespace_uri, const XMLCh * local_name) noexcept
+		    : m_doc(doc), m_namespace_uri(namespace_uri), m_local_name(local_name) {}
+
+	public:
+		bool valid() const noexcept { return m_local_name != nullptr; }
+		const xercesc::DOMDocument * document() const noexcept { return m_doc; }
+		const XMLCh * namespace_uri() const noexcept { return m_namespace_uri; }
+		const XMLCh * local_name() const noexcept { return m_local_name; }
+
+		/// node must belong to atom document, elements created without namespace(createElement) are matched by node name
+		bool matches(const xercesc::DOMNode * node) const noexcept
+		{
+			auto * local_name = node->getLocalName();
+			if (not local_name) local_name = node->getNodeName();
+			return local_name == m_local_name and node->getNamespaceURI() == m_namespace_uri;
+		}
+
+		bool operator ==(const name_atom & other) const noexcept { return m_local_name == other.m_local_name and m_namespace_uri == other.m_namespace_uri; }
+		bool operator !=(const name_atom & other) const noexcept { return not operator ==(other); }
+
+	public:
+		name_atom() = default;
+	};
+
+	/// throws std::invalid_argument if document is not Xerces DOMDocumentImpl
+	name_atom intern_name(xercesc::DOMDocument * doc, xml_string_view namespace_uri, xml_string_view local_name);
+	/// prefix of qualified name is resolved as in find_child: via associated resolver or namespaces in scope of element
+	name_atom intern_name(xercesc::DOMElement * element, xml_string_view qualified_name);
+
+	xercesc::DOMElement * find_child(xercesc::DOMElement * element, const name_atom & name);
+	xercesc::DOMElement * next_sibling(xercesc::DOMElement * element, const name_atom & name);
+
+	/// Path compiled into atoms once, prefixes are resolved at compile time against compile context.
+	/// Document path(compiled with document or starting with '/') matches first segment against document element.
+	class atom_path
+	{
+		friend atom_path compile_path(xercesc::DOMElement * element, xml_string_view path);
+		friend atom_path compile_path(xercesc::DOMDocument * doc, xml_string_view path);
+
+		xml_string m_path;
+		std::vector<name_atom> m_atoms;
+		bool m_absolute = false;
+
+	public:
+		const xml_string & path() const noexcept { return m_path; }
+		const std::vector<name_atom> & atoms() const noexcept { return m_atoms; }
+		bool absolute() const noexcept { return m_absolute; }
+	};
+
+	atom_path compile_path(xercesc::DOMElement * element, xml_string_view path);
+	atom_path compile_path(xercesc::DOMDocument * doc, xml_string_view path);
+
+	xercesc::DOMElement * find_path(xercesc::DOMElement * element, const atom_path & path);
+	xercesc::DOMElement * find_path(xercesc::DOMDocument * doc, const atom_path & path);
+	xercesc::DOMElement * get_path(xercesc::DOMElement * element, const atom_path & path);
+	xercesc::DOMElement * get_path(xercesc::DOMDocument * doc, const atom_path & path);
+
+	template <class NamespaceString, class NameString> inline name_atom intern_name(xercesc::DOMDocument * doc, const NamespaceString & namespace_uri, const NameString & local_name) { return intern_name(doc, forward_xml_string_view(namespace_uri), forward_xml_string_view(local_name)); }
+	template <class String> inline name_atom intern_name(xercesc::DOMElement * element, const String & qualified_name) { return intern_name(element, forward_xml_string_view(qualified_name)); }
+	template <class String> inline atom_path compile_path(xercesc::DOMElement * element, const String & path) { return compile_path(element, forward_xml_string_view(path)); }
+	template <class String> inline atom_path compile_path(xercesc::DOMDocument * doc, const String & path)    { return compile_path(doc,     forward_xml_string_view(path)); }
+
 	/************************************************************************/
 	/*                        attribute helpers                             */
 	/************************************************************************/
@@ -291,16 +597,32 @@ namespace xercesc_utils
 	/************************************************************************/
 	/*                        rename subtree group                          */
 	/************************************************************************/
-	xercesc::DOMElement * rename_subtree(xercesc::DOMElement * element, const xml_string & namespace_uri, const xml_string & prefix);
-	xercesc::DOMNode *    rename_subtree(xercesc::DOMNode *    node,    const xml_string & namespace_uri, const xml_string & prefix);
+	/// Moves element and all its descendant elements into namespace_uri with given prefix(empty prefix - default namespace), local names are kept.
+	/// Attributes(except namespace declarations and xml:*) are moved too: into namespace_uri with prefix, or into no namespace if prefix is empty,
+	/// as unprefixed attributes can't be in a namespace.
+	///
+	/// in_place renames nodes via DOMDocument::renameNode, nodes keep identity and user data where DOM allows it.
+	/// rebuild creates renamed copies of elements in one pass, moves other children(text, comments, etc.) into them
+	/// and replaces original subtree, which is released: old element pointers and their user data are gone.
+	/// Subtree is traversed iteratively, depth is not limited by stack.
+	/// If two attributes of one element would get the same name(id and q:id renamed with prefix p), std::invalid_argument is thrown
+	/// before anything is changed.
+	enum class rename_mode : unsigned char
+	{
+		in_place,
+		rebuild,
+	};
+
+	xercesc::DOMElement * rename_subtree(xercesc::DOMElement * element, const xml_string & namespace_uri, const xml_string & prefix, rename_mode mode = rename_mode::in_place);
+	xercesc::DOMNode *    rename_subtree(xercesc::DOMNode *    node,    const xml_string & namespace_uri, const xml_string & prefix, rename_mode mode = rename_mode::in_place);
 
 	template <class UriString, class PrefixString>
-	xercesc::DOMElement * rename_subtree(xercesc::DOMElement * element, const UriString & namespace_uri, const PrefixString & prefix)
-	{ return rename_subtree(element, forward_as_xml_string(namespace_uri), forward_as_xml_string(prefix)); }
+	xercesc::DOMElement * rename_subtree(xercesc::DOMElement * element, const UriString & namespace_uri, const PrefixString & prefix, rename_mode mode = rename_mode::in_place)
+	{ return rename_subtree(element, forward_as_xml_string(namespace_uri), forward_as_xml_string(prefix), mode); }
 
 	template <class UriString, class PrefixString>
-	xercesc::DOMElement * rename_subtree(xercesc::DOMNode * node, const UriString & namespace_uri, const PrefixString & prefix)
-	{ return rename_subtree(node, forward_as_xml_string(namespace_uri), forward_as_xml_string(prefix)); }
+	xercesc::DOMNode * rename_subtree(xercesc::DOMNode * node, const UriString & namespace_uri, const PrefixString & prefix, rename_mode mode = rename_mode::in_place)
+	{ return rename_subtree(node, forward_as_xml_string(namespace_uri), forward_as_xml_string(prefix), mode); }
 
 
 	/************************************************************************/
@@ -333,4 +655,79 @@ namespace xercesc_utils
 
 	template <class String> inline std::string find_xpath_text(xercesc::DOMDocument * doc, const String & path, std::string_view defval = empty_string)      { return find_xpath_text(doc->getDocumentElement(), forward_as_xml_string(path), defval); }
 	template <class String> inline std::string  get_xpath_text(xercesc::DOMDocument * doc, const String & path)                                              { return  get_xpath_text(doc->getDocumentElement(), forward_as_xml_string(path)); }
+
+	/// All nodes matched by xpath(elements, attributes, text nodes), in document order.
+	/// Result is a snapshot evaluated once, nodes are fetched from it on access.
+	///
+	///   for (auto * node : select_xpath(element, "item/@id")) ...
+	class xpath_node_range
+	{
+		DOMXPathResultPtr m_result;
+		std::size_t m_size = 0;
+
+	public:
+		class iterator
+		{
+			friend xpath_node_range;
+
+			xercesc::DOMXPathResult * m_result = nullptr;
+			std::size_t m_index = 0;
+
+			iterator(xercesc::DOMXPathResult * result, std::size_t index) noexcept : m_result(result), m_index(index) {}
+
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type        = xercesc::DOMNode *;
+			using difference_type   = std::ptrdiff_t;
+			using pointer           = value_type *;
+			using reference         = value_type;
+
+			iterator() = default;
+
+			reference operator *() const { m_result->snapshotItem(m_index); return m_result->getNodeValue(); }
+			iterator & operator ++() noexcept { ++m_index; return *this; }
+			iterator operator ++(int) noexcept { auto tmp = *this; ++m_index; return tmp; }
+
+			bool operator ==(const iterator & other) const noexcept { return m_index == other.m_index; }
+			bool operator !=(const iterator & other) const noexcept { return m_index != other.m_index; }
+		};
+
+	public:
+		std::size_t size() const noexcept { return m_size; }
+		bool empty() const noexcept { return m_size == 0; }
+
+		iterator begin() const noexcept { return {m_result.get(), 0}; }
+		iterator end()   const noexcept { return {m_result.get(), m_size}; }
+
+		xercesc::DOMNode * operator [](std::size_t index) const { return *iterator(m_result.get(), index); }
+		xercesc::DOMNode * at(std::size_t index) const;
+		/// nullptr if result is empty
+		xercesc::DOMNode * front() const { return empty() ? nullptr : (*this)[0]; }
+
+	public:
+		xpath_node_range() = default;
+		explicit xpath_node_range(DOMXPathResultPtr result);
+	};
+
+	xpath_node_range select_xpath(xercesc::DOMElement * element, const xml_string & path);
+	xpath_node_range select_xpath(xercesc::DOMElement * element, const xml_string & path, xercesc::DOMXPathNSResolver * resolver);
+
+	template <class String> inline xpath_node_range select_xpath(xercesc::DOMElement * element, const String & path)                                          { return select_xpath(element, forward_as_xml_string(path)); }
+	template <class String> inline xpath_node_range select_xpath(xercesc::DOMElement * element, const String & path, xercesc::DOMXPathNSResolver * resolver)  { return select_xpath(element, forward_as_xml_string(path), resolver); }
+	template <class String> inline xpath_node_range select_xpath(xercesc::DOMDocument * doc, const String & path)                                             { return select_xpath(doc->getDocumentElement(), forward_as_xml_string(path)); }
+	template <class String> inline xpath_node_range select_xpath(xercesc::DOMDocument * doc, const String & path, xercesc::DOMXPathNSResolver * resolver)     { return select_xpath(doc->getDocumentElement(), forward_as_xml_string(path), resolver); }
+
+	/// xpath helpers evaluate expressions compiled once and kept in process wide LRU cache.
+	/// Cache key is expression text plus namespaces its prefixes resolve to(via resolver or in-scope namespaces of context element),
+	/// so the same text with different bindings is compiled separately. Capacity is number of expressions, 0 disables cache.
+	/// xercesc_free clears the cache.
+	struct xpath_cache_statistics
+	{
+		std::uint64_t hits, misses;
+		std::size_t size, capacity;
+	};
+
+	void set_xpath_cache_capacity(std::size_t capacity);
+	auto get_xpath_cache_statistics() -> xpath_cache_statistics;
+	void clear_xpath_cache();
 }
@@ -0,0 +1,113 @@
+﻿#pragma once
+#include <cstddef>
+#include <string>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include <xercesc/xercesc_serializer.hpp>
+
+namespace xercesc_utils
+{
+	/************************************************************************/
+	/*                   DOM-free forward only xml writer                   */
+	/************************************************************************/
+	/// Forward only xml writer for producers which only emit xml: no DOM is built.
+	/// Writes utf-8 via utf8_output, names and values are utf-8 strings(values also can be given in utf-16).
+	///
+	///   xml_writer writer(str);
+	///   writer.write_declaration();
+	///   writer.start_element("urn:orders", "o:orders");
+	///   writer.start_element("urn:orders", "o:order");
+	///   writer.attribute("id", "42");
+	///   writer.text("some & text");
+	///   writer.end_element();
+	///   writer.finish();
+	///
+	/// Namespace prefixes are chosen by the same rules as create_element_ns/create_attribute_ns:
+	/// prefix given in qualified name is only a fallback, if some prefix is already bound to namespace in scope - it's used,
+	/// if namespace is default one - element is written without prefix. Missing declarations are written automatically.
+	/// Attribute prefix which is already bound to other namespace is replaced by generated nsN one.
+	/// Output format is the same as native_save of equivalent DOM(pretty print, escaping, empty elements as <tag/>),
+	/// text call corresponds to text node: even empty or whitespace only text makes element non empty.
+	class xml_writer
+	{
+		// names of open elements and namespace bindings are stored in arenas, truncated on end_element
+		struct element_entry
+		{
+			std::size_t name_offset, name_size;
+			std::size_t bindings_size, arena_size;
+		};
+
+		struct binding_entry
+		{
+			std::size_t prefix_offset, prefix_size;
+			std::size_t uri_offset, uri_size;
+		};
+
+		std::optional<utf8_output> m_own_output;
+		utf8_output * m_out;
+		bool m_pretty;
+		bool m_start_tag_open = false;
+		bool m_prev_text = false;
+
+		std::string m_arena;
+		std::vector<element_entry> m_elements;
+		std::vector<binding_entry> m_bindings;
+
+	private:
+		std::string_view arena_view(std::size_t offset, std::size_t size) const { return std::string_view(m_arena).substr(offset, size); }
+		/// false if prefix is not bound
+		bool lookup_binding(std::string_view prefix, std::string_view & uri) const;
+		bool is_bound(std::string_view prefix, std::string_view uri) const;
+		/// non empty prefix bound to uri and not shadowed by inner binding
+		bool find_prefix(std::string_view uri, std::string_view & prefix) const;
+		/// nsN prefix not bound in scope
+		std::string unused_prefix() const;
+
+		void new_line(unsigned level);
+		void close_start_tag();
+		void write_namespace_declaration(std::string_view prefix, std::string_view uri);
+		template <class String>
+		void write_attribute(std::string_view namespace_uri, std::string_view qualified_name, const String & value);
+		template <class String>
+		void write_text(const String & text);
+
+	public:
+		/// <?xml version="1.0" encoding="utf-8" standalone="no" ?>, must be first
+		void write_declaration();
+
+		/// element without namespace, default namespace is undeclared if needed.
+		/// Prefixed name without namespace throws std::invalid_argument, as for attributes.
+		void start_element(std::string_view qualified_name);
+		void start_element(std::string_view namespace_uri, std::string_view qualified_name);
+		/// explicit namespace declaration on currently open start tag
+		void namespace_declaration(std::string_view prefix, std::string_view uri);
+
+		/// attributes can be written only right after start_element/namespace_declaration/attribute
+		void attribute(std::string_view qualified_name, std::string_view value);
+		void attribute(std::string_view qualified_name, xml_string_view value);
+		void attribute(std::string_view namespace_uri, std::string_view qualified_name, std::string_view value);
+		void attribute(std::string_view namespace_uri, std::string_view qualified_name, xml_string_view value);
+
+		void text(std::string_view text);
+		void text(xml_string_view text);
+		void comment(std::string_view text);
+
+		void end_element();
+		/// closes all open elements, writes final new line for pretty print and flushes output
+		void finish();
+
+		/// number of open elements
+		std::size_t depth() const noexcept { return m_elements.size(); }
+		utf8_output & output() const noexcept { return *m_out; }
+
+	public:
+		xml_writer(utf8_output & out, save_option save_option = pretty_print);
+		xml_writer(std::string & str, save_option save_option = pretty_print); // appends
+		xml_writer(std::streambuf & sb, save_option save_option = pretty_print);
+		xml_writer(xercesc::XMLFormatTarget & target, save_option save_option = pretty_print);
+
+		xml_writer(const xml_writer &) = delete;
+		xml_writer & operator =(const xml_writer &) = delete;
+	};
+}
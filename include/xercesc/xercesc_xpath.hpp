@@ -0,0 +1,103 @@
+﻿#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <xercesc/xercesc_utils.hpp>
+
+namespace xercesc_utils
+{
+	/************************************************************************/
+	/*                native xpath subset evaluator                         */
+	/************************************************************************/
+	/// Evaluator for practical xpath subset, implemented directly over DOM without Xerces xpath:
+	///   paths:      relative(a/b), absolute(/a/b), descendant(//a, a//b), self(.)
+	///   node tests: name, prefix:name, *, prefix:*, @name, @*, text()
+	///   predicates: [n], [last()], [last()-n], [@a], [@a='v'], [@a!='v'], [name='v'], [text()='v'],
+	///               several predicates are applied one after another, positions are counted per parent as in xpath.
+	///
+	/// Namespace prefixes are resolved as in find_child: via resolver associated with document or namespaces in scope of context node,
+	/// unprefixed names are in no namespace. Expression is parsed once, prefixes are resolved once per evaluation.
+	/// Results are in document order without duplicates.
+	///
+	///   native_xpath query("items/item[@type='x'][last()]/@id");
+	///   for (auto * attr : query.select(element)) ...
+	class native_xpath
+	{
+	public:
+		enum class axis : unsigned char { child, descendant, self };
+		enum class node_kind : unsigned char { element, attribute, text };
+
+		struct name_test
+		{
+			xml_string prefix;
+			xml_string local_name;  // empty for *
+			bool any_name = false;
+			bool has_prefix = false;
+		};
+
+		struct predicate
+		{
+			enum kind_type : unsigned char
+			{
+				position,           // [n]
+				last,               // [last()], [last()-n], offset in number
+				attribute_exists,   // [@a]
+				attribute_equals,   // [@a='v']
+				attribute_differs,  // [@a!='v']
+				text_equals,        // [text()='v']
+				child_equals,       // [name='v']
+			};
+
+			kind_type kind;
+			std::size_t number = 0;
+			name_test name;
+			xml_string value;
+
+			bool positional() const noexcept { return kind == position or kind == last; }
+		};
+
+		struct step
+		{
+			axis step_axis = axis::child;
+			node_kind kind = node_kind::element;
+			name_test name;
+			std::vector<predicate> predicates;
+			bool positional = false; // has positional predicates
+		};
+
+	private:
+		xml_string m_expression;
+		bool m_absolute = false;
+		std::vector<step> m_steps;
+
+	private:
+		void parse();
+		std::vector<xercesc::DOMNode *> evaluate(xercesc::DOMNode * context, const xercesc::DOMXPathNSResolver * resolver, std::size_t limit) const;
+
+	public:
+		const xml_string & expression() const noexcept { return m_expression; }
+		const std::vector<step> & steps() const noexcept { return m_steps; }
+
+		/// all matched nodes in document order
+		std::vector<xercesc::DOMNode *> select(xercesc::DOMNode * context) const;
+		std::vector<xercesc::DOMNode *> select(xercesc::DOMNode * context, const xercesc::DOMXPathNSResolver * resolver) const;
+
+		/// first matched node in document order or nullptr, stops as soon as it's known
+		xercesc::DOMNode * find(xercesc::DOMNode * context) const;
+		xercesc::DOMNode * find(xercesc::DOMNode * context, const xercesc::DOMXPathNSResolver * resolver) const;
+
+	public:
+		/// throws std::invalid_argument if expression is not in supported subset
+		explicit native_xpath(xml_string expression);
+		template <class String> explicit native_xpath(const String & expression) : native_xpath(forward_as_xml_string(expression)) {}
+	};
+
+	xercesc::DOMNode * native_find_xpath(xercesc::DOMNode * context, const xml_string & path);
+	xercesc::DOMNode * native_get_xpath(xercesc::DOMNode * context, const xml_string & path);
+	std::vector<xercesc::DOMNode *> native_select_xpath(xercesc::DOMNode * context, const xml_string & path);
+
+	template <class String> inline xercesc::DOMNode * native_find_xpath(xercesc::DOMNode * context, const String & path)                { return native_find_xpath(context, forward_as_xml_string(path)); }
+	template <class String> inline xercesc::DOMNode * native_get_xpath(xercesc::DOMNode * context, const String & path)                 { return native_get_xpath(context, forward_as_xml_string(path)); }
+	template <class String> inline std::vector<xercesc::DOMNode *> native_select_xpath(xercesc::DOMNode * context, const String & path) { return native_select_xpath(context, forward_as_xml_string(path)); }
+}
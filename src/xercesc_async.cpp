@@ -0,0 +1,402 @@
+﻿#include <cassert>
+#include <filesystem>
+#include <xercesc/xercesc_async.hpp>
+
+namespace xercesc_utils
+{
+	/************************************************************************/
+	/*                          executors                                   */
+	/************************************************************************/
+	thread_pool_executor::thread_pool_executor(unsigned nthreads /* = 0 */)
+	{
+		if (nthreads == 0) nthreads = std::max(1u, std::thread::hardware_concurrency());
+
+		m_threads.reserve(nthreads);
+		for (unsigned i = 0; i < nthreads; ++i)
+			m_threads.emplace_back(&thread_pool_executor::thread_proc, this);
+	}
+
+	thread_pool_executor::~thread_pool_executor()
+	{
+		{
+			std::lock_guard lk(m_mutex);
+			m_stopped = true;
+		}
+
+		m_event.notify_all();
+		for (auto & thr : m_threads)
+			thr.join();
+	}
+
+	void thread_pool_executor::submit(task_type task)
+	{
+		{
+			std::lock_guard lk(m_mutex);
+			if (m_stopped) throw std::logic_error("xercesc_utils::thread_pool_executor::submit: pool is stopped");
+			m_tasks.push_back(std::move(task));
+		}
+
+		m_event.notify_one();
+	}
+
+	void thread_pool_executor::thread_proc()
+	{
+		for (;;)
+		{
+			task_type task;
+			{
+				std::unique_lock lk(m_mutex);
+				m_event.wait(lk, [this] { return m_stopped or not m_tasks.empty(); });
+				// complete queued tasks even if stopped
+				if (m_tasks.empty()) return;
+
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+
+			task();
+		}
+	}
+
+	callback_executor::callback_executor(post_function post)
+	    : m_post(std::move(post))
+	{
+		if (not m_post) throw std::invalid_argument("xercesc_utils::callback_executor: post function is empty");
+	}
+
+	async_cancelled::async_cancelled()
+	    : std::runtime_error("xercesc_utils: operation cancelled") {}
+
+	async_overloaded::async_overloaded(const std::string & msg)
+	    : std::runtime_error(msg) {}
+
+	namespace
+	{
+		/************************************************************************/
+		/*                cancellation aware xercesc adapters                   */
+		/************************************************************************/
+		class cancellable_bin_stream : public xercesc::BinInputStream
+		{
+			std::unique_ptr<xercesc::BinInputStream> m_stream;
+			cancellation_token m_token;
+
+		public:
+			XMLFilePos curPos() const override { return m_stream->curPos(); }
+			XMLSize_t readBytes(XMLByte * const toFill, const XMLSize_t maxToRead) override;
+			const XMLCh * getContentType() const override { return m_stream->getContentType(); }
+
+		public:
+			cancellable_bin_stream(std::unique_ptr<xercesc::BinInputStream> stream, cancellation_token token)
+			    : m_stream(std::move(stream)), m_token(std::move(token)) {}
+		};
+
+		XMLSize_t cancellable_bin_stream::readBytes(XMLByte * toFill, XMLSize_t maxToRead)
+		{
+			// parser reads input by blocks, checking here interrupts parsing of big documents
+			m_token.throw_if_cancelled();
+			return m_stream->readBytes(toFill, maxToRead);
+		}
+
+		class cancellable_input_source : public xercesc::InputSource
+		{
+			const xercesc::InputSource * m_source;
+			cancellation_token m_token;
+
+		public:
+			xercesc::BinInputStream * makeStream() const override;
+
+		public:
+			cancellable_input_source(const xercesc::InputSource & source, cancellation_token token)
+			    : m_source(&source), m_token(std::move(token)) { setSystemId(source.getSystemId()); }
+		};
+
+		xercesc::BinInputStream * cancellable_input_source::makeStream() const
+		{
+			std::unique_ptr<xercesc::BinInputStream> stream(m_source->makeStream());
+			if (not stream) return nullptr;
+
+			return new cancellable_bin_stream(std::move(stream), m_token);
+		}
+
+		class cancellable_target : public xercesc::XMLFormatTarget
+		{
+			xercesc::XMLFormatTarget * m_target;
+			cancellation_token m_token;
+
+		public:
+			void writeChars(const XMLByte * const toWrite, const XMLSize_t count, xercesc::XMLFormatter * const formatter) override;
+			void flush() override { m_target->flush(); }
+
+		public:
+			cancellable_target(xercesc::XMLFormatTarget & target, cancellation_token token)
+			    : m_target(&target), m_token(std::move(token)) {}
+		};
+
+		void cancellable_target::writeChars(const XMLByte * toWrite, const XMLSize_t count, xercesc::XMLFormatter * formatter)
+		{
+			m_token.throw_if_cancelled();
+			m_target->writeChars(toWrite, count, formatter);
+		}
+
+		template <class Type>
+		auto make_promise_handler(std::shared_ptr<std::promise<Type>> promise)
+		{
+			return [promise = std::move(promise)](std::exception_ptr ex, Type result)
+			{
+				if (ex) promise->set_exception(std::move(ex));
+				else    promise->set_value(std::move(result));
+			};
+		}
+	} // 'anonymous' namespace
+
+	/************************************************************************/
+	/*                      async_xml_processor                             */
+	/************************************************************************/
+	async_xml_processor::async_xml_processor(executor & executor, async_limits limits /* = {} */)
+	    : m_executor(&executor), m_limits(limits) {}
+
+	std::size_t async_xml_processor::inflight_bytes() const
+	{
+		std::lock_guard lk(m_mutex);
+		return m_inflight_bytes;
+	}
+
+	std::size_t async_xml_processor::inflight_tasks() const
+	{
+		std::lock_guard lk(m_mutex);
+		return m_inflight_tasks;
+	}
+
+	bool async_xml_processor::try_admit(std::size_t bytes, std::unique_lock<std::mutex> & lk)
+	{
+		assert(lk.owns_lock());
+		if (m_inflight_tasks == 0) return true;
+
+		if (m_limits.max_inflight_tasks and m_inflight_tasks >= m_limits.max_inflight_tasks)
+			return false;
+
+		if (m_limits.max_inflight_bytes and m_inflight_bytes + bytes > m_limits.max_inflight_bytes)
+			return false;
+
+		return true;
+	}
+
+	void async_xml_processor::admit(std::size_t bytes)
+	{
+		std::unique_lock lk(m_mutex);
+		if (not try_admit(bytes, lk))
+		{
+			if (m_limits.policy == async_limits::reject)
+				throw async_overloaded("xercesc_utils::async_xml_processor: in-flight limit exceeded");
+
+			m_event.wait(lk, [this, bytes, &lk] { return try_admit(bytes, lk); });
+		}
+
+		m_inflight_bytes += bytes;
+		m_inflight_tasks += 1;
+	}
+
+	void async_xml_processor::complete(std::size_t bytes)
+	{
+		{
+			std::lock_guard lk(m_mutex);
+			m_inflight_bytes -= bytes;
+			m_inflight_tasks -= 1;
+		}
+
+		m_event.notify_all();
+	}
+
+	void async_xml_processor::submit(std::size_t bytes, std::function<std::function<void()>()> task, std::function<void(std::exception_ptr)> fail)
+	{
+		try
+		{
+			admit(bytes);
+		}
+		catch (async_overloaded &)
+		{
+			return fail(std::current_exception());
+		}
+
+		auto wrapped = [this, bytes, task = std::move(task), fail]
+		{
+			// task does the work and returns closure delivering result to the handler.
+			// In-flight counters are released before delivery, so handler can submit next operation right away
+			std::function<void()> deliver;
+			try { deliver = task(); }
+			catch (...) { deliver = [fail, ex = std::current_exception()] { fail(ex); }; }
+
+			complete(bytes);
+
+			// handlers should not throw, there is no one to report to
+			try { deliver(); }
+			catch (...) {}
+		};
+
+		try
+		{
+			m_executor->submit(std::move(wrapped));
+		}
+		catch (...)
+		{
+			complete(bytes);
+			throw;
+		}
+	}
+
+	void async_xml_processor::load(std::string data, load_handler handler, cancellation_token token /* = {} */)
+	{
+		if (not handler) throw std::invalid_argument("xercesc_utils::async_xml_processor::load: handler is empty");
+
+		auto size = data.size();
+		auto fail = [handler](std::exception_ptr ex) { handler(std::move(ex), nullptr); };
+		auto task = [handler, data = std::move(data), token = std::move(token)]() -> std::function<void()>
+		{
+			try
+			{
+				token.throw_if_cancelled();
+				xercesc::MemBufInputSource input(reinterpret_cast<const XMLByte *>(data.data()), data.size(), "input buffer");
+				input.setCopyBufToStream(false);
+
+				auto doc = xercesc_utils::load(cancellable_input_source(input, token));
+				return [handler, doc = std::move(doc)] { handler(nullptr, doc); };
+			}
+			catch (...)
+			{
+				return [handler, ex = std::current_exception()] { handler(ex, nullptr); };
+			}
+		};
+
+		return submit(size, std::move(task), std::move(fail));
+	}
+
+	void async_xml_processor::load_from_file(std::string file, load_handler handler, cancellation_token token /* = {} */)
+	{
+		if (not handler) throw std::invalid_argument("xercesc_utils::async_xml_processor::load_from_file: handler is empty");
+
+		std::error_code ec;
+		auto size = std::filesystem::file_size(file, ec);
+		if (ec) size = 0; // let parser report the error
+
+		auto fail = [handler](std::exception_ptr ex) { handler(std::move(ex), nullptr); };
+		auto task = [handler, file = std::move(file), token = std::move(token)]() -> std::function<void()>
+		{
+			try
+			{
+				token.throw_if_cancelled();
+				auto xfile = to_xmlch(file);
+				std::unique_ptr<xercesc::LocalFileInputSource> input;
+				try
+				{
+					input = std::make_unique<xercesc::LocalFileInputSource>(xfile.c_str());
+				}
+				catch (xercesc::XMLException & ex)
+				{
+					std::throw_with_nested(std::runtime_error(error_report(ex)));
+				}
+
+				auto doc = xercesc_utils::load(cancellable_input_source(*input, token));
+				return [handler, doc = std::move(doc)] { handler(nullptr, doc); };
+			}
+			catch (...)
+			{
+				return [handler, ex = std::current_exception()] { handler(ex, nullptr); };
+			}
+		};
+
+		return submit(static_cast<std::size_t>(size), std::move(task), std::move(fail));
+	}
+
+	void async_xml_processor::save(document_ptr doc, save_handler handler, save_option save_option /* = pretty_print */, xml_string encoding /* = XERCESC_LIT("utf-8") */, cancellation_token token /* = {} */)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::async_xml_processor::save: document is null");
+		if (not handler) throw std::invalid_argument("xercesc_utils::async_xml_processor::save: handler is empty");
+
+		auto fail = [handler](std::exception_ptr ex) { handler(std::move(ex), std::string()); };
+		auto task = [handler, doc = std::move(doc), save_option, encoding = std::move(encoding), token = std::move(token)]() -> std::function<void()>
+		{
+			try
+			{
+				token.throw_if_cancelled();
+				std::string result;
+				string_target strTarget(result);
+				cancellable_target target(strTarget, token);
+				xercesc_utils::save(target, doc.get(), save_option, encoding.c_str());
+
+				return [handler, result = std::move(result)]() mutable { handler(nullptr, std::move(result)); };
+			}
+			catch (...)
+			{
+				return [handler, ex = std::current_exception()] { handler(ex, std::string()); };
+			}
+		};
+
+		return submit(0, std::move(task), std::move(fail));
+	}
+
+	void async_xml_processor::save_to_file(document_ptr doc, std::string file, write_handler handler, save_option save_option /* = pretty_print */, xml_string encoding /* = XERCESC_LIT("utf-8") */, cancellation_token token /* = {} */)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::async_xml_processor::save_to_file: document is null");
+		if (not handler) throw std::invalid_argument("xercesc_utils::async_xml_processor::save_to_file: handler is empty");
+
+		auto task = [handler, doc = std::move(doc), file = std::move(file), save_option, encoding = std::move(encoding), token = std::move(token)]() -> std::function<void()>
+		{
+			try
+			{
+				token.throw_if_cancelled();
+				file_target fileTarget(file);
+				cancellable_target target(fileTarget, token);
+				xercesc_utils::save(target, doc.get(), save_option, encoding.c_str());
+				fileTarget.commit();
+				return [handler] { handler(nullptr); };
+			}
+			catch (...)
+			{
+				return [handler, ex = std::current_exception()] { handler(ex); };
+			}
+		};
+
+		return submit(0, std::move(task), handler);
+	}
+
+	auto async_xml_processor::load(std::string data, cancellation_token token /* = {} */) -> std::future<document_ptr>
+	{
+		auto promise = std::make_shared<std::promise<document_ptr>>();
+		auto future = promise->get_future();
+		load(std::move(data), make_promise_handler(std::move(promise)), std::move(token));
+
+		return future;
+	}
+
+	auto async_xml_processor::load_from_file(std::string file, cancellation_token token /* = {} */) -> std::future<document_ptr>
+	{
+		auto promise = std::make_shared<std::promise<document_ptr>>();
+		auto future = promise->get_future();
+		load_from_file(std::move(file), make_promise_handler(std::move(promise)), std::move(token));
+
+		return future;
+	}
+
+	auto async_xml_processor::save(document_ptr doc, save_option save_option /* = pretty_print */, xml_string encoding /* = XERCESC_LIT("utf-8") */, cancellation_token token /* = {} */) -> std::future<std::string>
+	{
+		auto promise = std::make_shared<std::promise<std::string>>();
+		auto future = promise->get_future();
+		save(std::move(doc), make_promise_handler(std::move(promise)), save_option, std::move(encoding), std::move(token));
+
+		return future;
+	}
+
+	auto async_xml_processor::save_to_file(document_ptr doc, std::string file, save_option save_option /* = pretty_print */, xml_string encoding /* = XERCESC_LIT("utf-8") */, cancellation_token token /* = {} */) -> std::future<void>
+	{
+		auto promise = std::make_shared<std::promise<void>>();
+		auto future = promise->get_future();
+		auto handler = [promise](std::exception_ptr ex)
+		{
+			if (ex) promise->set_exception(std::move(ex));
+			else    promise->set_value();
+		};
+
+		save_to_file(std::move(doc), std::move(file), std::move(handler), save_option, std::move(encoding), std::move(token));
+		return future;
+	}
+}
@@ -0,0 +1,440 @@
+﻿#include <cstdint>
+#include <xercesc/xercesc_binary.hpp>
+#include <boost/predef.h>
+
+#if BOOST_HW_SIMD_X86 >= BOOST_HW_SIMD_X86_SSE2_VERSION
+#include <emmintrin.h>
+#define XERCESC_UTILS_SSE2
+#endif
+
+namespace xercesc_utils
+{
+	namespace
+	{
+		// decoded bytes are collected into stack block, then written into sink
+		constexpr std::size_t block_size = 12 * 1024;
+
+		inline bool is_space(XMLCh ch)
+		{
+			return ch == ' ' or ch == '\t' or ch == '\r' or ch == '\n';
+		}
+
+		class binary_output
+		{
+			unsigned char m_block[block_size];
+			std::size_t m_size = 0;
+			std::vector<unsigned char> * m_data = nullptr;
+			std::streambuf * m_sb = nullptr;
+
+		public:
+			/// pointer to at least count free bytes, count <= block_size
+			unsigned char * reserve(std::size_t count)
+			{
+				if (block_size - m_size < count) flush();
+				return m_block + m_size;
+			}
+
+			void commit(std::size_t count) noexcept { m_size += count; }
+			void put(unsigned char byte) { *reserve(1) = byte; ++m_size; }
+
+			void flush()
+			{
+				if (m_data)
+					m_data->insert(m_data->end(), m_block, m_block + m_size);
+				else
+				{
+					auto written = m_sb->sputn(reinterpret_cast<const char *>(m_block), m_size);
+					if (static_cast<std::size_t>(written) < m_size)
+						throw std::runtime_error("xercesc_utils::get_text_binary: failed to write to std::streambuf");
+				}
+
+				m_size = 0;
+			}
+
+		public:
+			explicit binary_output(std::vector<unsigned char> & data) : m_data(&data) {}
+			explicit binary_output(std::streambuf & sb) : m_sb(&sb) {}
+		};
+
+		inline int base64_value(XMLCh ch)
+		{
+			if (ch >= 'A' and ch <= 'Z') return ch - 'A';
+			if (ch >= 'a' and ch <= 'z') return ch - 'a' + 26;
+			if (ch >= '0' and ch <= '9') return ch - '0' + 52;
+			if (ch == '+') return 62;
+			if (ch == '/') return 63;
+			return -1;
+		}
+
+		inline int hex_value(XMLCh ch)
+		{
+			if (ch >= '0' and ch <= '9') return ch - '0';
+			if (ch >= 'A' and ch <= 'F') return ch - 'A' + 10;
+			if (ch >= 'a' and ch <= 'f') return ch - 'a' + 10;
+			return -1;
+		}
+
+		[[noreturn]] void throw_invalid(const char * encoding)
+		{
+			throw std::runtime_error(std::string("xercesc_utils::get_text_binary: invalid ") + encoding + " text");
+		}
+
+	#ifdef XERCESC_UTILS_SSE2
+		/// packs 16 utf-16 units into bytes, units above 0xFF become 0x00 or 0xFF, which are never valid
+		inline __m128i load_chars(const XMLCh * first)
+		{
+			__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+			__m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + 8));
+			return _mm_packus_epi16(lo, hi);
+		}
+
+		/// mask of bytes in [first, last], bytes above 0x7F are negative and never match
+		inline __m128i in_range(__m128i chars, char first, char last)
+		{
+			return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(first - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8(last + 1)));
+		}
+	#endif
+
+		class base64_decoder
+		{
+			binary_output * m_out;
+			std::uint32_t m_bits = 0;
+			unsigned m_count = 0;    // sextets in m_bits
+			unsigned m_padding = 0;  // '=' seen
+			bool m_ended = false;    // padding is complete, only whitespace may follow
+
+		private:
+			void write_partial()
+			{
+				// 2 sextets - 1 byte, 3 sextets - 2 bytes
+				if (m_count == 2) m_out->put(static_cast<unsigned char>(m_bits >> 4));
+				else
+				{
+					m_out->put(static_cast<unsigned char>(m_bits >> 10));
+					m_out->put(static_cast<unsigned char>(m_bits >> 2));
+				}
+
+				m_bits = 0;
+				m_count = 0;
+			}
+
+			/// decodes blocks of 16 chars without whitespace and padding, returns pointer past decoded blocks
+			const XMLCh * decode_blocks(const XMLCh * first, const XMLCh * last)
+			{
+			#ifdef XERCESC_UTILS_SSE2
+				while (last - first >= 16)
+				{
+					__m128i chars = load_chars(first);
+					__m128i upper = in_range(chars, 'A', 'Z');
+					__m128i lower = in_range(chars, 'a', 'z');
+					__m128i digit = in_range(chars, '0', '9');
+					__m128i plus  = _mm_cmpeq_epi8(chars, _mm_set1_epi8('+'));
+					__m128i slash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'));
+
+					__m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(_mm_or_si128(digit, plus), slash));
+					if (_mm_movemask_epi8(valid) != 0xFFFF) break;
+
+					__m128i offset = _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')), _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+					offset = _mm_or_si128(offset, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+					offset = _mm_or_si128(offset, _mm_and_si128(plus, _mm_set1_epi8(62 - '+')));
+					offset = _mm_or_si128(offset, _mm_and_si128(slash, _mm_set1_epi8(63 - '/')));
+					__m128i values = _mm_add_epi8(chars, offset);
+
+					// merge sextets: pairs into 12 bits per 16-bit lane, then into 24 bits per 32-bit lane
+					__m128i pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0x00FF)), 6), _mm_srli_epi16(values, 8));
+					__m128i quads = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(pairs, _mm_set1_epi32(0xFFFF)), 12), _mm_srli_epi32(pairs, 16));
+
+					alignas(16) std::uint32_t groups[4];
+					_mm_store_si128(reinterpret_cast<__m128i *>(groups), quads);
+
+					auto * out = m_out->reserve(12);
+					for (auto group : groups)
+					{
+						*out++ = static_cast<unsigned char>(group >> 16);
+						*out++ = static_cast<unsigned char>(group >> 8);
+						*out++ = static_cast<unsigned char>(group);
+					}
+
+					m_out->commit(12);
+					first += 16;
+				}
+			#endif
+
+				return first;
+			}
+
+		public:
+			void decode(const XMLCh * first, const XMLCh * last)
+			{
+				while (first != last)
+				{
+					// vector path starts only at group boundary
+					if (m_count == 0 and not m_padding)
+					{
+						first = decode_blocks(first, last);
+						if (first == last) break;
+					}
+
+					XMLCh ch = *first++;
+					if (is_space(ch)) continue;
+					if (m_ended) throw_invalid("base64");
+
+					if (ch == '=')
+					{
+						if (m_count < 2) throw_invalid("base64");
+						if (m_count + ++m_padding == 4)
+						{
+							write_partial();
+							m_ended = true;
+						}
+
+						continue;
+					}
+
+					auto value = base64_value(ch);
+					if (value < 0 or m_padding) throw_invalid("base64");
+
+					m_bits = m_bits << 6 | static_cast<std::uint32_t>(value);
+					if (++m_count == 4)
+					{
+						auto * out = m_out->reserve(3);
+						out[0] = static_cast<unsigned char>(m_bits >> 16);
+						out[1] = static_cast<unsigned char>(m_bits >> 8);
+						out[2] = static_cast<unsigned char>(m_bits);
+						m_out->commit(3);
+
+						m_bits = 0;
+						m_count = 0;
+					}
+				}
+			}
+
+			/// padding is optional, but group can't be cut after single sextet or in the middle of padding
+			void finish()
+			{
+				if (m_padding and not m_ended) throw_invalid("base64");
+				if (m_count == 1) throw_invalid("base64");
+				if (m_count) write_partial();
+			}
+
+		public:
+			explicit base64_decoder(binary_output & out) : m_out(&out) {}
+		};
+
+		class hex_decoder
+		{
+			binary_output * m_out;
+			int m_high = -1; // pending high nibble
+
+		private:
+			/// decodes blocks of 16 hex digits, returns pointer past decoded blocks
+			const XMLCh * decode_blocks(const XMLCh * first, const XMLCh * last)
+			{
+			#ifdef XERCESC_UTILS_SSE2
+				while (last - first >= 16)
+				{
+					__m128i chars = load_chars(first);
+					__m128i digit = in_range(chars, '0', '9');
+					__m128i upper = in_range(chars, 'A', 'F');
+					__m128i lower = in_range(chars, 'a', 'f');
+
+					__m128i valid = _mm_or_si128(_mm_or_si128(digit, upper), lower);
+					if (_mm_movemask_epi8(valid) != 0xFFFF) break;
+
+					__m128i offset = _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(-'0')), _mm_and_si128(upper, _mm_set1_epi8(10 - 'A')));
+					offset = _mm_or_si128(offset, _mm_and_si128(lower, _mm_set1_epi8(10 - 'a')));
+					__m128i values = _mm_add_epi8(chars, offset);
+
+					// first digit of each pair is in low byte of 16-bit lane
+					__m128i bytes = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0x00FF)), 4), _mm_srli_epi16(values, 8));
+					_mm_storel_epi64(reinterpret_cast<__m128i *>(m_out->reserve(8)), _mm_packus_epi16(bytes, bytes));
+
+					m_out->commit(8);
+					first += 16;
+				}
+			#endif
+
+				return first;
+			}
+
+		public:
+			void decode(const XMLCh * first, const XMLCh * last)
+			{
+				while (first != last)
+				{
+					if (m_high < 0)
+					{
+						first = decode_blocks(first, last);
+						if (first == last) break;
+					}
+
+					XMLCh ch = *first++;
+					if (is_space(ch)) continue;
+
+					auto value = hex_value(ch);
+					if (value < 0) throw_invalid("hex");
+
+					if (m_high < 0)
+						m_high = value;
+					else
+					{
+						m_out->put(static_cast<unsigned char>(m_high << 4 | value));
+						m_high = -1;
+					}
+				}
+			}
+
+			void finish()
+			{
+				if (m_high >= 0) throw_invalid("hex");
+			}
+
+		public:
+			explicit hex_decoder(binary_output & out) : m_out(&out) {}
+		};
+
+		/// feeds text and CDATA nodes of element subtree into decoder, in document order
+		template <class Decoder>
+		void decode_text(xercesc::DOMElement * element, Decoder & decoder)
+		{
+			using xercesc::DOMNode;
+
+			auto * node = element->getFirstChild();
+			while (node)
+			{
+				auto type = node->getNodeType();
+				if (type == DOMNode::TEXT_NODE or type == DOMNode::CDATA_SECTION_NODE)
+				{
+					// character data is read in place, without copying
+					auto * text = static_cast<const xercesc::DOMCharacterData *>(node);
+					auto * data = text->getData();
+					decoder.decode(data, data + text->getLength());
+				}
+				else if (type == DOMNode::ELEMENT_NODE and node->getFirstChild())
+				{
+					node = node->getFirstChild();
+					continue;
+				}
+
+				while (node != element and not node->getNextSibling())
+					node = node->getParentNode();
+
+				if (node == element) break;
+				node = node->getNextSibling();
+			}
+
+			decoder.finish();
+		}
+
+		void decode_text(xercesc::DOMElement * element, binary_output & out, binary_encoding encoding)
+		{
+			if (encoding == binary_encoding::hex)
+			{
+				hex_decoder decoder(out);
+				decode_text(element, decoder);
+			}
+			else
+			{
+				base64_decoder decoder(out);
+				decode_text(element, decoder);
+			}
+
+			out.flush();
+		}
+	}
+
+	std::vector<unsigned char> get_text_binary(xercesc::DOMElement * element, binary_encoding encoding /* = binary_encoding::base64 */)
+	{
+		std::vector<unsigned char> data;
+		get_text_binary(element, data, encoding);
+		return data;
+	}
+
+	void get_text_binary(xercesc::DOMElement * element, std::vector<unsigned char> & data, binary_encoding encoding /* = binary_encoding::base64 */)
+	{
+		if (not element) throw std::invalid_argument("xercesc_utils::get_text_binary: element is null");
+
+		binary_output out(data);
+		decode_text(element, out, encoding);
+	}
+
+	void get_text_binary(xercesc::DOMElement * element, std::streambuf & sb, binary_encoding encoding /* = binary_encoding::base64 */)
+	{
+		if (not element) throw std::invalid_argument("xercesc_utils::get_text_binary: element is null");
+
+		binary_output out(sb);
+		decode_text(element, out, encoding);
+	}
+
+	std::vector<unsigned char> get_path_binary(xercesc::DOMDocument * doc, xml_string_view path, binary_encoding encoding /* = binary_encoding::base64 */)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::get_path_binary: document is null");
+		auto * element = find_path(doc, path);
+		if (not element) throw xml_path_exception(path);
+
+		return get_text_binary(element, encoding);
+	}
+
+	std::vector<unsigned char> get_path_binary(xercesc::DOMElement * element, xml_string_view path, binary_encoding encoding /* = binary_encoding::base64 */)
+	{
+		if (not element) throw std::invalid_argument("xercesc_utils::get_path_binary: element is null");
+		element = find_path(element, path);
+		if (not element) throw xml_path_exception(path);
+
+		return get_text_binary(element, encoding);
+	}
+
+	void get_path_binary(xercesc::DOMDocument * doc, xml_string_view path, std::streambuf & sb, binary_encoding encoding /* = binary_encoding::base64 */)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::get_path_binary: document is null");
+		auto * element = find_path(doc, path);
+		if (not element) throw xml_path_exception(path);
+
+		get_text_binary(element, sb, encoding);
+	}
+
+	void get_path_binary(xercesc::DOMElement * element, xml_string_view path, std::streambuf & sb, binary_encoding encoding /* = binary_encoding::base64 */)
+	{
+		if (not element) throw std::invalid_argument("xercesc_utils::get_path_binary: element is null");
+		element = find_path(element, path);
+		if (not element) throw xml_path_exception(path);
+
+		get_text_binary(element, sb, encoding);
+	}
+
+	bool find_path_binary(xercesc::DOMDocument * doc, xml_string_view path, std::vector<unsigned char> & data, binary_encoding encoding /* = binary_encoding::base64 */)
+	{
+		auto * element = find_path(doc, path);
+		if (not element) return false;
+
+		get_text_binary(element, data, encoding);
+		return true;
+	}
+
+	bool find_path_binary(xercesc::DOMElement * element, xml_string_view path, std::vector<unsigned char> & data, binary_encoding encoding /* = binary_encoding::base64 */)
+	{
+		element = find_path(element, path);
+		if (not element) return false;
+
+		get_text_binary(element, data, encoding);
+		return true;
+	}
+
+	bool find_path_binary(xercesc::DOMDocument * doc, xml_string_view path, std::streambuf & sb, binary_encoding encoding /* = binary_encoding::base64 */)
+	{
+		auto * element = find_path(doc, path);
+		if (not element) return false;
+
+		get_text_binary(element, sb, encoding);
+		return true;
+	}
+
+	bool find_path_binary(xercesc::DOMElement * element, xml_string_view path, std::streambuf & sb, binary_encoding encoding /* = binary_encoding::base64 */)
+	{
+		element = find_path(element, path);
+		if (not element) return false;
+
+		get_text_binary(element, sb, encoding);
+		return true;
+	}
+}
@@ -0,0 +1,229 @@
+﻿#include <algorithm>
+#include <xercesc/xercesc_binding.hpp>
+
+namespace xercesc_utils::detail
+{
+	namespace
+	{
+		const XMLCh path_separator = '/';
+		const XMLCh attribute_mark = '@';
+
+		inline xml_string_view forward_view(const XMLCh * str) noexcept
+		{
+			return str ? xml_string_view(str) : xml_string_view();
+		}
+
+		/// splits path into segments skipping consecutive separators, as path helpers do
+		void split_path(xml_string_view path, std::vector<xml_string_view> & segments)
+		{
+			segments.clear();
+
+			std::size_t pos = 0;
+			while (pos < path.size() and path[pos] == path_separator) ++pos;
+			while (pos < path.size())
+			{
+				auto next = std::min(path.find(path_separator, pos), path.size());
+				segments.push_back(path.substr(pos, next - pos));
+
+				pos = next;
+				while (pos < path.size() and path[pos] == path_separator) ++pos;
+			}
+		}
+	}
+
+	compiled_binding::compiled_binding(const xml_field * fields, std::size_t count)
+	    : m_fields(fields), m_field_count(count), m_nodes(1)
+	{
+		std::vector<xml_string_view> segments;
+		for (std::size_t index = 0; index < count; ++index)
+		{
+			auto path = to_xmlch(fields[index].path);
+			split_path(path, segments);
+
+			xml_string_view attribute;
+			if (not segments.empty() and segments.back().front() == attribute_mark)
+			{
+				attribute = segments.back().substr(1);
+				segments.pop_back();
+
+				if (attribute.empty())
+					throw std::invalid_argument("xercesc_utils::xml_binding: empty attribute name in path " + std::string(fields[index].path));
+			}
+
+			std::size_t current = 0;
+			for (auto segment : segments)
+			{
+				if (segment.front() == attribute_mark)
+					throw std::invalid_argument("xercesc_utils::xml_binding: attribute is not the last segment of path " + std::string(fields[index].path));
+
+				xml_string_view prefix, local_name = segment;
+				auto pos = segment.find(XERCESC_LIT(':'));
+				if (pos != segment.npos)
+				{
+					prefix = segment.substr(0, pos);
+					local_name = segment.substr(pos + 1);
+				}
+
+				auto & children = m_nodes[current].children;
+				auto it = std::find_if(children.begin(), children.end(), [this, prefix, local_name](std::size_t child)
+				{
+					return m_nodes[child].prefix == prefix and m_nodes[child].local_name == local_name;
+				});
+
+				if (it != children.end())
+				{
+					current = *it;
+					continue;
+				}
+
+				auto child = m_nodes.size();
+				m_nodes[current].children.push_back(child);
+				m_nodes.push_back(node {xml_string(prefix), xml_string(local_name), {}, {}, {}});
+				current = child;
+			}
+
+			if (attribute.empty())
+				m_nodes[current].text_fields.push_back(index);
+			else
+				m_nodes[current].attribute_fields.emplace_back(xml_string(attribute), index);
+		}
+	}
+
+	void compiled_binding::load(xercesc::DOMElement * element, void * object) const
+	{
+		// prefixes are resolved once, against bound element
+		std::vector<xml_string> namespaces(m_nodes.size());
+		auto * resolver = get_associated_resolver(element->getOwnerDocument());
+
+		for (std::size_t index = 1; index < m_nodes.size(); ++index)
+		{
+			auto & prefix = m_nodes[index].prefix;
+			if (prefix.empty()) continue;
+
+			auto * uri = resolver ? resolver->lookupNamespaceURI(prefix.c_str()) : lookup_namespace_uri(element, prefix.c_str());
+			if (not uri) throw xml_namespace_exception("xml namespace not found, prefix = " + to_utf8(prefix));
+			namespaces[index] = uri;
+		}
+
+		std::vector<char> loaded(m_field_count);
+		load(0, element, object, namespaces, loaded);
+
+		for (std::size_t index = 0; index < m_field_count; ++index)
+		{
+			if (loaded[index]) continue;
+
+			auto & field = m_fields[index];
+			if (not field.optional) throw xml_path_exception(std::string(field.path));
+			field.load(object, nullptr);
+		}
+	}
+
+	void compiled_binding::load(std::size_t index, xercesc::DOMElement * element, void * object,
+	                            const std::vector<xml_string> & namespaces, std::vector<char> & loaded) const
+	{
+		auto & current = m_nodes[index];
+		auto assign = [this, object, &loaded](std::size_t field_index, const std::string & text)
+		{
+			auto & field = m_fields[field_index];
+			try
+			{
+				field.load(object, &text);
+			}
+			catch (std::exception &)
+			{
+				std::throw_with_nested(std::runtime_error("xercesc_utils::load_struct: invalid value at path " + std::string(field.path)));
+			}
+
+			loaded[field_index] = 1;
+		};
+
+		if (not current.text_fields.empty())
+		{
+			auto text = get_text_content(element);
+			for (auto field_index : current.text_fields)
+				assign(field_index, text);
+		}
+
+		for (auto & [name, field_index] : current.attribute_fields)
+		{
+			auto * attr = find_attribute_node(element, name);
+			if (attr) assign(field_index, to_utf8(attr->getValue()));
+		}
+
+		if (current.children.empty()) return;
+
+		// single pass over child elements, first matching element of each trie child is taken.
+		// Trie children are keyed by names as written, aliases of one namespace(p:x, q:x) are different children
+		// matching the same element, so element is given to every child it matches
+		std::size_t pending = current.children.size();
+		std::vector<char> matched(pending);
+
+		for (auto * child = element->getFirstElementChild(); child and pending; child = child->getNextElementSibling())
+		{
+			auto * local_name = child->getLocalName();
+			if (not local_name) local_name = child->getNodeName();
+
+			auto child_ns = forward_view(child->getNamespaceURI());
+			auto child_name = forward_view(local_name);
+
+			for (std::size_t i = 0; i < current.children.size(); ++i)
+			{
+				auto child_index = current.children[i];
+				if (matched[i] or m_nodes[child_index].local_name != child_name or namespaces[child_index] != child_ns)
+					continue;
+
+				matched[i] = 1;
+				--pending;
+				load(child_index, child, object, namespaces, loaded);
+			}
+		}
+	}
+
+	void compiled_binding::save(xercesc::DOMElement * element, const void * object) const
+	{
+		std::vector<std::string> values(m_field_count);
+		std::vector<char> has_values(m_field_count);
+		for (std::size_t index = 0; index < m_field_count; ++index)
+			has_values[index] = m_fields[index].save(object, values[index]);
+
+		// elements are created only for subtrees with values, children always follow their parent
+		std::vector<char> has_nodes(m_nodes.size());
+		for (auto index = m_nodes.size(); index--;)
+		{
+			auto & current = m_nodes[index];
+			auto & has = has_nodes[index];
+
+			for (auto field_index : current.text_fields) has = has or has_values[field_index];
+			for (auto & attribute : current.attribute_fields) has = has or has_values[attribute.second];
+			for (auto child_index : current.children) has = has or has_nodes[child_index];
+		}
+
+		save(0, element, values, has_values, has_nodes);
+	}
+
+	void compiled_binding::save(std::size_t index, xercesc::DOMElement * element, const std::vector<std::string> & values,
+	                            const std::vector<char> & has_values, const std::vector<char> & has_nodes) const
+	{
+		auto & current = m_nodes[index];
+
+		// text first: setting it releases child elements
+		for (auto field_index : current.text_fields)
+			if (has_values[field_index]) set_text_content(element, values[field_index]);
+
+		for (auto & [name, field_index] : current.attribute_fields)
+			if (has_values[field_index]) set_attribute_text(element, name, values[field_index]);
+
+		for (auto child_index : current.children)
+		{
+			if (not has_nodes[child_index]) continue;
+
+			auto & child = m_nodes[child_index];
+			xml_string name;
+			name.reserve(child.prefix.size() + 1 + child.local_name.size());
+			if (not child.prefix.empty()) name.append(child.prefix).push_back(':');
+			name.append(child.local_name);
+
+			save(child_index, acquire_path(element, std::move(name)), values, has_values, has_nodes);
+		}
+	}
+}
@@ -0,0 +1,323 @@
+﻿#include <algorithm>
+#include <xercesc/xercesc_builder.hpp>
+
+namespace xercesc_utils
+{
+	namespace
+	{
+		const XMLCh path_separator = '/';
+
+		inline xml_string_view forward_view(const XMLCh * str) noexcept
+		{
+			return str ? xml_string_view(str) : xml_string_view();
+		}
+
+		/// splits path into segments skipping consecutive separators, as path helpers do
+		void split_path(xml_string_view path, std::vector<xml_string_view> & segments)
+		{
+			segments.clear();
+
+			std::size_t pos = 0;
+			while (pos < path.size() and path[pos] == path_separator) ++pos;
+			while (pos < path.size())
+			{
+				auto next = std::min(path.find(path_separator, pos), path.size());
+				segments.push_back(path.substr(pos, next - pos));
+
+				pos = next;
+				while (pos < path.size() and path[pos] == path_separator) ++pos;
+			}
+		}
+
+		bool is_namespace_declaration(xml_string_view name) noexcept
+		{
+			const xml_string_view xmlns = XERCESC_LIT("xmlns");
+			return name.substr(0, xmlns.size()) == xmlns and (name.size() == xmlns.size() or name[xmlns.size()] == ':');
+		}
+	}
+
+	document_builder::document_builder(xercesc::DOMDocument * doc)
+	    : m_doc(doc)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::document_builder: document is null");
+	}
+
+	document_builder::document_builder(xercesc::DOMElement * element)
+	    : m_current(element)
+	{
+		if (not element) throw std::invalid_argument("xercesc_utils::document_builder: element is null");
+		m_doc = element->getOwnerDocument();
+	}
+
+	void document_builder::reset() noexcept
+	{
+		m_elements.clear();
+		m_decisions.clear();
+	}
+
+	auto document_builder::state(xercesc::DOMElement * element) -> element_state &
+	{
+		auto it = m_elements.find(element);
+		if (it != m_elements.end()) return it->second;
+
+		// element not created by builder: own namespace scope, children are searched in document
+		return m_elements.emplace(element, element_state {element, false, {}}).first->second;
+	}
+
+	auto document_builder::decide(xercesc::DOMElement * parent, element_state & parent_state, xml_string_view name) -> name_decision &
+	{
+		auto & decisions = m_decisions[parent_state.scope];
+		m_key.assign(name);
+
+		auto it = decisions.find(m_key);
+		if (it != decisions.end()) return it->second;
+
+		// first occurrence in this scope: prefix is resolved as in acquire_path
+		name_decision decision;
+		auto local_name = name;
+		auto pos = name.find(XERCESC_LIT(':'));
+		if (pos != name.npos)
+		{
+			xml_string prefix(name.substr(0, pos));
+			auto * resolver = get_associated_resolver(m_doc);
+			auto * uri = resolver ? resolver->lookupNamespaceURI(prefix.c_str()) : lookup_namespace_uri(parent, prefix.c_str());
+			if (not uri) throw xml_namespace_exception("xml namespace not found, prefix = " + to_utf8(prefix));
+
+			decision.namespace_uri = uri;
+			local_name.remove_prefix(pos + 1);
+		}
+
+		decision.child_key.reserve(decision.namespace_uri.size() + 1 + local_name.size());
+		decision.child_key.append(decision.namespace_uri).append(1, XMLCh(0)).append(local_name);
+		return decisions.emplace(m_key, std::move(decision)).first->second;
+	}
+
+	xercesc::DOMElement * document_builder::create(xercesc::DOMElement * parent, element_state & parent_state, name_decision & decision, xml_string_view name)
+	{
+		xercesc::DOMElement * element;
+		if (not decision.qualified_name.empty())
+		{
+			try
+			{
+				auto * namespace_uri = decision.namespace_uri.empty() ? nullptr : decision.namespace_uri.c_str();
+				element = m_doc->createElementNS(namespace_uri, decision.qualified_name.c_str());
+			}
+			catch (xercesc::DOMException & ex)
+			{
+				std::throw_with_nested(std::runtime_error(xercesc_utils::to_utf8(ex.getMessage())));
+			}
+		}
+		else
+		{
+			// first element of this name in this scope: created as in acquire_path
+			element = create_element_ns(parent, decision.namespace_uri, xml_string(name));
+
+			// element with prefix not bound in parent scope to its namespace introduces new binding for its descendants
+			auto * bound_uri = lookup_namespace_uri(parent, element->getPrefix());
+			decision.new_scope = forward_view(bound_uri) != xml_string_view(decision.namespace_uri);
+			decision.qualified_name = element->getNodeName();
+		}
+
+		try
+		{
+			parent->appendChild(element);
+		}
+		catch (xercesc::DOMException & ex)
+		{
+			std::throw_with_nested(std::runtime_error(xercesc_utils::to_utf8(ex.getMessage())));
+		}
+
+		m_elements.emplace(element, element_state {decision.new_scope ? element : parent_state.scope, true, {}});
+		return element;
+	}
+
+	xercesc::DOMElement * document_builder::child(xercesc::DOMElement * parent, xml_string_view name)
+	{
+		auto & parent_state = state(parent);
+		auto & decision = decide(parent, parent_state, name);
+
+		auto it = parent_state.children.find(decision.child_key);
+		if (it != parent_state.children.end()) return it->second;
+
+		// children of created elements are all known
+		auto * element = parent_state.created ? nullptr : find_child(parent, name);
+		if (not element) element = create(parent, parent_state, decision, name);
+
+		parent_state.children.emplace(decision.child_key, element);
+		return element;
+	}
+
+	xercesc::DOMElement * document_builder::walk(xercesc::DOMElement * element, xml_string_view path)
+	{
+		if (not path.empty() and path.front() == path_separator) element = nullptr;
+
+		std::vector<xml_string_view> segments;
+		split_path(path, segments);
+
+		for (auto segment : segments)
+			element = element ? child(element, segment) : acquire_path(m_doc, xml_string(segment));
+
+		return element;
+	}
+
+	document_builder & document_builder::acquire(xml_string_view path)
+	{
+		m_current = walk(m_current, path);
+		return *this;
+	}
+
+	document_builder & document_builder::append(xml_string_view name)
+	{
+		if (not m_current) throw std::runtime_error("xercesc_utils::document_builder::append: cursor is at document level");
+		if (name.empty() or name.find(path_separator) != name.npos)
+			throw std::invalid_argument("xercesc_utils::document_builder::append: name is not a single path segment");
+
+		auto & parent_state = state(m_current);
+		auto & decision = decide(m_current, parent_state, name);
+		auto * element = create(m_current, parent_state, decision, name);
+		// for created parent it can be the first child with such name, otherwise find_child decides
+		if (parent_state.created) parent_state.children.emplace(decision.child_key, element);
+
+		m_current = element;
+		return *this;
+	}
+
+	document_builder & document_builder::up(std::size_t levels /* = 1 */)
+	{
+		for (; levels; --levels)
+		{
+			if (not m_current) throw std::runtime_error("xercesc_utils::document_builder::up: cursor is at document level");
+
+			auto * parent = m_current->getParentNode();
+			m_current = parent and parent->getNodeType() == xercesc::DOMNode::ELEMENT_NODE
+			          ? static_cast<xercesc::DOMElement *>(parent) : nullptr;
+		}
+
+		return *this;
+	}
+
+	document_builder & document_builder::move_to(xercesc::DOMElement * element)
+	{
+		if (not element) throw std::invalid_argument("xercesc_utils::document_builder::move_to: element is null");
+		if (element->getOwnerDocument() != m_doc)
+			throw std::invalid_argument("xercesc_utils::document_builder::move_to: element belongs to another document");
+
+		m_current = element;
+		return *this;
+	}
+
+	document_builder & document_builder::set_text(std::string_view value)
+	{
+		if (not m_current) throw std::runtime_error("xercesc_utils::document_builder::set_text: cursor is at document level");
+
+		// remembered descendants are released together with child elements
+		bool had_elements = m_current->getFirstElementChild();
+		set_text_content(m_current, value);
+		if (had_elements) reset();
+
+		return *this;
+	}
+
+	document_builder & document_builder::set_text(xml_string_view path, std::string_view value)
+	{
+		auto * element = walk(m_current, path);
+		if (not element) throw std::runtime_error("xercesc_utils::document_builder::set_text: cursor is at document level");
+
+		bool had_elements = element->getFirstElementChild();
+		set_text_content(element, value);
+		if (had_elements) reset();
+
+		return *this;
+	}
+
+	document_builder & document_builder::set_attribute(xml_string_view name, std::string_view value)
+	{
+		if (not m_current) throw std::runtime_error("xercesc_utils::document_builder::set_attribute: cursor is at document level");
+
+		set_attribute_text(m_current, xml_string(name), value);
+		// namespace decisions depend on declarations in scope
+		if (is_namespace_declaration(name)) reset();
+
+		return *this;
+	}
+
+	template <class Iterator>
+	void document_builder::apply_sorted(Iterator first, Iterator last)
+	{
+		// elements of previous path, common leading segments are reused
+		std::vector<std::pair<xml_string_view, xercesc::DOMElement *>> stack;
+		std::vector<xml_string_view> segments;
+		bool stack_absolute = false;
+
+		for (; first != last; ++first)
+		{
+			xml_string_view path = first->first;
+			std::string_view value = first->second;
+
+			bool absolute = not path.empty() and path.front() == path_separator;
+			if (absolute != stack_absolute) stack.clear();
+			stack_absolute = absolute;
+
+			split_path(path, segments);
+
+			std::size_t common = 0;
+			while (common < stack.size() and common < segments.size() and stack[common].first == segments[common])
+				++common;
+
+			stack.resize(common);
+			auto * element = common ? stack.back().second : absolute ? nullptr : m_current;
+
+			for (auto i = common; i < segments.size(); ++i)
+			{
+				element = element ? child(element, segments[i]) : acquire_path(m_doc, xml_string(segments[i]));
+				stack.emplace_back(segments[i], element);
+			}
+
+			if (not element) throw std::runtime_error("xercesc_utils::document_builder::apply: cursor is at document level");
+
+			bool had_elements = element->getFirstElementChild();
+			set_text_content(element, value);
+			if (had_elements)
+			{
+				reset();
+				stack.resize(segments.size());
+			}
+		}
+	}
+
+	document_builder & document_builder::apply(const std::map<xml_string, std::string> & values)
+	{
+		apply_sorted(values.begin(), values.end());
+		return *this;
+	}
+
+	document_builder & document_builder::apply(const std::map<std::string, std::string> & values)
+	{
+		std::vector<std::pair<xml_string, std::string_view>> converted;
+		converted.reserve(values.size());
+		for (auto & item : values)
+			converted.emplace_back(to_xmlch(item.first), item.second);
+
+		apply_sorted(converted.begin(), converted.end());
+		return *this;
+	}
+
+	document_builder & document_builder::apply(std::vector<std::pair<xml_string, std::string>> values)
+	{
+		std::stable_sort(values.begin(), values.end(), [](auto & op1, auto & op2) { return op1.first < op2.first; });
+		apply_sorted(values.begin(), values.end());
+		return *this;
+	}
+
+	document_builder & document_builder::apply(std::initializer_list<std::pair<std::string_view, std::string_view>> values)
+	{
+		std::vector<std::pair<xml_string, std::string_view>> converted;
+		converted.reserve(values.size());
+		for (auto & item : values)
+			converted.emplace_back(to_xmlch(item.first), item.second);
+
+		std::stable_sort(converted.begin(), converted.end(), [](auto & op1, auto & op2) { return op1.first < op2.first; });
+		apply_sorted(converted.begin(), converted.end());
+		return *this;
+	}
+}
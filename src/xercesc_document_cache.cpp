@@ -0,0 +1,263 @@
+﻿#include <cerrno>
+#include <system_error>
+#include <vector>
+#include <xercesc/xercesc_document_cache.hpp>
+#include <boost/predef.h>
+
+#if BOOST_OS_WINDOWS
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+namespace xercesc_utils
+{
+	const frozen_document & cached_document::frozen() const
+	{
+		if (m_frozen_ready.load(std::memory_order_acquire)) return m_frozen;
+
+		// not call_once: thread building snapshot would wait for document lock held by thread waiting in call_once.
+		// Under document lock snapshot is built by whoever comes first, including current holder of lock()
+		auto document = lock();
+		if (not m_frozen_ready.load(std::memory_order_relaxed))
+		{
+			m_frozen = freeze(document.get());
+			m_frozen_ready.store(true, std::memory_order_release);
+		}
+
+		return m_frozen;
+	}
+
+	document_cache::document_cache(const document_cache_options & options /* = {} */)
+	    : m_options(options)
+	{
+
+	}
+
+	auto document_cache::identify(const std::string & file) -> file_identity
+	{
+		file_identity identity;
+
+	#if BOOST_OS_WINDOWS
+		auto wfile = to_xmlch(file);
+		auto handle = ::CreateFileW(reinterpret_cast<const wchar_t *>(wfile.c_str()), FILE_READ_ATTRIBUTES,
+		                            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+		if (handle == INVALID_HANDLE_VALUE)
+			throw std::system_error(::GetLastError(), std::system_category(), "xercesc_utils::document_cache: failed to open " + file);
+
+		BY_HANDLE_FILE_INFORMATION info;
+		auto res = ::GetFileInformationByHandle(handle, &info);
+		auto err = ::GetLastError();
+		::CloseHandle(handle);
+		if (not res) throw std::system_error(err, std::system_category(), "xercesc_utils::document_cache: failed to get information of " + file);
+
+		identity.device = info.dwVolumeSerialNumber;
+		identity.inode = std::uint64_t(info.nFileIndexHigh) << 32 | info.nFileIndexLow;
+		identity.size = std::uint64_t(info.nFileSizeHigh) << 32 | info.nFileSizeLow;
+		identity.mtime = std::int64_t(std::uint64_t(info.ftLastWriteTime.dwHighDateTime) << 32 | info.ftLastWriteTime.dwLowDateTime);
+	#else
+		struct stat st;
+		if (::stat(file.c_str(), &st) != 0)
+			throw std::system_error(errno, std::generic_category(), "xercesc_utils::document_cache: failed to stat " + file);
+
+		identity.device = static_cast<std::uint64_t>(st.st_dev);
+		identity.inode = static_cast<std::uint64_t>(st.st_ino);
+		identity.size = static_cast<std::uint64_t>(st.st_size);
+	#if BOOST_OS_MACOS
+		identity.mtime = std::int64_t(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+	#else
+		identity.mtime = std::int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+	#endif
+	#endif
+
+		return identity;
+	}
+
+	void document_cache::remove(const entry_ptr & ent)
+	{
+		auto it = m_entries.find(ent->path);
+		if (it != m_entries.end() and it->second == ent)
+			m_entries.erase(it);
+
+		if (ent->ready)
+		{
+			m_lru.erase(ent->lru);
+			m_memory -= ent->cost;
+			ent->ready = false;
+		}
+	}
+
+	void document_cache::shrink(std::size_t budget, std::vector<entry_ptr> & evicted)
+	{
+		while (m_memory > budget and not m_lru.empty())
+		{
+			evicted.push_back(m_lru.back());
+			remove(evicted.back());
+			++m_evictions;
+		}
+	}
+
+	auto document_cache::load(const std::string & path, const xml_string * wpath) -> document_ptr
+	{
+		auto identity = identify(path);
+		auto parse = [&path, wpath]() -> document_ptr
+		{
+			auto document = wpath ? xercesc_utils::load_from_file(*wpath) : xercesc_utils::load_from_file(path);
+			return std::make_shared<const cached_document>(std::move(document));
+		};
+
+		// dropped entries are released outside of lock
+		std::vector<entry_ptr> released;
+		std::unique_lock<std::mutex> lock(m_mutex);
+		auto it = m_entries.find(path);
+		if (it != m_entries.end())
+		{
+			auto ent = it->second;
+			if (ent->identity == identity)
+			{
+				auto document = ent->document;
+				if (ent->ready)
+				{
+					++m_hits;
+					m_lru.splice(m_lru.begin(), m_lru, ent->lru);
+				}
+				else
+				{
+					++m_waits;
+				}
+
+				lock.unlock();
+				return document.get();
+			}
+
+			// file has changed, current holders keep old document
+			released.push_back(ent);
+			remove(ent);
+		}
+
+		++m_misses;
+		if (not m_options.memory_budget)
+		{
+			lock.unlock();
+			return parse();
+		}
+
+		std::promise<document_ptr> promise;
+		auto ent = std::make_shared<entry>();
+		ent->path = path;
+		ent->identity = identity;
+		ent->document = promise.get_future().share();
+		m_entries.emplace(path, ent);
+		lock.unlock();
+
+		document_ptr document;
+		try
+		{
+			document = parse();
+		}
+		catch (...)
+		{
+			// waiters get the same error, next request parses again
+			promise.set_exception(std::current_exception());
+
+			lock.lock();
+			remove(ent);
+			throw;
+		}
+
+		promise.set_value(document);
+
+		lock.lock();
+		it = m_entries.find(path);
+		// entry was erased or replaced while parsing
+		if (it == m_entries.end() or it->second != ent) return document;
+
+		ent->cost = static_cast<std::size_t>(static_cast<double>(identity.size) * m_options.memory_factor);
+		if (ent->cost > m_options.memory_budget)
+		{
+			m_entries.erase(it);
+			return document;
+		}
+
+		ent->ready = true;
+		ent->lru = m_lru.insert(m_lru.begin(), ent);
+		m_memory += ent->cost;
+		shrink(m_options.memory_budget, released);
+
+		return document;
+	}
+
+	auto document_cache::load_from_file(const std::string & file) -> document_ptr
+	{
+		return load(file, nullptr);
+	}
+
+	auto document_cache::load_from_file(const xml_string & file) -> document_ptr
+	{
+		return load(to_utf8(file), &file);
+	}
+
+	void document_cache::erase(const std::string & file)
+	{
+		entry_ptr ent;
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto it = m_entries.find(file);
+		if (it == m_entries.end()) return;
+
+		ent = it->second;
+		remove(ent);
+	}
+
+	void document_cache::clear()
+	{
+		// documents are released outside of lock
+		std::unordered_map<std::string, entry_ptr> entries;
+		lru_list lru;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto & ent : m_lru) ent->ready = false;
+
+		entries.swap(m_entries);
+		lru.swap(m_lru);
+		m_memory = 0;
+	}
+
+	document_cache_options document_cache::options() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_options;
+	}
+
+	void document_cache::set_options(const document_cache_options & options)
+	{
+		std::vector<entry_ptr> evicted;
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_options = options;
+		shrink(m_options.memory_budget, evicted);
+	}
+
+	document_cache_statistics document_cache::statistics() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		document_cache_statistics stats;
+		stats.hits = m_hits;
+		stats.misses = m_misses;
+		stats.waits = m_waits;
+		stats.evictions = m_evictions;
+		stats.size = m_lru.size();
+		stats.memory = m_memory;
+		stats.memory_budget = m_options.memory_budget;
+		return stats;
+	}
+
+	document_cache & shared_document_cache()
+	{
+		// intentionally leaked: static destruction can happen after XMLPlatformUtils::Terminate
+		static auto * cache = new document_cache();
+		return *cache;
+	}
+}
@@ -0,0 +1,417 @@
+﻿#include <cerrno>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <system_error>
+#include <xercesc/xercesc_utils.hpp>
+#include <boost/predef.h>
+
+#if BOOST_OS_WINDOWS
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#endif
+
+namespace xercesc_utils
+{
+	namespace
+	{
+		[[noreturn]] void throw_last_error(const char * what)
+		{
+			throw std::system_error(errno, std::generic_category(), what);
+		}
+
+		/// unique suffix for temporary file: ".<pid>.<counter>.<time>.tmp"
+		std::string temp_suffix()
+		{
+			static std::atomic_uint counter = 0;
+
+		#if BOOST_OS_WINDOWS
+			auto pid = ::_getpid();
+		#else
+			auto pid = ::getpid();
+		#endif
+
+			auto ticks = std::chrono::steady_clock::now().time_since_epoch().count();
+			return "." + std::to_string(pid) + "." + std::to_string(counter++) + "." + std::to_string(ticks % 1000000) + ".tmp";
+		}
+
+	#if !BOOST_OS_WINDOWS
+		/// directory of file path, for fsync after rename
+		std::string parent_directory(const std::string & path)
+		{
+			auto pos = path.rfind('/');
+			if (pos == path.npos) return ".";
+			if (pos == 0) return "/";
+			return path.substr(0, pos);
+		}
+
+		void sync_directory(const std::string & path)
+		{
+			int fd = ::open(parent_directory(path).c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0) throw_last_error("xercesc_utils::file_target: failed to open directory for fsync");
+
+			int res = ::fsync(fd);
+			int err = errno;
+			::close(fd);
+
+			// some filesystems do not support fsync on directories
+			if (res != 0 and err != EINVAL and err != EBADF)
+				throw std::system_error(err, std::generic_category(), "xercesc_utils::file_target: failed to fsync directory");
+		}
+	#endif
+	} // 'anonymous' namespace
+
+	file_target::file_target(const std::string & path, const file_target_options & options /* = {} */)
+	    : m_options(options), m_path(path)
+	{
+	#if BOOST_OS_WINDOWS
+		m_wpath = to_xmlch(path);
+	#endif
+		open();
+	}
+
+	file_target::file_target(const xml_string & path, const file_target_options & options /* = {} */)
+	    : m_options(options), m_wpath(path)
+	{
+		m_path = to_utf8(path);
+		open();
+	}
+
+	file_target::~file_target()
+	{
+		if (m_fd < 0) return;
+
+		if (not m_options.atomic)
+		{
+			try { flush(); }
+			catch (...) {}
+		}
+
+		close();
+
+		if (m_options.atomic)
+		{
+		#if BOOST_OS_WINDOWS
+			::_wunlink(reinterpret_cast<const wchar_t *>(m_wtemp_path.c_str()));
+		#else
+			::unlink(m_temp_path.c_str());
+		#endif
+		}
+	}
+
+	void file_target::open()
+	{
+		if (not m_options.buffer_size) throw std::invalid_argument("xercesc_utils::file_target: buffer_size is 0");
+		m_buffer.resize(m_options.buffer_size);
+
+	#if BOOST_OS_WINDOWS
+		int flags = _O_WRONLY | _O_CREAT | _O_BINARY | _O_NOINHERIT | (m_options.atomic ? _O_EXCL : _O_TRUNC);
+		if (m_options.atomic)
+		{
+			auto suffix = temp_suffix();
+			m_temp_path = m_path + suffix;
+			m_wtemp_path = m_wpath + to_xmlch(suffix);
+		}
+
+		auto & wpath = m_options.atomic ? m_wtemp_path : m_wpath;
+		m_fd = ::_wopen(reinterpret_cast<const wchar_t *>(wpath.c_str()), flags, _S_IREAD | _S_IWRITE);
+		if (m_fd < 0) throw_last_error("xercesc_utils::file_target: failed to open file");
+	#else
+		int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (m_options.atomic ? O_EXCL : O_TRUNC);
+		if (m_options.atomic)
+			m_temp_path = m_path + temp_suffix();
+
+		auto & path = m_options.atomic ? m_temp_path : m_path;
+		do m_fd = ::open(path.c_str(), flags, 0666);
+		while (m_fd < 0 and errno == EINTR);
+
+		if (m_fd < 0) throw_last_error("xercesc_utils::file_target: failed to open file");
+
+		if (m_options.preallocate)
+		{
+		#if BOOST_OS_LINUX
+			// reserve space without changing file size, failures are not fatal - it's only a hint
+			::fallocate(m_fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(m_options.preallocate));
+		#endif
+		}
+	#endif
+	}
+
+	void file_target::close() noexcept
+	{
+		if (m_fd < 0) return;
+
+	#if BOOST_OS_WINDOWS
+		::_close(m_fd);
+	#else
+		::close(m_fd);
+	#endif
+		m_fd = -1;
+	}
+
+	void file_target::write_all(const char * data1, std::size_t size1, const char * data2, std::size_t size2)
+	{
+	#if BOOST_OS_WINDOWS
+		for (auto [data, size] : {std::make_pair(data1, size1), std::make_pair(data2, size2)})
+		{
+			while (size)
+			{
+				unsigned chunk = static_cast<unsigned>(std::min<std::size_t>(size, 1u << 30));
+				int res = ::_write(m_fd, data, chunk);
+				if (res < 0) throw_last_error("xercesc_utils::file_target: failed to write file");
+
+				data += res, size -= res;
+				m_written += res;
+			}
+		}
+	#else
+		// both blocks are written by one system call, partial writes are continued
+		::iovec iov[2] = {{const_cast<char *>(data1), size1}, {const_cast<char *>(data2), size2}};
+		::iovec * first = iov;
+		int count = 2;
+
+		while (count)
+		{
+			if (not first->iov_len)
+			{
+				++first, --count;
+				continue;
+			}
+
+			auto res = ::writev(m_fd, first, count);
+			if (res < 0)
+			{
+				if (errno == EINTR) continue;
+				throw_last_error("xercesc_utils::file_target: failed to write file");
+			}
+
+			m_written += res;
+			for (std::size_t n = res; n;)
+			{
+				std::size_t step = std::min(n, first->iov_len);
+				first->iov_base = static_cast<char *>(first->iov_base) + step;
+				first->iov_len -= step;
+				n -= step;
+
+				if (not first->iov_len) ++first, --count;
+			}
+		}
+	#endif
+	}
+
+	void file_target::writeChars(const XMLByte * toWrite, const XMLSize_t count, xercesc::XMLFormatter * formatter)
+	{
+		if (m_fd < 0) throw std::logic_error("xercesc_utils::file_target: file is already committed");
+
+		auto * data = reinterpret_cast<const char *>(toWrite);
+		if (m_buffered + count <= m_buffer.size())
+		{
+			std::memcpy(m_buffer.data() + m_buffered, data, count);
+			m_buffered += count;
+			return;
+		}
+
+		// buffered data and new block go out together
+		auto buffered = m_buffered;
+		m_buffered = 0;
+		write_all(m_buffer.data(), buffered, data, count);
+	}
+
+	void file_target::flush()
+	{
+		if (m_fd < 0 or not m_buffered) return;
+
+		auto buffered = m_buffered;
+		m_buffered = 0;
+		write_all(m_buffer.data(), buffered, nullptr, 0);
+	}
+
+	void file_target::commit()
+	{
+		if (m_fd < 0) throw std::logic_error("xercesc_utils::file_target: file is already committed");
+
+		try
+		{
+			flush();
+
+		#if BOOST_OS_WINDOWS
+			if (m_options.fsync != fsync_policy::none and ::_commit(m_fd) != 0)
+				throw_last_error("xercesc_utils::file_target: failed to sync file");
+
+			int res = ::_close(m_fd);
+			m_fd = -1;
+			if (res != 0) throw_last_error("xercesc_utils::file_target: failed to close file");
+
+			if (m_options.atomic)
+			{
+				DWORD flags = MOVEFILE_REPLACE_EXISTING;
+				if (m_options.fsync == fsync_policy::full) flags |= MOVEFILE_WRITE_THROUGH;
+
+				auto * from = reinterpret_cast<const wchar_t *>(m_wtemp_path.c_str());
+				auto * to   = reinterpret_cast<const wchar_t *>(m_wpath.c_str());
+				if (not ::MoveFileExW(from, to, flags))
+					throw std::system_error(static_cast<int>(::GetLastError()), std::system_category(), "xercesc_utils::file_target: failed to replace file");
+			}
+		#else
+			// preallocated space beyond written data is released
+			if (m_options.preallocate and ::ftruncate(m_fd, static_cast<off_t>(m_written)) != 0)
+				throw_last_error("xercesc_utils::file_target: failed to truncate file");
+
+			// replaced file keeps its permission bits, temporary file is created with 0666 & ~umask
+			struct stat st;
+			if (m_options.atomic and ::stat(m_path.c_str(), &st) == 0 and ::fchmod(m_fd, st.st_mode & 07777) != 0)
+				throw_last_error("xercesc_utils::file_target: failed to set file mode");
+
+			int res = 0;
+			switch (m_options.fsync)
+			{
+				case fsync_policy::none: break;
+			#if BOOST_OS_LINUX
+				case fsync_policy::data: res = ::fdatasync(m_fd); break;
+			#else
+				case fsync_policy::data: res = ::fsync(m_fd); break;
+			#endif
+				case fsync_policy::full: res = ::fsync(m_fd); break;
+			}
+
+			if (res != 0) throw_last_error("xercesc_utils::file_target: failed to sync file");
+
+			// close errors can report delayed write failures(NFS)
+			res = ::close(m_fd);
+			m_fd = -1;
+			if (res != 0 and errno != EINTR) throw_last_error("xercesc_utils::file_target: failed to close file");
+
+			if (m_options.atomic)
+			{
+				if (::rename(m_temp_path.c_str(), m_path.c_str()) != 0)
+					throw_last_error("xercesc_utils::file_target: failed to replace file");
+
+				if (m_options.fsync == fsync_policy::full)
+					sync_directory(m_path);
+			}
+		#endif
+		}
+		catch (...)
+		{
+			close();
+			if (m_options.atomic)
+			{
+			#if BOOST_OS_WINDOWS
+				::_wunlink(reinterpret_cast<const wchar_t *>(m_wtemp_path.c_str()));
+			#else
+				::unlink(m_temp_path.c_str());
+			#endif
+			}
+
+			throw;
+		}
+	}
+
+	/************************************************************************/
+	/*                            mapped_file                               */
+	/************************************************************************/
+	mapped_file::mapped_file(const std::string & path)
+	{
+	#if BOOST_OS_WINDOWS
+		open(path, to_xmlch(path));
+	#else
+		open(path, {});
+	#endif
+	}
+
+	mapped_file::mapped_file(const xml_string & path)
+	{
+		open(to_utf8(path), path);
+	}
+
+	mapped_file::~mapped_file()
+	{
+		close();
+	}
+
+	void mapped_file::close() noexcept
+	{
+	#if BOOST_OS_WINDOWS
+		if (m_data) ::UnmapViewOfFile(m_data);
+		if (m_mapping) ::CloseHandle(m_mapping);
+		if (m_file) ::CloseHandle(m_file);
+	#else
+		if (m_data) ::munmap(const_cast<char *>(m_data), m_size);
+	#endif
+
+		m_data = nullptr;
+		m_file = m_mapping = nullptr;
+	}
+
+#if BOOST_OS_WINDOWS
+	void mapped_file::open(const std::string & path, const xml_string & wpath)
+	{
+		auto file = ::CreateFileW(reinterpret_cast<const wchar_t *>(wpath.c_str()), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+		                          nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			throw std::system_error(::GetLastError(), std::system_category(), "xercesc_utils::mapped_file: failed to open " + path);
+
+		m_file = file;
+		LARGE_INTEGER size;
+		if (not ::GetFileSizeEx(file, &size))
+		{
+			auto err = ::GetLastError();
+			close();
+			throw std::system_error(err, std::system_category(), "xercesc_utils::mapped_file: failed to get size of " + path);
+		}
+
+		m_size = static_cast<std::size_t>(size.QuadPart);
+		if (not m_size) return;
+
+		m_mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping) m_data = static_cast<const char *>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+		if (not m_data)
+		{
+			auto err = ::GetLastError();
+			close();
+			throw std::system_error(err, std::system_category(), "xercesc_utils::mapped_file: failed to map " + path);
+		}
+	}
+#else
+	void mapped_file::open(const std::string & path, const xml_string & /* wpath */)
+	{
+		int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) throw_last_error(("xercesc_utils::mapped_file: failed to open " + path).c_str());
+
+		struct stat st;
+		if (::fstat(fd, &st) != 0)
+		{
+			int err = errno;
+			::close(fd);
+			throw std::system_error(err, std::generic_category(), "xercesc_utils::mapped_file: failed to stat " + path);
+		}
+
+		m_size = static_cast<std::size_t>(st.st_size);
+		if (m_size)
+		{
+			void * data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+			if (data == MAP_FAILED)
+			{
+				int err = errno;
+				::close(fd);
+				throw std::system_error(err, std::generic_category(), "xercesc_utils::mapped_file: failed to map " + path);
+			}
+
+			m_data = static_cast<const char *>(data);
+		}
+
+		// mapping stays valid after descriptor is closed
+		::close(fd);
+	}
+#endif
+}
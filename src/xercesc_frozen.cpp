@@ -0,0 +1,651 @@
+﻿#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <xercesc/xercesc_frozen.hpp>
+
+namespace xercesc_utils
+{
+	using frozen::index_type;
+	using frozen::npos;
+
+	namespace
+	{
+		const std::string_view xmlns_uri = "http://www.w3.org/2000/xmlns/";
+		const std::string_view xmlns_prefix = "xmlns";
+
+		/// skips consecutive separators, as path helpers do
+		inline std::size_t skip_separators(std::string_view path, std::size_t pos) noexcept
+		{
+			while (pos < path.size() and path[pos] == '/') ++pos;
+			return pos;
+		}
+
+		/// surrounding spaces are trimmed as in get_text_content
+		inline std::string_view trim(std::string_view text) noexcept
+		{
+			auto is_space = [](char ch) { return ch == ' ' or ch == '\r' or ch == '\n'; };
+			while (not text.empty() and is_space(text.front())) text.remove_prefix(1);
+			while (not text.empty() and is_space(text.back())) text.remove_suffix(1);
+			return text;
+		}
+
+		inline std::string_view next_segment(std::string_view path, std::size_t & pos) noexcept
+		{
+			auto last = std::min(path.find('/', pos), path.size());
+			auto segment = path.substr(pos, last - pos);
+			pos = skip_separators(path, last);
+			return segment;
+		}
+	}
+
+	/************************************************************************/
+	/*                           frozen_builder                             */
+	/************************************************************************/
+	class frozen_builder
+	{
+		frozen_document & m_doc;
+		std::unordered_map<std::string, frozen::string_ref> m_interned;
+		std::unordered_map<std::string, index_type> m_name_ids; // namespace + '\0' + local name -> unsorted name id
+		std::string m_buffer;
+
+	private:
+		frozen::string_ref append(std::string_view str);
+		frozen::string_ref intern(std::string_view str);
+		index_type intern_name(const xercesc::DOMNode * node);
+		std::string_view to_utf8(const XMLCh * str);
+
+		void add_attributes(frozen::node_entry & entry, const xercesc::DOMElement * element);
+		/// text of text, CDATA and entity reference nodes, false for other nodes
+		bool append_text(const xercesc::DOMNode * node, std::string & text);
+		void sort_names();
+
+	public:
+		frozen_builder(frozen_document & doc) : m_doc(doc) {}
+		void build(const xercesc::DOMElement * root);
+	};
+
+	frozen::string_ref frozen_builder::append(std::string_view str)
+	{
+		auto & arena = m_doc.m_arena;
+		if (arena.size() + str.size() > std::numeric_limits<std::uint32_t>::max())
+			throw std::length_error("xercesc_utils::freeze: document text exceeds 4GiB");
+
+		frozen::string_ref ref {static_cast<std::uint32_t>(arena.size()), static_cast<std::uint32_t>(str.size())};
+		arena.insert(arena.end(), str.begin(), str.end());
+		return ref;
+	}
+
+	frozen::string_ref frozen_builder::intern(std::string_view str)
+	{
+		auto it = m_interned.find(std::string(str));
+		if (it != m_interned.end()) return it->second;
+
+		auto ref = append(str);
+		m_interned.emplace(str, ref);
+		return ref;
+	}
+
+	std::string_view frozen_builder::to_utf8(const XMLCh * str)
+	{
+		m_buffer = str ? xercesc_utils::to_utf8(str) : std::string();
+		return m_buffer;
+	}
+
+	index_type frozen_builder::intern_name(const xercesc::DOMNode * node)
+	{
+		auto * local = node->getLocalName();
+		std::string key(to_utf8(node->getNamespaceURI()));
+		key.push_back('\0');
+		key.append(to_utf8(local ? local : node->getNodeName()));
+
+		auto it = m_name_ids.find(key);
+		if (it != m_name_ids.end()) return it->second;
+
+		auto pos = key.find('\0');
+		auto ns = intern(std::string_view(key).substr(0, pos));
+		auto local_name = intern(std::string_view(key).substr(pos + 1));
+
+		auto id = static_cast<index_type>(m_doc.m_names.size());
+		m_doc.m_names.push_back({ns, local_name});
+		m_name_ids.emplace(std::move(key), id);
+		return id;
+	}
+
+	void frozen_builder::add_attributes(frozen::node_entry & entry, const xercesc::DOMElement * element)
+	{
+		auto * attrs = element->getAttributes();
+		XMLSize_t count = attrs ? attrs->getLength() : 0;
+
+		entry.first_attribute = static_cast<index_type>(m_doc.m_attributes.size());
+		entry.attribute_count = static_cast<index_type>(count);
+
+		for (XMLSize_t i = 0; i < count; ++i)
+		{
+			auto * attr = attrs->item(i);
+
+			frozen::attribute_entry attr_entry;
+			attr_entry.name = intern_name(attr);
+			attr_entry.prefix = intern(to_utf8(attr->getPrefix()));
+			attr_entry.value = append(to_utf8(attr->getNodeValue()));
+			m_doc.m_attributes.push_back(attr_entry);
+		}
+	}
+
+	bool frozen_builder::append_text(const xercesc::DOMNode * node, std::string & text)
+	{
+		switch (node->getNodeType())
+		{
+			case xercesc::DOMNode::TEXT_NODE:
+			case xercesc::DOMNode::CDATA_SECTION_NODE:
+				text += to_utf8(node->getNodeValue());
+				return true;
+			case xercesc::DOMNode::ENTITY_REFERENCE_NODE:
+				text += to_utf8(node->getTextContent());
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	void frozen_builder::build(const xercesc::DOMElement * root)
+	{
+		struct frame
+		{
+			const xercesc::DOMNode * next_child;
+			index_type index;
+			index_type last_child;
+		};
+
+		auto & nodes = m_doc.m_nodes;
+		std::vector<frame> stack;
+		std::string text;
+
+		// creates element entry, for elements without child elements text is stored right away
+		auto add_element = [&](const xercesc::DOMElement * element, index_type parent)
+		{
+			if (nodes.size() >= npos) throw std::length_error("xercesc_utils::freeze: too many nodes");
+
+			auto index = static_cast<index_type>(nodes.size());
+			frozen::node_entry entry {parent, npos, npos, intern_name(element), 0, 0, intern(to_utf8(element->getPrefix())), {0, 0}};
+			add_attributes(entry, element);
+
+			bool leaf = not element->getFirstElementChild();
+			if (leaf)
+			{
+				text.clear();
+				for (auto * child = element->getFirstChild(); child; child = child->getNextSibling())
+					append_text(child, text);
+
+				entry.text = append(text);
+			}
+
+			nodes.push_back(entry);
+			stack.push_back({leaf ? nullptr : element->getFirstChild(), index, npos});
+			return index;
+		};
+
+		auto link = [&](frame & parent, index_type child)
+		{
+			if (parent.last_child == npos) nodes[parent.index].first_child = child;
+			else                           nodes[parent.last_child].next_sibling = child;
+			parent.last_child = child;
+		};
+
+		add_element(root, npos);
+		while (not stack.empty())
+		{
+			auto * node = stack.back().next_child;
+			if (not node)
+			{
+				stack.pop_back();
+				continue;
+			}
+
+			stack.back().next_child = node->getNextSibling();
+			if (node->getNodeType() == xercesc::DOMNode::ELEMENT_NODE)
+			{
+				auto parent = stack.size() - 1;
+				auto index = add_element(static_cast<const xercesc::DOMElement *>(node), stack[parent].index);
+				link(stack[parent], index);
+				continue;
+			}
+
+			text.clear();
+			if (not append_text(node, text)) continue;
+
+			auto & parent = stack.back();
+			auto & last = parent.last_child;
+			// adjacent text nodes are merged, their text is contiguous in arena
+			if (last != npos and nodes[last].name == npos and nodes[last].text.offset + nodes[last].text.size == m_doc.m_arena.size())
+			{
+				nodes[last].text.size += append(text).size;
+				continue;
+			}
+
+			auto index = static_cast<index_type>(nodes.size());
+			nodes.push_back({parent.index, npos, npos, npos, 0, 0, {0, 0}, append(text)});
+			link(parent, index);
+		}
+
+		sort_names();
+	}
+
+	void frozen_builder::sort_names()
+	{
+		auto & names = m_doc.m_names;
+		auto str = [this](frozen::string_ref ref) { return std::string_view(m_doc.m_arena.data() + ref.offset, ref.size); };
+
+		std::vector<index_type> order(names.size());
+		for (index_type i = 0; i < order.size(); ++i) order[i] = i;
+
+		std::sort(order.begin(), order.end(), [&](index_type op1, index_type op2)
+		{
+			auto ns1 = str(names[op1].namespace_uri), ns2 = str(names[op2].namespace_uri);
+			if (ns1 != ns2) return ns1 < ns2;
+			return str(names[op1].local_name) < str(names[op2].local_name);
+		});
+
+		std::vector<index_type> remap(names.size());
+		std::vector<frozen::name_entry> sorted(names.size());
+		for (index_type i = 0; i < order.size(); ++i)
+		{
+			remap[order[i]] = i;
+			sorted[i] = names[order[i]];
+		}
+
+		names.swap(sorted);
+		for (auto & node : m_doc.m_nodes)
+			if (node.name != npos) node.name = remap[node.name];
+
+		for (auto & attr : m_doc.m_attributes)
+			attr.name = remap[attr.name];
+	}
+
+	/************************************************************************/
+	/*                           frozen_document                            */
+	/************************************************************************/
+	frozen_document::frozen_document(const frozen::tables & tables, std::shared_ptr<const void> storage, namespace_bindings_ptr bindings /* = nullptr */)
+	    : m_storage(std::move(storage)), m_tables(tables), m_bindings(std::move(bindings))
+	{
+
+	}
+
+	void frozen_document::attach_tables() noexcept
+	{
+		m_tables.nodes = m_nodes.data();           m_tables.node_count = m_nodes.size();
+		m_tables.attributes = m_attributes.data(); m_tables.attribute_count = m_attributes.size();
+		m_tables.names = m_names.data();           m_tables.name_count = m_names.size();
+		m_tables.arena = m_arena.data();           m_tables.arena_size = m_arena.size();
+	}
+
+	std::size_t frozen_document::memory_size() const noexcept
+	{
+		return m_tables.node_count * sizeof(frozen::node_entry)
+		     + m_tables.attribute_count * sizeof(frozen::attribute_entry)
+		     + m_tables.name_count * sizeof(frozen::name_entry)
+		     + m_tables.arena_size;
+	}
+
+	index_type frozen_document::find_name(std::string_view namespace_uri, std::string_view local_name) const noexcept
+	{
+		auto * first = m_tables.names;
+		auto * last  = first + m_tables.name_count;
+
+		auto it = std::lower_bound(first, last, std::make_pair(namespace_uri, local_name), [this](const frozen::name_entry & entry, const auto & value)
+		{
+			auto ns = str(entry.namespace_uri);
+			if (ns != value.first) return ns < value.first;
+			return str(entry.local_name) < value.second;
+		});
+
+		if (it == last or str(it->namespace_uri) != namespace_uri or str(it->local_name) != local_name) return npos;
+		return static_cast<index_type>(it - first);
+	}
+
+	bool frozen_document::lookup_namespace_uri(index_type element, std::string_view prefix, std::string & uri) const
+	{
+		if (m_bindings)
+		{
+			auto * found = m_bindings->lookup_uri(to_xmlch(prefix));
+			if (not found) return false;
+
+			uri = to_utf8(found);
+			return true;
+		}
+
+		// same order as DOMElement::lookupNamespaceURI: element own namespace, then its xmlns attributes, then ancestors
+		for (; element != npos; element = m_tables.nodes[element].parent)
+		{
+			auto & node = m_tables.nodes[element];
+			auto & name = m_tables.names[node.name];
+			if (name.namespace_uri.size and str(node.prefix) == prefix)
+			{
+				uri = str(name.namespace_uri);
+				return true;
+			}
+
+			auto * attr = m_tables.attributes + node.first_attribute;
+			for (auto * last = attr + node.attribute_count; attr != last; ++attr)
+			{
+				auto & attr_name = m_tables.names[attr->name];
+				if (str(attr_name.namespace_uri) != xmlns_uri) continue;
+
+				bool matches = prefix.empty() ? str(attr->prefix).empty() and str(attr_name.local_name) == xmlns_prefix
+				                              : str(attr->prefix) == xmlns_prefix and str(attr_name.local_name) == prefix;
+				if (not matches) continue;
+
+				// xmlns="" undeclares namespace
+				if (not attr->value.size) return false;
+
+				uri = str(attr->value);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool frozen_document::resolve_name(index_type element, std::string_view qname, index_type & name) const
+	{
+		std::string_view namespace_uri, local_name = qname;
+		std::string uri;
+
+		auto pos = qname.find(':');
+		if (pos != qname.npos)
+		{
+			auto prefix = qname.substr(0, pos);
+			if (not lookup_namespace_uri(element, prefix, uri))
+				throw xml_namespace_exception("xml namespace not found, prefix = " + std::string(prefix));
+
+			namespace_uri = uri;
+			local_name = qname.substr(pos + 1);
+		}
+
+		name = find_name(namespace_uri, local_name);
+		return name != npos;
+	}
+
+	index_type frozen_document::find_child(index_type parent, index_type name) const noexcept
+	{
+		auto * nodes = m_tables.nodes;
+		for (auto child = nodes[parent].first_child; child != npos; child = nodes[child].next_sibling)
+			if (nodes[child].name == name) return child;
+
+		return npos;
+	}
+
+	index_type frozen_document::find_sibling(index_type element, index_type name) const noexcept
+	{
+		auto * nodes = m_tables.nodes;
+		for (auto sibling = nodes[element].next_sibling; sibling != npos; sibling = nodes[sibling].next_sibling)
+			if (nodes[sibling].name == name) return sibling;
+
+		return npos;
+	}
+
+	index_type frozen_document::find_path(index_type element, std::string_view path) const
+	{
+		if (element == npos or path.empty()) return element;
+		if (path.front() == '/') return find_path(path).index();
+
+		std::size_t pos = 0;
+		while (pos < path.size() and element != npos)
+		{
+			index_type name;
+			auto segment = next_segment(path, pos);
+			if (not resolve_name(element, segment, name)) return npos;
+
+			element = find_child(element, name);
+		}
+
+		return element;
+	}
+
+	const frozen::attribute_entry * frozen_document::find_attribute(index_type element, std::string_view qname) const
+	{
+		auto & node = m_tables.nodes[element];
+		auto * first = m_tables.attributes + node.first_attribute;
+		auto * last  = first + node.attribute_count;
+
+		// unprefixed name is compared with qualified name, as DOMElement::getAttributeNode
+		auto pos = qname.find(':');
+		if (pos == qname.npos)
+		{
+			auto it = std::find_if(first, last, [&](auto & attr) { return not attr.prefix.size and str(m_tables.names[attr.name].local_name) == qname; });
+			return it == last ? nullptr : it;
+		}
+
+		index_type name;
+		if (not resolve_name(element, qname, name)) return nullptr;
+
+		auto it = std::find_if(first, last, [&](auto & attr) { return attr.name == name; });
+		return it == last ? nullptr : it;
+	}
+
+	void frozen_document::append_text(index_type node, std::string & out) const
+	{
+		// subtree is contiguous in document order: up to next sibling of node or of its nearest ancestor
+		auto * nodes = m_tables.nodes;
+		auto end = node;
+		while (end != npos and nodes[end].next_sibling == npos) end = nodes[end].parent;
+		auto last = end == npos ? m_tables.node_count : nodes[end].next_sibling;
+
+		for (auto i = node; i < last; ++i)
+			out.append(str(nodes[i].text));
+	}
+
+	frozen_element frozen_document::find_path(std::string_view path) const
+	{
+		if (empty() or path.empty()) return {};
+
+		std::size_t pos = skip_separators(path, 0);
+		auto root_name = next_segment(path, pos);
+
+		index_type name;
+		if (not resolve_name(0, root_name, name) or m_tables.nodes[0].name != name) return {};
+
+		return frozen_element(this, find_path(0, path.substr(pos)));
+	}
+
+	frozen_element frozen_document::get_path(std::string_view path) const
+	{
+		auto element = find_path(path);
+		if (not element) throw xml_path_exception(std::string(path));
+		return element;
+	}
+
+	std::string frozen_document::find_path_text(std::string_view path, std::string_view defval /* = empty_string */) const
+	{
+		auto element = find_path(path);
+		if (not element) return std::string(defval.data(), defval.size());
+		return element.text();
+	}
+
+	std::string frozen_document::get_path_text(std::string_view path) const
+	{
+		return get_path(path).text();
+	}
+
+	/************************************************************************/
+	/*                           frozen_element                             */
+	/************************************************************************/
+	const frozen::node_entry & frozen_element::entry() const noexcept
+	{
+		return m_doc->m_tables.nodes[m_index];
+	}
+
+	std::string_view frozen_element::local_name() const noexcept
+	{
+		return valid() ? m_doc->str(m_doc->m_tables.names[entry().name].local_name) : std::string_view();
+	}
+
+	std::string_view frozen_element::namespace_uri() const noexcept
+	{
+		return valid() ? m_doc->str(m_doc->m_tables.names[entry().name].namespace_uri) : std::string_view();
+	}
+
+	std::string_view frozen_element::prefix() const noexcept
+	{
+		return valid() ? m_doc->str(entry().prefix) : std::string_view();
+	}
+
+	std::string frozen_element::text() const
+	{
+		if (not valid()) return {};
+		if (entry().first_child == npos) return std::string(text_view());
+
+		std::string result;
+		m_doc->append_text(m_index, result);
+		return std::string(trim(result));
+	}
+
+	std::string_view frozen_element::text_view() const noexcept
+	{
+		return valid() ? trim(m_doc->str(entry().text)) : std::string_view();
+	}
+
+	frozen_element frozen_element::parent() const noexcept
+	{
+		return valid() ? frozen_element(m_doc, entry().parent) : frozen_element();
+	}
+
+	frozen_element frozen_element::first_child() const noexcept
+	{
+		if (not valid()) return {};
+
+		// text nodes are skipped
+		auto * nodes = m_doc->m_tables.nodes;
+		auto child = entry().first_child;
+		while (child != npos and nodes[child].name == npos) child = nodes[child].next_sibling;
+		return frozen_element(m_doc, child);
+	}
+
+	frozen_element frozen_element::next_sibling() const noexcept
+	{
+		if (not valid()) return {};
+
+		auto * nodes = m_doc->m_tables.nodes;
+		auto sibling = entry().next_sibling;
+		while (sibling != npos and nodes[sibling].name == npos) sibling = nodes[sibling].next_sibling;
+		return frozen_element(m_doc, sibling);
+	}
+
+	frozen_element frozen_element::find_child(std::string_view name) const
+	{
+		if (not valid()) return {};
+
+		index_type name_index;
+		if (not m_doc->resolve_name(m_index, name, name_index)) return {};
+		return frozen_element(m_doc, m_doc->find_child(m_index, name_index));
+	}
+
+	frozen_element frozen_element::next_sibling(std::string_view name) const
+	{
+		if (not valid()) return {};
+
+		index_type name_index;
+		if (not m_doc->resolve_name(m_index, name, name_index)) return {};
+		return frozen_element(m_doc, m_doc->find_sibling(m_index, name_index));
+	}
+
+	frozen_element frozen_element::find_path(std::string_view path) const
+	{
+		if (not valid()) return {};
+		return frozen_element(m_doc, m_doc->find_path(m_index, path));
+	}
+
+	frozen_element frozen_element::get_path(std::string_view path) const
+	{
+		if (not valid()) throw std::invalid_argument("xercesc_utils::frozen_element::get_path: element is null");
+
+		auto element = find_path(path);
+		if (not element) throw xml_path_exception(std::string(path));
+		return element;
+	}
+
+	std::string frozen_element::find_path_text(std::string_view path, std::string_view defval /* = empty_string */) const
+	{
+		auto element = find_path(path);
+		if (not element) return std::string(defval.data(), defval.size());
+		return element.text();
+	}
+
+	std::string frozen_element::get_path_text(std::string_view path) const
+	{
+		return get_path(path).text();
+	}
+
+	std::string_view frozen_element::find_attribute_view(std::string_view name, std::string_view defval /* = {} */) const
+	{
+		if (not valid()) return defval;
+
+		auto * attr = m_doc->find_attribute(m_index, name);
+		return attr ? m_doc->str(attr->value) : defval;
+	}
+
+	bool frozen_element::has_attribute(std::string_view name) const
+	{
+		return valid() and m_doc->find_attribute(m_index, name);
+	}
+
+	std::string frozen_element::find_attribute_text(std::string_view name, std::string_view defval /* = empty_string */) const
+	{
+		return std::string(find_attribute_view(name, defval));
+	}
+
+	std::string frozen_element::get_attribute_text(std::string_view name) const
+	{
+		if (not valid()) throw std::invalid_argument("xercesc_utils::frozen_element::get_attribute_text: element is null");
+
+		auto * attr = m_doc->find_attribute(m_index, name);
+		if (not attr) throw xml_path_exception("@" + std::string(name));
+		return std::string(m_doc->str(attr->value));
+	}
+
+	/************************************************************************/
+	/*                              freeze                                  */
+	/************************************************************************/
+	frozen_document freeze(const xercesc::DOMDocument * doc, namespace_bindings_ptr bindings)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::freeze: document is null");
+
+		frozen_document result;
+		result.m_bindings = std::move(bindings);
+
+		if (auto * root = doc->getDocumentElement())
+		{
+			frozen_builder builder(result);
+			builder.build(root);
+		}
+
+		result.attach_tables();
+		return result;
+	}
+
+	frozen_document freeze(const xercesc::DOMDocument * doc)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::freeze: document is null");
+
+		auto * resolver = get_associated_resolver(const_cast<xercesc::DOMDocument *>(doc));
+		auto * impl = dynamic_cast<DOMXPathNSResolverImpl *>(resolver);
+		return freeze(doc, impl ? impl->bindings() : nullptr);
+	}
+
+	frozen_document load_frozen(std::string_view str)
+	{
+		auto doc = load(str);
+		return freeze(doc.get());
+	}
+
+	frozen_document load_frozen_from_file(const xml_string & file)
+	{
+		auto doc = load_from_file(file);
+		return freeze(doc.get());
+	}
+
+	frozen_document load_frozen_from_file(const std::string & file)
+	{
+		auto doc = load_from_file(file);
+		return freeze(doc.get());
+	}
+}
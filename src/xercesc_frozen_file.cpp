@@ -0,0 +1,326 @@
+﻿#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <xercesc/xercesc_frozen.hpp>
+#include <boost/predef.h>
+
+namespace xercesc_utils
+{
+	namespace
+	{
+		constexpr char frozen_magic[8] = {'X', 'U', 'F', 'R', 'O', 'Z', 'E', 'N'};
+		constexpr std::uint32_t frozen_version = 1;
+		constexpr std::uint32_t frozen_byte_order = 0x01020304;
+		constexpr std::uint64_t table_alignment = 8;
+
+		/// file header, followed by node, attribute, name tables and arena, each aligned to table_alignment
+		struct frozen_file_header
+		{
+			char magic[8];
+			std::uint32_t version;
+			std::uint32_t byte_order;
+			// sizes of entries, guard against layout differences between compilers
+			std::uint32_t node_entry_size, attribute_entry_size, name_entry_size, reserved;
+
+			std::int64_t  source_mtime;
+			std::uint64_t source_size;
+
+			std::uint64_t node_count, attribute_count, name_count, arena_size;
+			std::uint64_t nodes_offset, attributes_offset, names_offset, arena_offset;
+
+			std::uint64_t data_size;  // bytes after header
+			std::uint64_t checksum;   // FNV-1a of bytes after header
+		};
+
+		static_assert(sizeof(frozen_file_header) % table_alignment == 0);
+
+		constexpr std::uint64_t fnv_offset_basis = 0xcbf29ce484222325ull;
+		constexpr std::uint64_t fnv_prime = 0x100000001b3ull;
+
+		std::uint64_t fnv1a(std::uint64_t hash, const void * data, std::size_t size) noexcept
+		{
+			auto * ptr = static_cast<const unsigned char *>(data);
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				hash ^= ptr[i];
+				hash *= fnv_prime;
+			}
+
+			return hash;
+		}
+
+		inline std::uint64_t align(std::uint64_t offset) noexcept
+		{
+			return (offset + table_alignment - 1) & ~(table_alignment - 1);
+		}
+
+		/// one table of file data: bytes followed by padding up to next table
+		struct table_chunk
+		{
+			const void * data;
+			std::uint64_t size, padding;
+		};
+
+		/// fills header table fields, returns chunks in file order
+		std::array<table_chunk, 4> layout(const frozen::tables & tables, frozen_file_header & header)
+		{
+			header.node_count = tables.node_count;
+			header.attribute_count = tables.attribute_count;
+			header.name_count = tables.name_count;
+			header.arena_size = tables.arena_size;
+
+			std::array<table_chunk, 4> chunks = {{
+				{tables.nodes,      tables.node_count * sizeof(frozen::node_entry), 0},
+				{tables.attributes, tables.attribute_count * sizeof(frozen::attribute_entry), 0},
+				{tables.names,      tables.name_count * sizeof(frozen::name_entry), 0},
+				{tables.arena,      tables.arena_size, 0},
+			}};
+
+			std::uint64_t * offsets[] = {&header.nodes_offset, &header.attributes_offset, &header.names_offset, &header.arena_offset};
+			std::uint64_t offset = sizeof(frozen_file_header);
+			for (std::size_t i = 0; i < chunks.size(); ++i)
+			{
+				*offsets[i] = offset;
+				auto next = align(offset + chunks[i].size);
+				chunks[i].padding = next - offset - chunks[i].size;
+				offset = next;
+			}
+
+			header.data_size = offset - sizeof(frozen_file_header);
+			return chunks;
+		}
+
+		/// checks header fields and table bounds against file size, returns error description or nullptr
+		const char * validate(const frozen_file_header & header, std::uint64_t file_size) noexcept
+		{
+			if (std::memcmp(header.magic, frozen_magic, sizeof(frozen_magic)) != 0) return "not a frozen document file";
+			if (header.byte_order != frozen_byte_order) return "file has different byte order";
+			if (header.version != frozen_version) return "unsupported format version";
+			if (header.node_entry_size != sizeof(frozen::node_entry)
+			    or header.attribute_entry_size != sizeof(frozen::attribute_entry)
+			    or header.name_entry_size != sizeof(frozen::name_entry))
+				return "table layout mismatch";
+
+			if (file_size < sizeof(frozen_file_header) or header.data_size != file_size - sizeof(frozen_file_header))
+				return "file is truncated";
+
+			auto fits = [file_size](std::uint64_t offset, std::uint64_t count, std::uint64_t entry_size)
+			{
+				return offset % table_alignment == 0 and offset <= file_size
+				   and count <= (file_size - offset) / entry_size;
+			};
+
+			if (not fits(header.nodes_offset, header.node_count, sizeof(frozen::node_entry))
+			    or not fits(header.attributes_offset, header.attribute_count, sizeof(frozen::attribute_entry))
+			    or not fits(header.names_offset, header.name_count, sizeof(frozen::name_entry))
+			    or not fits(header.arena_offset, header.arena_size, 1))
+				return "table is out of file bounds";
+
+			if (header.node_count >= frozen::npos or header.attribute_count >= frozen::npos or header.arena_size > UINT32_MAX)
+				return "table is too large";
+
+			return nullptr;
+		}
+
+		/// Checks every table entry: indexes point into tables, strings into arena, tree links follow document order layout
+		/// of freeze(parent before children, children and next siblings after node), so corrupted file can't cause
+		/// out of bounds reads or endless traversal. Touches tables only, not arena. Returns error description or nullptr.
+		const char * validate_entries(const frozen::tables & tables) noexcept
+		{
+			auto valid_string = [&tables](frozen::string_ref ref)
+			{
+				return std::uint64_t(ref.offset) + ref.size <= tables.arena_size;
+			};
+
+			for (std::size_t index = 0; index < tables.name_count; ++index)
+			{
+				auto & name = tables.names[index];
+				if (not valid_string(name.namespace_uri) or not valid_string(name.local_name)) return "invalid name entry";
+			}
+
+			for (std::size_t index = 0; index < tables.attribute_count; ++index)
+			{
+				auto & attr = tables.attributes[index];
+				if (attr.name >= tables.name_count or not valid_string(attr.prefix) or not valid_string(attr.value))
+					return "invalid attribute entry";
+			}
+
+			for (std::size_t index = 0; index < tables.node_count; ++index)
+			{
+				auto & node = tables.nodes[index];
+				bool valid_links = index == 0 ? node.parent == frozen::npos : node.parent < index;
+				valid_links = valid_links and (node.first_child == frozen::npos or (node.first_child > index and node.first_child < tables.node_count));
+				valid_links = valid_links and (node.next_sibling == frozen::npos or (node.next_sibling > index and node.next_sibling < tables.node_count));
+				if (not valid_links) return "invalid node links";
+
+				bool text_node = node.name == frozen::npos;
+				if ((not text_node and node.name >= tables.name_count) or (text_node and index == 0))
+					return "invalid node name";
+
+				if (std::uint64_t(node.first_attribute) + node.attribute_count > tables.attribute_count
+				    or not valid_string(node.prefix) or not valid_string(node.text))
+					return "invalid node entry";
+			}
+
+			return nullptr;
+		}
+
+		[[noreturn]] void throw_invalid_file(const std::string & file, const char * what)
+		{
+			throw std::runtime_error("xercesc_utils::open_frozen: " + std::string(what) + ", file = " + file);
+		}
+
+		bool read_header(const std::string & file, frozen_file_header & header, std::uint64_t & file_size)
+		{
+			std::error_code ec;
+			file_size = std::filesystem::file_size(std::filesystem::u8path(file), ec);
+			if (ec or file_size < sizeof(header)) return false;
+
+			std::FILE * fp = nullptr;
+		#if BOOST_OS_WINDOWS
+			auto wfile = to_xmlch(file);
+			fp = ::_wfopen(reinterpret_cast<const wchar_t *>(wfile.c_str()), L"rb");
+		#else
+			fp = std::fopen(file.c_str(), "rb");
+		#endif
+			if (not fp) return false;
+
+			bool ok = std::fread(&header, sizeof(header), 1, fp) == 1;
+			std::fclose(fp);
+			return ok;
+		}
+	} // 'anonymous' namespace
+
+	frozen_file_info source_file_info(const std::string & source)
+	{
+		auto path = std::filesystem::u8path(source);
+
+		frozen_file_info info;
+		info.source_size = std::filesystem::file_size(path);
+		info.source_mtime = static_cast<std::int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+		return info;
+	}
+
+	void save_frozen(const frozen_document & doc, const std::string & file, const frozen_file_info & info /* = {} */)
+	{
+		frozen_file_header header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, frozen_magic, sizeof(frozen_magic));
+		header.version = frozen_version;
+		header.byte_order = frozen_byte_order;
+		header.node_entry_size = sizeof(frozen::node_entry);
+		header.attribute_entry_size = sizeof(frozen::attribute_entry);
+		header.name_entry_size = sizeof(frozen::name_entry);
+		header.source_mtime = info.source_mtime;
+		header.source_size = info.source_size;
+
+		const char padding[table_alignment] = {};
+		auto chunks = layout(doc.tables(), header);
+
+		header.checksum = fnv_offset_basis;
+		for (auto & chunk : chunks)
+		{
+			if (chunk.size) header.checksum = fnv1a(header.checksum, chunk.data, chunk.size);
+			header.checksum = fnv1a(header.checksum, padding, chunk.padding);
+		}
+
+		file_target_options options;
+		options.atomic = true;
+		file_target target(file, options);
+
+		auto write = [&target](const void * data, std::uint64_t size)
+		{
+			if (size) target.writeChars(static_cast<const XMLByte *>(data), static_cast<XMLSize_t>(size), nullptr);
+		};
+
+		write(&header, sizeof(header));
+		for (auto & chunk : chunks)
+		{
+			write(chunk.data, chunk.size);
+			write(padding, chunk.padding);
+		}
+
+		target.commit();
+	}
+
+	void save_frozen(const xercesc::DOMDocument * doc, const std::string & file, const frozen_file_info & info /* = {} */)
+	{
+		save_frozen(freeze(doc), file, info);
+	}
+
+	bool read_frozen_info(const std::string & file, frozen_file_info & info)
+	{
+		frozen_file_header header;
+		std::uint64_t file_size;
+		if (not read_header(file, header, file_size)) return false;
+		if (validate(header, file_size)) return false;
+
+		info.source_size = header.source_size;
+		info.source_mtime = header.source_mtime;
+		return true;
+	}
+
+	frozen_document open_frozen(const std::string & file, bool verify_checksum /* = false */, namespace_bindings_ptr bindings /* = nullptr */)
+	{
+		auto mapping = std::make_shared<mapped_file>(file);
+		if (mapping->size() < sizeof(frozen_file_header)) throw_invalid_file(file, "file is truncated");
+
+		// mapping is page aligned, tables are aligned within file
+		auto * base = mapping->data();
+		auto & header = *reinterpret_cast<const frozen_file_header *>(base);
+		if (auto * error = validate(header, mapping->size())) throw_invalid_file(file, error);
+
+		if (verify_checksum)
+		{
+			auto checksum = fnv1a(fnv_offset_basis, base + sizeof(frozen_file_header), header.data_size);
+			if (checksum != header.checksum) throw_invalid_file(file, "checksum mismatch");
+		}
+
+		frozen::tables tables;
+		tables.nodes = reinterpret_cast<const frozen::node_entry *>(base + header.nodes_offset);
+		tables.node_count = header.node_count;
+		tables.attributes = reinterpret_cast<const frozen::attribute_entry *>(base + header.attributes_offset);
+		tables.attribute_count = header.attribute_count;
+		tables.names = reinterpret_cast<const frozen::name_entry *>(base + header.names_offset);
+		tables.name_count = header.name_count;
+		tables.arena = base + header.arena_offset;
+		tables.arena_size = header.arena_size;
+		if (auto * error = validate_entries(tables)) throw_invalid_file(file, error);
+
+		return frozen_document(tables, std::move(mapping), std::move(bindings));
+	}
+
+	frozen_document load_frozen_cached(const std::string & source, const std::string & cache, namespace_bindings_ptr bindings /* = nullptr */)
+	{
+		auto info = source_file_info(source);
+
+		frozen_file_info cached;
+		if (read_frozen_info(cache, cached) and cached.source_size == info.source_size and cached.source_mtime == info.source_mtime)
+		{
+			try
+			{
+				return open_frozen(cache, false, bindings);
+			}
+			catch (std::runtime_error &)
+			{
+				// corrupted cache is rebuilt below
+			}
+		}
+
+		auto doc = load_from_file(source);
+		auto result = freeze(doc.get(), std::move(bindings));
+
+		try
+		{
+			save_frozen(result, cache, info);
+		}
+		catch (std::exception &)
+		{
+			// cache is an optimization, unwritable location should not fail loading
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,367 @@
+﻿#include <algorithm>
+#include <cctype>
+#include <xercesc/xercesc_lazy.hpp>
+
+namespace xercesc_utils
+{
+	namespace
+	{
+		const std::string_view wrapper_name = "xercesc_utils.lazy";
+
+		inline bool is_space(char ch) noexcept
+		{
+			return ch == ' ' or ch == '\t' or ch == '\r' or ch == '\n';
+		}
+
+		inline bool is_name_end(char ch) noexcept
+		{
+			return is_space(ch) or ch == '/' or ch == '>' or ch == '=';
+		}
+
+		inline bool starts_with(std::string_view data, std::size_t pos, std::string_view prefix) noexcept
+		{
+			return data.compare(pos, prefix.size(), prefix) == 0;
+		}
+
+		inline bool iequals(std::string_view a, std::string_view b) noexcept
+		{
+			return a.size() == b.size() and std::equal(a.begin(), a.end(), b.begin(), [](char x, char y)
+			{
+				return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+			});
+		}
+
+		[[noreturn]] void throw_malformed(const char * what, std::size_t offset)
+		{
+			throw std::runtime_error("xercesc_utils::lazy_document: " + std::string(what) + " at offset " + std::to_string(offset));
+		}
+
+		/// position after terminator, which must be present
+		std::size_t skip_to(std::string_view data, std::size_t pos, std::string_view terminator, const char * what)
+		{
+			auto end = data.find(terminator, pos);
+			if (end == data.npos) throw_malformed(what, pos);
+			return end + terminator.size();
+		}
+
+		/// <!DOCTYPE ...> with optional internal subset, quoted literals can contain markup characters
+		std::size_t skip_doctype(std::string_view data, std::size_t pos)
+		{
+			auto start = pos;
+			int brackets = 0;
+			for (; pos < data.size(); ++pos)
+			{
+				char ch = data[pos];
+				if (ch == '"' or ch == '\'')
+				{
+					pos = data.find(ch, pos + 1);
+					if (pos == data.npos) break;
+				}
+				else if (ch == '[') ++brackets;
+				else if (ch == ']') --brackets;
+				else if (ch == '>' and brackets <= 0) return pos + 1;
+			}
+
+			throw_malformed("unterminated declaration", start);
+		}
+
+		/// namespace declaration in start tag: attribute name and its raw text(name="value")
+		struct namespace_declaration
+		{
+			std::string_view name;
+			std::string_view text;
+		};
+
+		/// parses start tag beginning at '<', returns position after '>'
+		std::size_t parse_start_tag(std::string_view data, std::size_t pos, std::string_view & name, bool & empty_element,
+		                            std::vector<namespace_declaration> * declarations)
+		{
+			auto start = pos++;
+			auto name_start = pos;
+			while (pos < data.size() and not is_name_end(data[pos])) ++pos;
+			name = data.substr(name_start, pos - name_start);
+			if (name.empty()) throw_malformed("invalid start tag", start);
+
+			for (;;)
+			{
+				while (pos < data.size() and is_space(data[pos])) ++pos;
+				if (pos >= data.size()) break;
+
+				if (data[pos] == '>')
+				{
+					empty_element = false;
+					return pos + 1;
+				}
+
+				if (data[pos] == '/')
+				{
+					if (pos + 1 >= data.size() or data[pos + 1] != '>') break;
+					empty_element = true;
+					return pos + 2;
+				}
+
+				auto attr_start = pos;
+				while (pos < data.size() and not is_name_end(data[pos])) ++pos;
+				auto attr_name = data.substr(attr_start, pos - attr_start);
+
+				while (pos < data.size() and is_space(data[pos])) ++pos;
+				if (pos >= data.size() or data[pos] != '=' or attr_name.empty()) break;
+				++pos;
+				while (pos < data.size() and is_space(data[pos])) ++pos;
+				if (pos >= data.size() or (data[pos] != '"' and data[pos] != '\'')) break;
+
+				auto value_end = data.find(data[pos], pos + 1);
+				if (value_end == data.npos) break;
+				pos = value_end + 1;
+
+				if (declarations and (attr_name == "xmlns" or starts_with(attr_name, 0, "xmlns:")))
+					declarations->push_back({attr_name, data.substr(attr_start, pos - attr_start)});
+			}
+
+			throw_malformed("invalid start tag", start);
+		}
+
+		/// encoding from xml declaration, empty for utf-8 or when it's not specified
+		std::string declared_encoding(std::string_view declaration)
+		{
+			auto pos = declaration.find("encoding");
+			if (pos == declaration.npos) return {};
+
+			pos = declaration.find_first_of("\"'", pos);
+			if (pos == declaration.npos) return {};
+
+			auto end = declaration.find(declaration[pos], pos + 1);
+			if (end == declaration.npos) return {};
+
+			auto encoding = declaration.substr(pos + 1, end - pos - 1);
+			if (iequals(encoding, "utf-8") or iequals(encoding, "utf8")) return {};
+			if (iequals(encoding.substr(0, 6), "utf-16") or iequals(encoding.substr(0, 3), "ucs") or iequals(encoding.substr(0, 6), "utf-32"))
+				throw std::runtime_error("xercesc_utils::lazy_document: unsupported encoding " + std::string(encoding));
+
+			return std::string(encoding);
+		}
+
+		/// namespace context of open element above indexed depth
+		struct scope
+		{
+			std::uint32_t context;
+			std::vector<namespace_declaration> declarations; // effective declarations, only for scopes with own ones
+			std::size_t owner; // index of scope holding effective declarations
+		};
+	} // 'anonymous' namespace
+
+	lazy_document::lazy_document(std::string_view data, std::shared_ptr<const void> storage, const lazy_index_options & options /* = {} */)
+	    : m_storage(std::move(storage)), m_data(data), m_options(options)
+	{
+		scan();
+		m_loaded.resize(m_records.size());
+	}
+
+	void lazy_document::scan()
+	{
+		auto data = m_data;
+		std::size_t pos = 0;
+
+		if (starts_with(data, 0, "\xEF\xBB\xBF")) pos = 3;
+		else if (starts_with(data, 0, "\xFF\xFE") or starts_with(data, 0, "\xFE\xFF"))
+			throw std::runtime_error("xercesc_utils::lazy_document: unsupported encoding utf-16");
+
+		if (starts_with(data, pos, "<?xml") and pos + 5 < data.size() and is_space(data[pos + 5]))
+		{
+			auto end = skip_to(data, pos, "?>", "unterminated xml declaration");
+			m_encoding = declared_encoding(data.substr(pos, end - pos));
+			pos = end;
+		}
+
+		m_contexts.emplace_back(); // empty context of document element
+
+		const std::size_t indexed_depth = m_options.depth;
+		std::vector<scope> scopes;
+		std::vector<namespace_declaration> declarations;
+		std::size_t depth = 0;   // number of open elements
+		bool root_closed = false;
+
+		while (not root_closed)
+		{
+			auto lt = data.find('<', pos);
+			if (lt == data.npos) break;
+
+			if (starts_with(data, lt, "<?"))
+				pos = skip_to(data, lt + 2, "?>", "unterminated processing instruction");
+			else if (starts_with(data, lt, "<!--"))
+				pos = skip_to(data, lt + 4, "-->", "unterminated comment");
+			else if (starts_with(data, lt, "<![CDATA["))
+				pos = skip_to(data, lt + 9, "]]>", "unterminated CDATA section");
+			else if (starts_with(data, lt, "<!"))
+				pos = skip_doctype(data, lt);
+			else if (starts_with(data, lt, "</"))
+			{
+				pos = skip_to(data, lt + 2, ">", "unterminated end tag");
+				if (not depth) throw_malformed("unexpected end tag", lt);
+
+				--depth;
+				if (depth == indexed_depth) m_records.back().size = pos - m_records.back().offset;
+				if (depth < indexed_depth) scopes.pop_back();
+				root_closed = depth == 0;
+			}
+			else
+			{
+				std::string_view name;
+				bool empty_element;
+				declarations.clear();
+				pos = parse_start_tag(data, lt, name, empty_element, depth < indexed_depth ? &declarations : nullptr);
+
+				auto context = scopes.empty() ? 0 : scopes.back().context;
+				if (not depth) m_root_name = name;
+
+				if (depth == indexed_depth)
+				{
+					m_records.push_back({lt, empty_element ? pos - lt : 0, name, context});
+				}
+				else if (depth < indexed_depth and not empty_element)
+				{
+					scope current;
+					current.context = context;
+					current.owner = scopes.empty() ? 0 : scopes.back().owner;
+
+					if (not declarations.empty())
+					{
+						// ancestors' declarations overridden by own ones
+						if (not scopes.empty()) current.declarations = scopes[current.owner].declarations;
+						for (auto & decl : declarations)
+						{
+							auto it = std::find_if(current.declarations.begin(), current.declarations.end(), [&decl](auto & d) { return d.name == decl.name; });
+							if (it != current.declarations.end()) *it = decl;
+							else current.declarations.push_back(decl);
+						}
+
+						std::string text;
+						for (auto & decl : current.declarations)
+							text.append(1, ' ').append(decl.text);
+
+						current.context = static_cast<std::uint32_t>(m_contexts.size());
+						current.owner = scopes.size();
+						m_contexts.push_back(std::move(text));
+					}
+
+					scopes.push_back(std::move(current));
+				}
+
+				if (not empty_element) ++depth;
+				else root_closed = depth == 0;
+			}
+		}
+
+		if (m_root_name.empty()) throw std::runtime_error("xercesc_utils::lazy_document: document element not found");
+		if (not root_closed) throw_malformed("unterminated document element", data.size());
+	}
+
+	std::size_t lazy_document::find(std::string_view name, std::size_t start /* = 0 */) const noexcept
+	{
+		for (auto i = start; i < m_records.size(); ++i)
+			if (m_records[i].name == name) return i;
+
+		return npos;
+	}
+
+	std::size_t lazy_document::index_memory_size() const noexcept
+	{
+		std::size_t size = m_records.capacity() * sizeof(record) + m_loaded.capacity() * sizeof(m_loaded[0]);
+		for (auto & context : m_contexts) size += sizeof(context) + context.capacity();
+		return size;
+	}
+
+	std::shared_ptr<xercesc::DOMDocument> lazy_document::load(std::size_t index) const
+	{
+		auto & rec = at(index);
+		auto & context = m_contexts[rec.context];
+
+		// record is parsed inside wrapper element, which carries ancestors' namespace declarations
+		std::string text;
+		text.reserve(rec.size + context.size() + m_encoding.size() + 2 * wrapper_name.size() + 64);
+		if (not m_encoding.empty()) text.append("<?xml version=\"1.0\" encoding=\"").append(m_encoding).append("\"?>");
+		text.append(1, '<').append(wrapper_name).append(context).append(1, '>');
+		text.append(m_data.substr(rec.offset, rec.size));
+		text.append("</").append(wrapper_name).append(1, '>');
+
+		std::shared_ptr<xercesc::DOMDocument> doc;
+		try
+		{
+			doc = xercesc_utils::load(text);
+		}
+		catch (std::exception &)
+		{
+			std::throw_with_nested(std::runtime_error("xercesc_utils::lazy_document: failed to load element at offset " + std::to_string(rec.offset)));
+		}
+
+		try
+		{
+			auto * wrapper = doc->getDocumentElement();
+			auto * element = wrapper->getFirstElementChild();
+
+			auto * attrs = wrapper->getAttributes();
+			for (XMLSize_t i = 0, count = attrs->getLength(); i < count; ++i)
+			{
+				auto * attr = static_cast<xercesc::DOMAttr *>(attrs->item(i));
+				if (not element->getAttributeNodeNS(attr->getNamespaceURI(), attr->getLocalName()))
+					element->setAttributeNS(attr->getNamespaceURI(), attr->getName(), attr->getValue());
+			}
+
+			wrapper->removeChild(element);
+			doc->removeChild(wrapper)->release();
+			doc->appendChild(element);
+		}
+		catch (xercesc::DOMException & ex)
+		{
+			std::throw_with_nested(std::runtime_error(xercesc_utils::to_utf8(ex.getMessage())));
+		}
+
+		return doc;
+	}
+
+	xercesc::DOMElement * lazy_document::element(std::size_t index) const
+	{
+		if (index >= m_records.size()) throw std::out_of_range("xercesc_utils::lazy_document::element: index out of range");
+
+		{
+			std::lock_guard lock(m_mutex);
+			if (auto & doc = m_loaded[index]) return doc->getDocumentElement();
+		}
+
+		// parsing is done without lock, concurrent loads of the same record keep the first result
+		auto doc = load(index);
+
+		std::lock_guard lock(m_mutex);
+		auto & loaded = m_loaded[index];
+		if (not loaded) loaded = std::move(doc);
+		return loaded->getDocumentElement();
+	}
+
+	void lazy_document::release(std::size_t index) const
+	{
+		std::shared_ptr<xercesc::DOMDocument> doc;
+		std::lock_guard lock(m_mutex);
+		if (index < m_loaded.size()) doc.swap(m_loaded[index]);
+	}
+
+	void lazy_document::release_all() const
+	{
+		std::vector<std::shared_ptr<xercesc::DOMDocument>> loaded(m_loaded.size());
+		std::lock_guard lock(m_mutex);
+		loaded.swap(m_loaded);
+	}
+
+	std::unique_ptr<lazy_document> open_lazy(const std::string & file, const lazy_index_options & options /* = {} */)
+	{
+		auto mapping = std::make_shared<mapped_file>(file);
+		auto data = mapping->view();
+		return std::make_unique<lazy_document>(data, std::move(mapping), options);
+	}
+
+	std::unique_ptr<lazy_document> open_lazy(const xml_string & file, const lazy_index_options & options /* = {} */)
+	{
+		auto mapping = std::make_shared<mapped_file>(file);
+		auto data = mapping->view();
+		return std::make_unique<lazy_document>(data, std::move(mapping), options);
+	}
+}
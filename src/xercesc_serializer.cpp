@@ -0,0 +1,1144 @@
+﻿#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <streambuf>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <xercesc/xercesc_serializer.hpp>
+#include <boost/predef.h>
+
+#if BOOST_HW_SIMD_X86 >= BOOST_HW_SIMD_X86_SSE2_VERSION
+#include <emmintrin.h>
+#define XERCESC_UTILS_SSE2
+#endif
+
+#if BOOST_COMP_MSVC
+#include <intrin.h>
+#endif
+
+namespace xercesc_utils
+{
+	namespace
+	{
+		const xml_string_view xml_uri   = XERCESC_LIT("http://www.w3.org/XML/1998/namespace");
+		const xml_string_view xmlns_str = XERCESC_LIT("xmlns");
+
+		// utf-16 units are transcoded by blocks into stack buffer, then appended to the output
+		constexpr std::size_t block_size = 256;
+		// max output of one utf-16 unit: "&quot;" - 6 bytes
+		constexpr std::size_t max_expansion = 6;
+
+		inline xml_string_view forward_view(const XMLCh * str)
+		{
+			return str ? xml_string_view(str) : xml_string_view();
+		}
+
+		inline unsigned count_trailing_zeros(unsigned mask)
+		{
+			assert(mask);
+		#if BOOST_COMP_MSVC
+			unsigned long idx;
+			_BitScanForward(&idx, mask);
+			return idx;
+		#else
+			return __builtin_ctz(mask);
+		#endif
+		}
+
+		inline const char * escape_sequence(XMLCh ch, escape_mode mode)
+		{
+			switch (mode)
+			{
+				case escape_mode::text:
+					switch (ch)
+					{
+						case '&':  return "&amp;";
+						case '<':  return "&lt;";
+						case '>':  return "&gt;";
+						case '\r': return "&#xD;";
+						default:   return nullptr;
+					}
+
+				case escape_mode::attribute:
+					switch (ch)
+					{
+						case '&':  return "&amp;";
+						case '<':  return "&lt;";
+						case '"':  return "&quot;";
+						// kept from attribute value normalization on reparse
+						case '\n': return "&#xA;";
+						case '\r': return "&#xD;";
+						case '\t': return "&#x9;";
+						default:   return nullptr;
+					}
+
+				case escape_mode::none:
+				default:
+					return nullptr;
+			}
+		}
+
+		/// copies longest prefix of ascii chars not requiring escaping into out,
+		/// returns pointer past copied prefix
+		const XMLCh * copy_plain(const XMLCh * first, const XMLCh * last, char *& out, escape_mode mode)
+		{
+		#ifdef XERCESC_UTILS_SSE2
+			// 0xFFFF never passes ascii check, so it can be used as "nothing to escape" value
+			short ch1 = mode == escape_mode::none ? -1 : '&';
+			short ch2 = mode == escape_mode::none ? -1 : '<';
+			short ch3 = mode == escape_mode::text ? '>' : mode == escape_mode::attribute ? '"' : -1;
+			short ch4 = mode == escape_mode::none ? -1 : '\r';
+			short ch5 = mode == escape_mode::attribute ? '\n' : -1;
+			short ch6 = mode == escape_mode::attribute ? '\t' : -1;
+
+			const __m128i special1 = _mm_set1_epi16(ch1);
+			const __m128i special2 = _mm_set1_epi16(ch2);
+			const __m128i special3 = _mm_set1_epi16(ch3);
+			const __m128i special4 = _mm_set1_epi16(ch4);
+			const __m128i special5 = _mm_set1_epi16(ch5);
+			const __m128i special6 = _mm_set1_epi16(ch6);
+			const __m128i non_ascii_mask = _mm_set1_epi16(static_cast<short>(0xFF80));
+			const __m128i zero = _mm_setzero_si128();
+
+			while (last - first >= 8)
+			{
+				__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+				__m128i special = _mm_or_si128(_mm_cmpeq_epi16(chars, special1), _mm_cmpeq_epi16(chars, special2));
+				special = _mm_or_si128(special, _mm_cmpeq_epi16(chars, special3));
+				special = _mm_or_si128(special, _mm_or_si128(_mm_cmpeq_epi16(chars, special4), _mm_cmpeq_epi16(chars, special5)));
+				special = _mm_or_si128(special, _mm_cmpeq_epi16(chars, special6));
+				__m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(chars, non_ascii_mask), zero);
+
+				unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_andnot_si128(special, ascii))) ^ 0xFFFFu;
+				if (mask == 0)
+				{
+					_mm_storel_epi64(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(chars, chars));
+					out += 8, first += 8;
+					continue;
+				}
+
+				// each utf-16 unit gives 2 mask bits
+				auto n = count_trailing_zeros(mask) / 2;
+				for (auto * stop = first + n; first != stop; ++first)
+					*out++ = static_cast<char>(*first);
+
+				return first;
+			}
+		#endif
+
+			for (; first < last; ++first)
+			{
+				XMLCh ch = *first;
+				if (ch >= 0x80 or escape_sequence(ch, mode)) break;
+				*out++ = static_cast<char>(ch);
+			}
+
+			return first;
+		}
+
+		inline bool is_space(XMLCh ch)
+		{
+			return ch == ' ' or ch == '\t' or ch == '\r' or ch == '\n';
+		}
+
+		inline bool is_element(const xercesc::DOMNode * node)
+		{
+			return node->getNodeType() == xercesc::DOMNode::ELEMENT_NODE;
+		}
+
+		/// Attribute value is a single text node(or nothing), getValue returns it without allocations.
+		/// Value of several nodes(text and entity references created via DOM) is concatenated by getValue
+		/// into document string pool, so it's read from child nodes instead: concurrent readers must not touch document heap.
+		inline bool is_simple_value(const xercesc::DOMAttr * attr)
+		{
+			auto * child = attr->getFirstChild();
+			return not child or (not child->getNextSibling() and child->getNodeType() == xercesc::DOMNode::TEXT_NODE);
+		}
+
+		/// text of attribute child nodes, as DOMAttr::getValue builds it
+		void collect_value(const xercesc::DOMAttr * attr, xml_string & value)
+		{
+			const xercesc::DOMNode * node = attr->getFirstChild();
+			while (node)
+			{
+				if (node->getNodeType() == xercesc::DOMNode::TEXT_NODE)
+					value += forward_view(node->getNodeValue());
+				else if (auto * child = node->getFirstChild())
+				{
+					node = child;
+					continue;
+				}
+
+				while (not node->getNextSibling())
+				{
+					node = node->getParentNode();
+					if (node == attr) return;
+				}
+
+				node = node->getNextSibling();
+			}
+		}
+
+		/// prefix declared by namespace declaration attribute, false if attribute is not xmlns one
+		bool xmlns_prefix(const xercesc::DOMAttr * attr, xml_string_view & prefix)
+		{
+			// check by name, DOM level 1 attributes set via setAttribute do not have namespace uri
+			auto name = forward_view(attr->getNodeName());
+			if (name.compare(0, xmlns_str.size(), xmlns_str) != 0) return false;
+
+			if (name.size() == xmlns_str.size())
+			{
+				prefix = xml_string_view();
+				return true;
+			}
+
+			if (name[xmlns_str.size()] != ':') return false;
+			prefix = name.substr(xmlns_str.size() + 1);
+			return true;
+		}
+	} // 'anonymous' namespace
+
+	/************************************************************************/
+	/*                         utf8_output                                  */
+	/************************************************************************/
+	utf8_output::utf8_output(xercesc::XMLFormatTarget & target, std::size_t buffer_size /* = default_buffer_size */)
+	    : m_buffer(&m_own), m_target(&target), m_buffer_size(std::max<std::size_t>(buffer_size, 1))
+	{
+		m_own.reserve(m_buffer_size + block_size * max_expansion);
+	}
+
+	utf8_output::utf8_output(std::streambuf & sb, std::size_t buffer_size /* = default_buffer_size */)
+	    : m_buffer(&m_own), m_sb(&sb), m_buffer_size(std::max<std::size_t>(buffer_size, 1))
+	{
+		m_own.reserve(m_buffer_size + block_size * max_expansion);
+	}
+
+	void utf8_output::write_through(const char * data, std::size_t size)
+	{
+		if (m_target)
+			m_target->writeChars(reinterpret_cast<const XMLByte *>(data), size, nullptr);
+		else if (m_sb)
+		{
+			auto written = m_sb->sputn(data, size);
+			if (static_cast<std::size_t>(written) < size)
+				throw std::runtime_error("xercesc_utils::utf8_output: failed to write to std::streambuf");
+		}
+	}
+
+	void utf8_output::overflow()
+	{
+		if (m_buffer->empty() or m_buffer != &m_own) return;
+
+		write_through(m_buffer->data(), m_buffer->size());
+		m_buffer->clear();
+	}
+
+	void utf8_output::flush()
+	{
+		overflow();
+
+		if (m_target)
+			m_target->flush();
+		else if (m_sb and m_sb->pubsync() != 0)
+			throw std::runtime_error("xercesc_utils::utf8_output: failed to sync std::streambuf");
+	}
+
+	void utf8_output::append(std::string_view str)
+	{
+		if (str.empty()) return;
+
+		m_last_char = str.back();
+		// big blocks(e.g. chunks serialized elsewhere) are written into target without copying into buffer
+		if (m_buffer_size and str.size() >= m_buffer_size)
+		{
+			overflow();
+			write_through(str.data(), str.size());
+			return;
+		}
+
+		m_buffer->append(str.data(), str.size());
+		check_overflow();
+	}
+
+	void utf8_output::append_escaped(std::string_view str, escape_mode mode)
+	{
+		auto first = str.begin();
+		auto last  = str.end();
+
+		while (first != last)
+		{
+			auto it = std::find_if(first, last, [mode](char ch) { return escape_sequence(static_cast<unsigned char>(ch), mode) != nullptr; });
+			m_buffer->append(first, it);
+			if (it == last) break;
+
+			m_buffer->append(escape_sequence(static_cast<unsigned char>(*it), mode));
+			first = ++it;
+		}
+
+		if (not m_buffer->empty()) m_last_char = m_buffer->back();
+		check_overflow();
+	}
+
+	void utf8_output::append(const XMLCh * first, const XMLCh * last, escape_mode mode)
+	{
+		// +4: surrogate pair can cross block boundary
+		char buffer[block_size * max_expansion + 4];
+
+		while (first < last)
+		{
+			char * out = buffer;
+			auto * block_last = first + std::min<std::size_t>(block_size, last - first);
+
+			while (first < block_last)
+			{
+				first = copy_plain(first, block_last, out, mode);
+				if (first >= block_last) break;
+
+				XMLCh ch = *first++;
+				if (ch < 0x80)
+				{
+					auto * seq = escape_sequence(ch, mode);
+					assert(seq);
+
+					auto len = std::strlen(seq);
+					std::memcpy(out, seq, len);
+					out += len;
+				}
+				else if (ch < 0x800)
+				{
+					*out++ = static_cast<char>(0xC0 | (ch >> 6));
+					*out++ = static_cast<char>(0x80 | (ch & 0x3F));
+				}
+				else if (ch >= 0xD800 and ch < 0xDC00 and first < last and *first >= 0xDC00 and *first < 0xE000)
+				{
+					char32_t cp = 0x10000 + ((char32_t(ch) - 0xD800) << 10) + (char32_t(*first++) - 0xDC00);
+					*out++ = static_cast<char>(0xF0 | (cp >> 18));
+					*out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+					*out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+					*out++ = static_cast<char>(0x80 | (cp & 0x3F));
+				}
+				else
+				{
+					// lone surrogate can't be represented in utf-8, replace with U+FFFD
+					if (ch >= 0xD800 and ch < 0xE000) ch = 0xFFFD;
+
+					*out++ = static_cast<char>(0xE0 | (ch >> 12));
+					*out++ = static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+					*out++ = static_cast<char>(0x80 | (ch & 0x3F));
+				}
+			}
+
+			if (out != buffer)
+			{
+				m_buffer->append(buffer, out - buffer);
+				m_last_char = out[-1];
+			}
+		}
+
+		check_overflow();
+	}
+
+	/************************************************************************/
+	/*                      dom_utf8_serializer                             */
+	/************************************************************************/
+	dom_utf8_serializer::dom_utf8_serializer(utf8_output & out, save_option save_option /* = pretty_print */)
+	    : m_out(&out), m_pretty(save_option == pretty_print)
+	{
+		m_bindings.reserve(16);
+		m_scopes.reserve(32);
+	}
+
+	void dom_utf8_serializer::new_line(unsigned level)
+	{
+		if (not m_pretty) return;
+
+		if (not m_out->at_line_start())
+			m_out->append('\n');
+
+		for (unsigned i = 0; i < level; ++i)
+			m_out->append("  ");
+	}
+
+	void dom_utf8_serializer::bind_namespace(xml_string_view prefix, xml_string_view uri)
+	{
+		m_bindings.emplace_back(prefix, uri);
+	}
+
+	auto dom_utf8_serializer::lookup_namespace(xml_string_view prefix) const -> const xml_string_view *
+	{
+		for (auto it = m_bindings.rbegin(); it != m_bindings.rend(); ++it)
+			if (it->first == prefix) return &it->second;
+
+		return nullptr;
+	}
+
+	bool dom_utf8_serializer::is_bound(xml_string_view prefix, xml_string_view uri) const
+	{
+		if (auto * bound = lookup_namespace(prefix))
+			return *bound == uri;
+
+		// implicit bindings
+		if (prefix.empty()) return uri.empty();
+		if (prefix == XERCESC_LIT("xml")) return uri == xml_uri;
+		return false;
+	}
+
+	bool dom_utf8_serializer::find_prefix(xml_string_view uri, xml_string_view & prefix) const
+	{
+		for (auto it = m_bindings.rbegin(); it != m_bindings.rend(); ++it)
+		{
+			// prefix can be rebound to other namespace by inner element
+			if (it->first.empty() or it->second != uri or not is_bound(it->first, uri)) continue;
+
+			prefix = it->first;
+			return true;
+		}
+
+		return false;
+	}
+
+	xml_string_view dom_utf8_serializer::unused_prefix()
+	{
+		for (unsigned index = 1;; ++index)
+		{
+			auto prefix = to_xmlch("ns" + std::to_string(index));
+			if (not lookup_namespace(prefix)) return m_strings.emplace_back(std::move(prefix));
+		}
+	}
+
+	void dom_utf8_serializer::write_namespace_declaration(xml_string_view prefix, xml_string_view uri)
+	{
+		bind_namespace(prefix, uri);
+
+		m_out->append(" xmlns");
+		if (not prefix.empty())
+		{
+			m_out->append(':');
+			m_out->append(prefix, escape_mode::none);
+		}
+
+		m_out->append("=\"");
+		m_out->append(uri, escape_mode::attribute);
+		m_out->append('"');
+	}
+
+	void dom_utf8_serializer::write_attributes(const xercesc::DOMElement * element)
+	{
+		auto * attrs = element->getAttributes();
+		XMLSize_t count = attrs ? attrs->getLength() : 0;
+
+		// first register declarations present as attributes, they are written in place below
+		xml_string_view prefix;
+		for (XMLSize_t i = 0; i < count; ++i)
+		{
+			auto * attr = static_cast<const xercesc::DOMAttr *>(attrs->item(i));
+			if (not xmlns_prefix(attr, prefix)) continue;
+
+			if (is_simple_value(attr))
+				bind_namespace(prefix, forward_view(attr->getValue()));
+			else
+			{
+				collect_value(attr, m_strings.emplace_back());
+				bind_namespace(prefix, m_strings.back());
+			}
+		}
+
+		// element namespace fixup
+		auto element_ns = forward_view(element->getNamespaceURI());
+		auto element_prefix = forward_view(element->getPrefix());
+		if (not element_ns.empty())
+		{
+			if (not is_bound(element_prefix, element_ns))
+				write_namespace_declaration(element_prefix, element_ns);
+		}
+		else if (element->getLocalName() and not is_bound(xml_string_view(), xml_string_view()))
+		{
+			// namespace aware element without namespace inside default namespace scope - undeclare it
+			write_namespace_declaration(xml_string_view(), xml_string_view());
+		}
+
+		for (XMLSize_t i = 0; i < count; ++i)
+		{
+			auto * attr = static_cast<const xercesc::DOMAttr *>(attrs->item(i));
+			if (not attr->getSpecified()) continue;
+
+			auto name = forward_view(attr->getNodeName());
+			auto attr_ns = forward_view(attr->getNamespaceURI());
+			auto attr_prefix = forward_view(attr->getPrefix());
+
+			// unprefixed attributes are not in default namespace, namespaced attribute without prefix needs one,
+			// as well as attribute which prefix is bound to other namespace(by this element or its ancestors)
+			if (not attr_ns.empty() and not xmlns_prefix(attr, prefix) and (attr_prefix.empty() or not is_bound(attr_prefix, attr_ns)))
+			{
+				if (attr_ns == xml_uri)
+					prefix = XERCESC_LIT("xml");
+				else if (not attr_prefix.empty() and not lookup_namespace(attr_prefix) and attr_prefix != XERCESC_LIT("xml"))
+					write_namespace_declaration(prefix = attr_prefix, attr_ns);
+				else if (not find_prefix(attr_ns, prefix))
+					write_namespace_declaration(prefix = unused_prefix(), attr_ns);
+
+				name = xml_string_view();
+			}
+
+			m_out->append(' ');
+			if (not name.empty())
+				m_out->append(name, escape_mode::none);
+			else
+			{
+				m_out->append(prefix, escape_mode::none);
+				m_out->append(':');
+				m_out->append(forward_view(attr->getLocalName()), escape_mode::none);
+			}
+
+			m_out->append("=\"");
+			write_attribute_value(attr);
+			m_out->append('"');
+		}
+	}
+
+	void dom_utf8_serializer::write_attribute_value(const xercesc::DOMAttr * attr)
+	{
+		if (is_simple_value(attr))
+			return m_out->append(forward_view(attr->getValue()), escape_mode::attribute);
+
+		// as DOMLSSerializer with entities feature: entity references are kept
+		for (auto * child = attr->getFirstChild(); child; child = child->getNextSibling())
+		{
+			switch (child->getNodeType())
+			{
+				case xercesc::DOMNode::TEXT_NODE:
+					m_out->append(forward_view(child->getNodeValue()), escape_mode::attribute);
+					break;
+
+				case xercesc::DOMNode::ENTITY_REFERENCE_NODE:
+					m_out->append('&');
+					m_out->append(forward_view(child->getNodeName()), escape_mode::none);
+					m_out->append(';');
+					break;
+
+				default:
+					break;
+			}
+		}
+	}
+
+	void dom_utf8_serializer::write_start_tag(const xercesc::DOMElement * element, unsigned level)
+	{
+		new_line(level);
+		m_out->append('<');
+		m_out->append(forward_view(element->getNodeName()), escape_mode::none);
+
+		m_scopes.push_back(m_bindings.size());
+		write_attributes(element);
+
+		m_out->append('>');
+		m_prev_text = false;
+	}
+
+	void dom_utf8_serializer::write_end_tag(const xercesc::DOMElement * element, unsigned level)
+	{
+		// element with only text content is kept on one line
+		if (not m_prev_text) new_line(level);
+
+		m_out->append("</");
+		m_out->append(forward_view(element->getNodeName()), escape_mode::none);
+		m_out->append('>');
+
+		assert(not m_scopes.empty());
+		m_bindings.resize(m_scopes.back());
+		m_scopes.pop_back();
+		m_prev_text = false;
+	}
+
+	void dom_utf8_serializer::write_declaration(const xercesc::DOMDocument * doc)
+	{
+		auto * version = doc->getXmlVersion();
+		m_out->append("<?xml version=\"");
+		m_out->append(forward_view(version ? version : XERCESC_LIT("1.0")), escape_mode::none);
+		m_out->append("\" encoding=\"utf-8\" standalone=\"");
+		m_out->append(doc->getXmlStandalone() ? "yes" : "no");
+		m_out->append("\" ?>");
+	}
+
+	void dom_utf8_serializer::finish_document()
+	{
+		if (m_pretty and not m_out->at_line_start())
+			m_out->append('\n');
+	}
+
+	void dom_utf8_serializer::write_document(const xercesc::DOMDocument * doc, bool xml_declaration /* = true */)
+	{
+		if (xml_declaration) write_declaration(doc);
+
+		for (auto * child = doc->getFirstChild(); child; child = child->getNextSibling())
+			write(child, 0);
+
+		finish_document();
+	}
+
+	void dom_utf8_serializer::write_leaf(const xercesc::DOMNode * node, unsigned level)
+	{
+		using xercesc::DOMNode;
+
+		switch (node->getNodeType())
+		{
+			case DOMNode::ELEMENT_NODE:
+			{
+				// element without children
+				auto * element = static_cast<const xercesc::DOMElement *>(node);
+				new_line(level);
+				m_out->append('<');
+				m_out->append(forward_view(element->getNodeName()), escape_mode::none);
+
+				m_scopes.push_back(m_bindings.size());
+				write_attributes(element);
+				m_bindings.resize(m_scopes.back());
+				m_scopes.pop_back();
+
+				m_out->append("/>");
+				m_prev_text = false;
+				return;
+			}
+
+			case DOMNode::TEXT_NODE:
+			{
+				auto text = forward_view(node->getNodeValue());
+				// whitespace only text nodes are replaced by pretty print formatting
+				if (m_pretty and std::all_of(text.begin(), text.end(), is_space))
+					return;
+
+				m_out->append(text, escape_mode::text);
+				m_prev_text = true;
+				return;
+			}
+
+			case DOMNode::CDATA_SECTION_NODE:
+			{
+				static const xml_string_view cdata_end = XERCESC_LIT("]]>");
+				auto text = forward_view(node->getNodeValue());
+
+				m_out->append("<![CDATA[");
+				// split sections containing terminating sequence
+				for (auto pos = text.find(cdata_end); pos != text.npos; pos = text.find(cdata_end))
+				{
+					m_out->append(text.substr(0, pos + 2), escape_mode::none);
+					m_out->append("]]><![CDATA[");
+					text.remove_prefix(pos + 2);
+				}
+
+				m_out->append(text, escape_mode::none);
+				m_out->append("]]>");
+				m_prev_text = true;
+				return;
+			}
+
+			case DOMNode::ENTITY_REFERENCE_NODE:
+				m_out->append('&');
+				m_out->append(forward_view(node->getNodeName()), escape_mode::none);
+				m_out->append(';');
+				m_prev_text = true;
+				return;
+
+			case DOMNode::COMMENT_NODE:
+				new_line(level);
+				m_out->append("<!--");
+				m_out->append(forward_view(node->getNodeValue()), escape_mode::none);
+				m_out->append("-->");
+				m_prev_text = false;
+				return;
+
+			case DOMNode::PROCESSING_INSTRUCTION_NODE:
+			{
+				auto * pi = static_cast<const xercesc::DOMProcessingInstruction *>(node);
+				auto data = forward_view(pi->getData());
+
+				new_line(level);
+				m_out->append("<?");
+				m_out->append(forward_view(pi->getTarget()), escape_mode::none);
+				if (not data.empty())
+				{
+					m_out->append(' ');
+					m_out->append(data, escape_mode::none);
+				}
+
+				m_out->append("?>");
+				m_prev_text = false;
+				return;
+			}
+
+			case DOMNode::DOCUMENT_TYPE_NODE:
+			{
+				auto * doctype = static_cast<const xercesc::DOMDocumentType *>(node);
+				auto public_id = forward_view(doctype->getPublicId());
+				auto system_id = forward_view(doctype->getSystemId());
+				auto internal  = forward_view(doctype->getInternalSubset());
+
+				new_line(level);
+				m_out->append("<!DOCTYPE ");
+				m_out->append(forward_view(doctype->getName()), escape_mode::none);
+				if (not public_id.empty())
+				{
+					m_out->append(" PUBLIC \"");
+					m_out->append(public_id, escape_mode::none);
+					m_out->append("\" \"");
+					m_out->append(system_id, escape_mode::none);
+					m_out->append('"');
+				}
+				else if (not system_id.empty())
+				{
+					m_out->append(" SYSTEM \"");
+					m_out->append(system_id, escape_mode::none);
+					m_out->append('"');
+				}
+
+				if (not internal.empty())
+				{
+					m_out->append(" [");
+					m_out->append(internal, escape_mode::none);
+					m_out->append(']');
+				}
+
+				m_out->append('>');
+				m_prev_text = false;
+				return;
+			}
+
+			case DOMNode::DOCUMENT_NODE:
+				return write_document(static_cast<const xercesc::DOMDocument *>(node), true);
+
+			case DOMNode::DOCUMENT_FRAGMENT_NODE:
+				for (auto * child = node->getFirstChild(); child; child = child->getNextSibling())
+					write(child, level);
+				return;
+
+			// attributes are written with elements, entities and notations are part of doctype
+			case DOMNode::ATTRIBUTE_NODE:
+			case DOMNode::ENTITY_NODE:
+			case DOMNode::NOTATION_NODE:
+			default:
+				return;
+		}
+	}
+
+	void dom_utf8_serializer::write(const xercesc::DOMNode * node, unsigned level /* = 0 */)
+	{
+		if (not node) throw std::invalid_argument("xercesc_utils::dom_utf8_serializer::write: node is null");
+
+		// iterative pre-order traversal: descend into elements with children, climb up writing end tags
+		const xercesc::DOMNode * root = node;
+		for (;;)
+		{
+			if (is_element(node) and node->getFirstChild())
+			{
+				write_start_tag(static_cast<const xercesc::DOMElement *>(node), level);
+				node = node->getFirstChild();
+				++level;
+				continue;
+			}
+
+			write_leaf(node, level);
+
+			while (node != root and not node->getNextSibling())
+			{
+				node = node->getParentNode();
+				write_end_tag(static_cast<const xercesc::DOMElement *>(node), --level);
+			}
+
+			if (node == root) break;
+			node = node->getNextSibling();
+		}
+	}
+
+	/************************************************************************/
+	/*                  streaming_document_writer                           */
+	/************************************************************************/
+	streaming_document_writer::streaming_document_writer(utf8_output & out, const xercesc::DOMElement * root, save_option save_option /* = pretty_print */, bool xml_declaration /* = true */)
+	    : m_out(&out), m_serializer(out, save_option), m_root(root)
+	{
+		start(xml_declaration);
+	}
+
+	streaming_document_writer::streaming_document_writer(xercesc::XMLFormatTarget & target, const xercesc::DOMElement * root, save_option save_option /* = pretty_print */, bool xml_declaration /* = true */)
+	    : m_own_output(std::in_place, target), m_out(&*m_own_output), m_serializer(*m_out, save_option), m_root(root)
+	{
+		start(xml_declaration);
+	}
+
+	streaming_document_writer::streaming_document_writer(std::streambuf & sb, const xercesc::DOMElement * root, save_option save_option /* = pretty_print */, bool xml_declaration /* = true */)
+	    : m_own_output(std::in_place, sb), m_out(&*m_own_output), m_serializer(*m_out, save_option), m_root(root)
+	{
+		start(xml_declaration);
+	}
+
+	void streaming_document_writer::start(bool xml_declaration)
+	{
+		if (not m_root) throw std::invalid_argument("xercesc_utils::streaming_document_writer: root is null");
+
+		auto * parent = m_root->getParentNode();
+		if (parent and parent->getNodeType() == xercesc::DOMNode::DOCUMENT_NODE)
+		{
+			// same sequence as write_document up to root start tag
+			if (xml_declaration) m_serializer.write_declaration(static_cast<const xercesc::DOMDocument *>(parent));
+			for (auto * child = parent->getFirstChild(); child != m_root; child = child->getNextSibling())
+				m_serializer.write(child, 0);
+		}
+
+		m_serializer.write_start_tag(m_root, 0);
+
+		// children root already has go first, as in native_save of whole document
+		for (auto * child = m_root->getFirstChild(); child; child = child->getNextSibling())
+			m_serializer.write(child, 1);
+	}
+
+	void streaming_document_writer::write_copy(const xercesc::DOMNode * node)
+	{
+		if (not node) throw std::invalid_argument("xercesc_utils::streaming_document_writer::write: node is null");
+		if (m_finished) throw std::logic_error("xercesc_utils::streaming_document_writer::write: document is already finished");
+
+		m_serializer.write(node, 1);
+	}
+
+	void streaming_document_writer::write(xercesc::DOMNode * node)
+	{
+		if (node == m_root) throw std::invalid_argument("xercesc_utils::streaming_document_writer::write: can't release root");
+		write_copy(node);
+
+		if (auto * parent = node->getParentNode())
+			parent->removeChild(node);
+
+		// released elements must not stay in namespace cache
+		invalidate_namespace_cache(m_root);
+		node->release();
+	}
+
+	void streaming_document_writer::finish()
+	{
+		if (m_finished) return;
+
+		m_serializer.write_end_tag(m_root, 0);
+
+		auto * parent = m_root->getParentNode();
+		if (parent and parent->getNodeType() == xercesc::DOMNode::DOCUMENT_NODE)
+		{
+			for (auto * child = m_root->getNextSibling(); child; child = child->getNextSibling())
+				m_serializer.write(child, 0);
+
+			m_serializer.finish_document();
+		}
+
+		m_out->flush();
+		m_finished = true;
+	}
+
+	/************************************************************************/
+	/*                       native save/print                              */
+	/************************************************************************/
+	std::string native_save(xercesc::DOMDocument * doc, save_option save_option /* = pretty_print */)
+	{
+		std::string result;
+		native_save(result, doc, save_option);
+		return result;
+	}
+
+	void native_save(std::string & str, xercesc::DOMDocument * doc, save_option save_option /* = pretty_print */)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::native_save: document is null");
+
+		utf8_output out(str);
+		dom_utf8_serializer serializer(out, save_option);
+		serializer.write_document(doc);
+	}
+
+	void native_save(std::streambuf & sb, xercesc::DOMDocument * doc, save_option save_option /* = pretty_print */)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::native_save: document is null");
+
+		utf8_output out(sb);
+		dom_utf8_serializer serializer(out, save_option);
+		serializer.write_document(doc);
+		out.flush();
+	}
+
+	void native_save(xercesc::XMLFormatTarget & target, xercesc::DOMDocument * doc, save_option save_option /* = pretty_print */)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::native_save: document is null");
+
+		utf8_output out(target);
+		dom_utf8_serializer serializer(out, save_option);
+		serializer.write_document(doc);
+		out.flush();
+	}
+
+	void native_save_to_file(xercesc::DOMDocument * doc, const std::string & file, save_option save_option /* = pretty_print */)
+	{
+		return native_save_to_file(doc, file, file_target_options(), save_option);
+	}
+
+	void native_save_to_file(xercesc::DOMDocument * doc, const std::string & file, const file_target_options & options, save_option save_option /* = pretty_print */)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::native_save_to_file: document is null");
+
+		file_target target(file, options);
+		native_save(target, doc, save_option);
+		target.commit();
+	}
+
+	std::string native_print(xercesc::DOMElement * element, save_option save_option /* = pretty_print */)
+	{
+		std::string result;
+		native_print(result, element, save_option);
+		return result;
+	}
+
+	void native_print(std::string & str, xercesc::DOMElement * element, save_option save_option /* = pretty_print */)
+	{
+		if (not element) throw std::invalid_argument("xercesc_utils::native_print: element is null");
+
+		utf8_output out(str);
+		dom_utf8_serializer serializer(out, save_option);
+		serializer.write(element);
+	}
+
+	/************************************************************************/
+	/*                    parallel native save                              */
+	/************************************************************************/
+	namespace
+	{
+		// batches per worker thread: smooths out different subtree sizes
+		constexpr std::size_t batches_per_thread = 8;
+		// how many batches workers can run ahead of the writer, per worker thread
+		constexpr std::size_t batches_ahead_per_thread = 4;
+
+		struct parallel_batch
+		{
+			std::size_t first, last; // range of document element children
+			std::string data;
+			bool after_text = false;
+			bool done = false;
+			std::exception_ptr error;
+		};
+
+		class parallel_saver
+		{
+			using bindings_type = std::vector<std::pair<xml_string_view, xml_string_view>>;
+
+			save_option m_option;
+			const bindings_type * m_bindings;
+			std::vector<const xercesc::DOMNode *> m_children;
+			std::vector<parallel_batch> m_batches;
+			std::size_t m_max_ahead;
+
+			std::mutex m_mutex;
+			std::condition_variable m_cond;
+			std::size_t m_next = 0;    // next batch to be taken by worker
+			std::size_t m_written = 0; // batches written by writer
+			bool m_stop = false;
+
+		private:
+			void serialize(const parallel_batch & batch, utf8_output & out, bool & after_text) const
+			{
+				dom_utf8_serializer serializer(out, m_option);
+				for (auto & binding : *m_bindings)
+					serializer.bind_namespace(binding.first, binding.second);
+
+				serializer.set_after_text(after_text);
+				for (auto i = batch.first; i < batch.last; ++i)
+					serializer.write(m_children[i], 1);
+
+				after_text = serializer.after_text();
+			}
+
+			void worker()
+			{
+				for (;;)
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_cond.wait(lock, [this] { return m_stop or m_next >= m_batches.size() or m_next < m_written + m_max_ahead; });
+					if (m_stop or m_next >= m_batches.size()) return;
+
+					auto & batch = m_batches[m_next++];
+					lock.unlock();
+
+					try
+					{
+						// batch continues output after some element, not at line start
+						utf8_output out(batch.data);
+						out.set_line_start(false);
+						serialize(batch, out, batch.after_text);
+					}
+					catch (...)
+					{
+						batch.error = std::current_exception();
+					}
+
+					lock.lock();
+					batch.done = true;
+					m_cond.notify_all();
+				}
+			}
+
+			void write_batches(dom_utf8_serializer & serializer)
+			{
+				auto & out = serializer.output();
+				bool after_text = serializer.after_text();
+
+				for (auto & batch : m_batches)
+				{
+					{
+						std::unique_lock<std::mutex> lock(m_mutex);
+						m_cond.wait(lock, [&batch] { return batch.done; });
+					}
+
+					if (batch.error) std::rethrow_exception(batch.error);
+
+					// batch of whitespace only text nodes, state is not changed
+					if (not batch.data.empty())
+					{
+						if (m_option == pretty_print and out.at_line_start())
+						{
+							// previous batch ended with text ending with new line, indentation of first node differs -
+							// rare case, serialize again in place
+							serialize(batch, out, after_text);
+						}
+						else
+						{
+							out.append(batch.data);
+							after_text = batch.after_text;
+						}
+					}
+
+					std::string().swap(batch.data);
+
+					std::lock_guard<std::mutex> lock(m_mutex);
+					++m_written;
+					m_cond.notify_all();
+				}
+
+				serializer.set_after_text(after_text);
+			}
+
+		public:
+			void run(dom_utf8_serializer & serializer, unsigned nthreads)
+			{
+				std::vector<std::thread> workers;
+				workers.reserve(nthreads);
+
+				auto stop = [this, &workers]
+				{
+					{
+						std::lock_guard<std::mutex> lock(m_mutex);
+						m_stop = true;
+					}
+
+					m_cond.notify_all();
+					for (auto & worker : workers) worker.join();
+				};
+
+				try
+				{
+					for (unsigned i = 0; i < nthreads; ++i)
+						workers.emplace_back(&parallel_saver::worker, this);
+
+					write_batches(serializer);
+				}
+				catch (...)
+				{
+					stop();
+					throw;
+				}
+
+				stop();
+			}
+
+			parallel_saver(const xercesc::DOMElement * root, const bindings_type & bindings, save_option save_option, unsigned nthreads)
+			    : m_option(save_option), m_bindings(&bindings), m_max_ahead(std::size_t(nthreads) * batches_ahead_per_thread)
+			{
+				for (auto * child = root->getFirstChild(); child; child = child->getNextSibling())
+					m_children.push_back(child);
+
+				auto count = std::min(m_children.size(), std::size_t(nthreads) * batches_per_thread);
+				m_batches.resize(count);
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					m_batches[i].first = i * m_children.size() / count;
+					m_batches[i].last  = (i + 1) * m_children.size() / count;
+				}
+			}
+		};
+
+		void save_parallel(utf8_output & out, const xercesc::DOMDocument * doc, save_option save_option, unsigned nthreads)
+		{
+			if (nthreads == 0) nthreads = std::max(1u, std::thread::hardware_concurrency());
+
+			dom_utf8_serializer serializer(out, save_option);
+			auto * root = doc->getDocumentElement();
+			if (nthreads < 2 or not root or not root->getFirstChild() or not root->getFirstChild()->getNextSibling())
+				return serializer.write_document(doc);
+
+			// same sequence as write_document, with document element children written by parallel_saver
+			serializer.write_declaration(doc);
+			for (auto * child = doc->getFirstChild(); child != root; child = child->getNextSibling())
+				serializer.write(child, 0);
+
+			serializer.write_start_tag(root, 0);
+			// bindings are not modified until end tag, workers share them
+			parallel_saver saver(root, serializer.namespace_bindings(), save_option, nthreads);
+			saver.run(serializer, nthreads);
+			serializer.write_end_tag(root, 0);
+
+			for (auto * child = root->getNextSibling(); child; child = child->getNextSibling())
+				serializer.write(child, 0);
+
+			serializer.finish_document();
+		}
+	} // 'anonymous' namespace
+
+	std::string native_save_parallel(xercesc::DOMDocument * doc, save_option save_option /* = pretty_print */, unsigned nthreads /* = 0 */)
+	{
+		std::string result;
+		native_save_parallel(result, doc, save_option, nthreads);
+		return result;
+	}
+
+	void native_save_parallel(std::string & str, xercesc::DOMDocument * doc, save_option save_option /* = pretty_print */, unsigned nthreads /* = 0 */)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::native_save_parallel: document is null");
+
+		utf8_output out(str);
+		save_parallel(out, doc, save_option, nthreads);
+	}
+
+	void native_save_parallel(std::streambuf & sb, xercesc::DOMDocument * doc, save_option save_option /* = pretty_print */, unsigned nthreads /* = 0 */)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::native_save_parallel: document is null");
+
+		utf8_output out(sb);
+		save_parallel(out, doc, save_option, nthreads);
+		out.flush();
+	}
+
+	void native_save_parallel(xercesc::XMLFormatTarget & target, xercesc::DOMDocument * doc, save_option save_option /* = pretty_print */, unsigned nthreads /* = 0 */)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::native_save_parallel: document is null");
+
+		utf8_output out(target);
+		save_parallel(out, doc, save_option, nthreads);
+		out.flush();
+	}
+
+	void native_save_to_file_parallel(xercesc::DOMDocument * doc, const std::string & file, save_option save_option /* = pretty_print */, unsigned nthreads /* = 0 */)
+	{
+		return native_save_to_file_parallel(doc, file, file_target_options(), save_option, nthreads);
+	}
+
+	void native_save_to_file_parallel(xercesc::DOMDocument * doc, const std::string & file, const file_target_options & options, save_option save_option /* = pretty_print */, unsigned nthreads /* = 0 */)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::native_save_to_file_parallel: document is null");
+
+		file_target target(file, options);
+		native_save_parallel(target, doc, save_option, nthreads);
+		target.commit();
+	}
+}
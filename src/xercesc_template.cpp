@@ -0,0 +1,269 @@
+﻿#include <algorithm>
+#include <xercesc/xercesc_template.hpp>
+
+namespace xercesc_utils
+{
+	namespace
+	{
+		// U+E000 index U+E001 in utf-8
+		const std::string_view slot_start = "\xEE\x80\x80";
+		const std::string_view slot_end   = "\xEE\x80\x81";
+
+		std::string slot_marker(std::size_t index)
+		{
+			std::string marker(slot_start);
+			marker += std::to_string(index);
+			marker += slot_end;
+			return marker;
+		}
+
+		bool is_prefix(const std::vector<std::size_t> & route, const std::vector<std::size_t> & other) noexcept
+		{
+			return route.size() <= other.size() and std::equal(route.begin(), route.end(), other.begin());
+		}
+	}
+
+	document_template::document_template(const xercesc::DOMDocument * skeleton, const std::vector<std::string> & slots,
+	                                     save_option save_option /* = pretty_print */, bool xml_declaration /* = true */)
+	{
+		if (not skeleton) throw std::invalid_argument("xercesc_utils::document_template: skeleton is null");
+
+		try
+		{
+			m_skeleton.reset(static_cast<xercesc::DOMDocument *>(skeleton->cloneNode(true)), xercesc_release_deleter());
+		}
+		catch (xercesc::DOMException & ex)
+		{
+			std::throw_with_nested(std::runtime_error(xercesc_utils::to_utf8(ex.getMessage())));
+		}
+
+		// slot elements are found before any of them is marked: text slot releases element children
+		std::vector<xercesc::DOMElement *> elements;
+		m_slots.reserve(slots.size());
+		elements.reserve(slots.size());
+
+		for (auto & path : slots)
+		{
+			slot current {path, {}, {}};
+
+			std::string_view element_path = path;
+			auto pos = element_path.rfind('/');
+			auto last_segment = pos == element_path.npos ? element_path : element_path.substr(pos + 1);
+			if (not last_segment.empty() and last_segment.front() == '@')
+			{
+				current.attribute = to_xmlch(last_segment.substr(1));
+				element_path.remove_suffix(last_segment.size());
+
+				if (current.attribute.empty())
+					throw std::invalid_argument("xercesc_utils::document_template: empty attribute name in slot " + path);
+			}
+
+			auto * element = find_path(m_skeleton.get(), to_xmlch(element_path));
+			if (not element) throw xml_path_exception(path);
+
+			for (xercesc::DOMNode * node = element; node != m_skeleton.get(); node = node->getParentNode())
+			{
+				std::size_t index = 0;
+				for (auto * sibling = node->getPreviousSibling(); sibling; sibling = sibling->getPreviousSibling())
+					++index;
+
+				current.route.push_back(index);
+			}
+
+			std::reverse(current.route.begin(), current.route.end());
+			m_slots.push_back(std::move(current));
+			elements.push_back(element);
+		}
+
+		for (std::size_t i = 0; i < m_slots.size(); ++i)
+		{
+			for (std::size_t j = 0; j < m_slots.size(); ++j)
+			{
+				if (i == j) continue;
+
+				auto & op1 = m_slots[i];
+				auto & op2 = m_slots[j];
+				if (op1.route == op2.route and op1.attribute == op2.attribute)
+					throw std::invalid_argument("xercesc_utils::document_template: slots " + op1.path + " and " + op2.path + " are the same");
+
+				if (op1.attribute.empty() and is_prefix(op1.route, op2.route) and (op1.route != op2.route or op2.attribute.empty()))
+					throw std::invalid_argument("xercesc_utils::document_template: text slot " + op1.path + " contains slot " + op2.path);
+			}
+		}
+
+		for (std::size_t i = 0; i < m_slots.size(); ++i)
+		{
+			if (m_slots[i].attribute.empty())
+				set_text_content(elements[i], slot_marker(i));
+			else
+				set_attribute_text(elements[i], m_slots[i].attribute, slot_marker(i));
+		}
+
+		std::string rendered;
+		utf8_output out(rendered);
+		dom_utf8_serializer serializer(out, save_option);
+		serializer.write_document(m_skeleton.get(), xml_declaration);
+
+		// split rendered skeleton at slot markers
+		std::vector<char> found(m_slots.size());
+		std::string_view rest = rendered;
+		for (auto start = rest.find(slot_start); start != rest.npos; start = rest.find(slot_start))
+		{
+			auto digits = start + slot_start.size();
+			auto end = rest.find(slot_end, digits);
+			auto number = rest.substr(digits, end == rest.npos ? 0 : end - digits);
+
+			std::size_t index = 0;
+			bool valid = end != rest.npos and not number.empty() and number.size() < 10
+			         and std::all_of(number.begin(), number.end(), [](char ch) { return ch >= '0' and ch <= '9'; });
+			if (valid) index = std::stoul(std::string(number));
+			if (not valid or index >= m_slots.size() or found[index])
+				throw std::invalid_argument("xercesc_utils::document_template: skeleton contains slot marker characters U+E000/U+E001");
+
+			found[index] = 1;
+			m_segments.emplace_back(rest.substr(0, start));
+			m_order.push_back(index);
+			rest.remove_prefix(end + slot_end.size());
+		}
+
+		m_segments.emplace_back(rest);
+		if (m_order.size() != m_slots.size())
+			throw std::invalid_argument("xercesc_utils::document_template: slot is not rendered by serializer");
+
+		for (auto & segment : m_segments)
+		{
+			// slot end marker without start one
+			if (segment.find(slot_end) != segment.npos)
+				throw std::invalid_argument("xercesc_utils::document_template: skeleton contains slot marker characters U+E000/U+E001");
+
+			m_fixed_size += segment.size();
+		}
+	}
+
+	std::size_t document_template::slot_index(std::string_view path) const
+	{
+		auto it = std::find_if(m_slots.begin(), m_slots.end(), [path](auto & item) { return item.path == path; });
+		if (it == m_slots.end()) throw std::invalid_argument("xercesc_utils::document_template: no slot " + std::string(path));
+		return it - m_slots.begin();
+	}
+
+	void document_template::check_values(std::size_t count) const
+	{
+		if (count != m_slots.size())
+			throw std::invalid_argument("xercesc_utils::document_template: " + std::to_string(m_slots.size()) + " values expected, "
+			                            + std::to_string(count) + " given");
+	}
+
+	void document_template::render_values(utf8_output & out, const std::string_view * values) const
+	{
+		for (std::size_t i = 0; i < m_order.size(); ++i)
+		{
+			auto & current = m_slots[m_order[i]];
+			out.append(m_segments[i]);
+			out.append_escaped(values[m_order[i]], current.attribute.empty() ? escape_mode::text : escape_mode::attribute);
+		}
+
+		out.append(m_segments.back());
+	}
+
+	void document_template::render(utf8_output & out, const std::vector<std::string_view> & values) const
+	{
+		check_values(values.size());
+		render_values(out, values.data());
+	}
+
+	void document_template::render(utf8_output & out, std::initializer_list<std::string_view> values) const
+	{
+		check_values(values.size());
+		render_values(out, values.begin());
+	}
+
+	void document_template::render(std::string & str, const std::vector<std::string_view> & values) const
+	{
+		check_values(values.size());
+
+		auto size = str.size() + m_fixed_size;
+		for (auto value : values) size += value.size();
+		str.reserve(size);
+
+		utf8_output out(str);
+		render_values(out, values.data());
+	}
+
+	void document_template::render(std::streambuf & sb, const std::vector<std::string_view> & values) const
+	{
+		check_values(values.size());
+
+		utf8_output out(sb);
+		render_values(out, values.data());
+		out.flush();
+	}
+
+	void document_template::render(xercesc::XMLFormatTarget & target, const std::vector<std::string_view> & values) const
+	{
+		check_values(values.size());
+
+		utf8_output out(target);
+		render_values(out, values.data());
+		out.flush();
+	}
+
+	std::string document_template::render(const std::vector<std::string_view> & values) const
+	{
+		std::string str;
+		render(str, values);
+		return str;
+	}
+
+	std::string document_template::render(std::initializer_list<std::string_view> values) const
+	{
+		check_values(values.size());
+
+		std::string str;
+		utf8_output out(str);
+		render_values(out, values.begin());
+		return str;
+	}
+
+	std::shared_ptr<xercesc::DOMDocument> document_template::instantiate_values(const std::string_view * values) const
+	{
+		std::shared_ptr<xercesc::DOMDocument> doc;
+		try
+		{
+			doc.reset(static_cast<xercesc::DOMDocument *>(m_skeleton->cloneNode(true)), xercesc_release_deleter());
+		}
+		catch (xercesc::DOMException & ex)
+		{
+			std::throw_with_nested(std::runtime_error(xercesc_utils::to_utf8(ex.getMessage())));
+		}
+
+		for (std::size_t i = 0; i < m_slots.size(); ++i)
+		{
+			auto & current = m_slots[i];
+
+			xercesc::DOMNode * node = doc.get();
+			for (auto index : current.route)
+				for (node = node->getFirstChild(); index; --index) node = node->getNextSibling();
+
+			auto * element = static_cast<xercesc::DOMElement *>(node);
+			if (current.attribute.empty())
+				set_text_content(element, values[i]);
+			else
+				set_attribute_text(element, current.attribute, values[i]);
+		}
+
+		return doc;
+	}
+
+	std::shared_ptr<xercesc::DOMDocument> document_template::instantiate(const std::vector<std::string_view> & values) const
+	{
+		check_values(values.size());
+		return instantiate_values(values.data());
+	}
+
+	std::shared_ptr<xercesc::DOMDocument> document_template::instantiate(std::initializer_list<std::string_view> values) const
+	{
+		check_values(values.size());
+		return instantiate_values(values.begin());
+	}
+}
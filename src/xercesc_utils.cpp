@@ -1,6 +1,13 @@
 ﻿#include <codecvt>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <vector>
 #include <ext/codecvt_conv.hpp>
 #include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_document_cache.hpp>
+#include <xercesc/dom/impl/DOMDocumentImpl.hpp>
 #include <boost/predef.h>
 
 namespace xercesc_utils
@@ -131,8 +138,186 @@ namespace xercesc_utils
 			if (res != 0)
 				throw std::runtime_error("xercesc_utils::streambuf_target: failed to sync std::streambuf");
 		}
+
+		/************************************************************************/
+		/*                   per-thread serializer cache                        */
+		/************************************************************************/
+		// incremented on each xercesc_free, cached objects of older generations belong to terminated xercesc
+		std::atomic_uint g_xercesc_generation = 0;
+
+		struct serializer_entry
+		{
+			save_option option;
+			bool xml_declaration;
+			xml_string encoding;
+			bool busy = false;
+
+			DOMLSSerializerPtr serializer;
+			DOMLSOutputPtr output;
+		};
+
+		class serializer_cache
+		{
+			// few entries at most: save_option x used encodings
+			std::vector<std::unique_ptr<serializer_entry>> m_entries;
+			unsigned m_generation = g_xercesc_generation.load(std::memory_order_relaxed);
+
+		private:
+			void check_generation();
+
+		public:
+			static auto create_entry(save_option save_option, const XMLCh * encoding, bool xml_declaration) -> std::unique_ptr<serializer_entry>;
+			serializer_entry * acquire(save_option save_option, const XMLCh * encoding, bool xml_declaration);
+			void clear();
+
+		public:
+			~serializer_cache() { check_generation(); }
+		};
+
+		class serializer_lease
+		{
+			serializer_entry * m_entry;
+			std::unique_ptr<serializer_entry> m_owned; // used when cached one is busy(reentrant save from format target)
+
+		public:
+			xercesc::DOMLSSerializer * serializer() const noexcept { return m_entry->serializer.get(); }
+			xercesc::DOMLSOutput * output() const noexcept { return m_entry->output.get(); }
+
+		public:
+			serializer_lease(save_option save_option, const XMLCh * encoding, bool xml_declaration = true);
+			~serializer_lease();
+
+			serializer_lease(const serializer_lease &) = delete;
+			serializer_lease & operator =(const serializer_lease &) = delete;
+		};
+
+		thread_local serializer_cache t_serializer_cache;
+
+		auto serializer_cache::create_entry(save_option save_option, const XMLCh * encoding, bool xml_declaration) -> std::unique_ptr<serializer_entry>
+		{
+			using namespace xercesc;
+
+			// get a serializer, an instance of DOMLSSerializer
+			const XMLCh * tempStr = XERCESC_LIT("LS");
+			DOMImplementation  * impl = xercesc::DOMImplementationRegistry::getDOMImplementation(tempStr);
+
+			auto entry = std::make_unique<serializer_entry>();
+			entry->option = save_option;
+			entry->xml_declaration = xml_declaration;
+			entry->encoding = encoding;
+			entry->serializer.reset( ((xercesc::DOMImplementationLS*)impl)->createLSSerializer() );
+			entry->output.reset( ((xercesc::DOMImplementationLS*)impl)->createLSOutput() );
+
+			DOMConfiguration * serializerConfig = entry->serializer->getDomConfig();
+			serializerConfig->setParameter(xercesc::XMLUni::fgDOMXMLDeclaration, xml_declaration);
+			if (save_option == pretty_print)
+			{
+				serializerConfig->setParameter(xercesc::XMLUni::fgDOMWRTFormatPrettyPrint, true);
+				serializerConfig->setParameter(xercesc::XMLUni::fgDOMWRTXercesPrettyPrint, false); // fixes double new-line
+			}
+
+			entry->output->setEncoding(entry->encoding.c_str());
+			return entry;
+		}
+
+		void serializer_cache::check_generation()
+		{
+			auto generation = g_xercesc_generation.load(std::memory_order_relaxed);
+			if (m_generation == generation) return;
+
+			// xercesc was terminated since those were created, they can't be released anymore
+			for (auto & entry : m_entries)
+			{
+				entry->serializer.release();
+				entry->output.release();
+			}
+
+			m_entries.clear();
+			m_generation = generation;
+		}
+
+		serializer_entry * serializer_cache::acquire(save_option save_option, const XMLCh * encoding, bool xml_declaration)
+		{
+			check_generation();
+
+			for (auto & entry : m_entries)
+			{
+				if (entry->option == save_option and entry->xml_declaration == xml_declaration and entry->encoding == encoding)
+					return entry->busy ? nullptr : entry.get();
+			}
+
+			m_entries.push_back(create_entry(save_option, encoding, xml_declaration));
+			return m_entries.back().get();
+		}
+
+		void serializer_cache::clear()
+		{
+			check_generation();
+			m_entries.clear();
+		}
+
+		serializer_lease::serializer_lease(save_option save_option, const XMLCh * encoding, bool xml_declaration /* = true */)
+		{
+			m_entry = t_serializer_cache.acquire(save_option, encoding, xml_declaration);
+			if (not m_entry)
+			{
+				m_owned = serializer_cache::create_entry(save_option, encoding, xml_declaration);
+				m_entry = m_owned.get();
+			}
+
+			m_entry->busy = true;
+		}
+
+		serializer_lease::~serializer_lease()
+		{
+			// do not keep pointer to the target, it's usually a local object
+			m_entry->output->setByteStream(nullptr);
+			m_entry->busy = false;
+		}
 	} // 'anonymous' namespace
 
+	void xercesc_free()
+	{
+		t_serializer_cache.clear();
+		shared_document_cache().clear();
+		// compiled expressions are allocated by xercesc memory manager
+		clear_xpath_cache();
+		g_xercesc_generation.fetch_add(1, std::memory_order_relaxed);
+		xercesc::XMLPlatformUtils::Terminate();
+	}
+
+	void clear_serializer_cache()
+	{
+		t_serializer_cache.clear();
+	}
+
+	chunked_target::chunked_target(std::vector<std::string> & chunks, std::size_t chunk_size /* = default_chunk_size */, std::size_t size_hint /* = 0 */)
+	    : m_chunks(&chunks), m_chunk_size(chunk_size)
+	{
+		if (not m_chunk_size) throw std::invalid_argument("xercesc_utils::chunked_target: chunk_size is 0");
+		if (size_hint) chunks.reserve(chunks.size() + (size_hint + m_chunk_size - 1) / m_chunk_size);
+	}
+
+	void chunked_target::writeChars(const XMLByte * toWrite, const XMLSize_t count, xercesc::XMLFormatter * formatter)
+	{
+		auto * first = reinterpret_cast<const char *>(toWrite);
+		auto * last  = first + count;
+
+		while (first != last)
+		{
+			if (m_chunks->empty() or m_chunks->back().size() >= m_chunk_size)
+			{
+				m_chunks->emplace_back();
+				m_chunks->back().reserve(m_chunk_size);
+			}
+
+			auto & chunk = m_chunks->back();
+			std::size_t n = std::min<std::size_t>(m_chunk_size - chunk.size(), last - first);
+			chunk.append(first, n);
+			first += n;
+		}
+	}
+
 	std::string error_report(xercesc::SAXParseException & ex)
 	{
 		std::string report;
@@ -183,115 +368,109 @@ namespace xercesc_utils
 
 	std::string print(xercesc::DOMElement * element, save_option save_option /* = pretty_print */)
 	{
-		using namespace xercesc;
+		std::string result;
+		print(result, element, save_option);
+		return result;
+	}
+
+	void print(xercesc::XMLFormatTarget & target, xercesc::DOMElement * element, save_option save_option /* = pretty_print */)
+	{
 		if (not element) throw std::invalid_argument("xercesc_utils::print: element is null");
-		//if (not encoding) throw std::invalid_argument("xercesc_utils::save: encoding is null");
 
-		// get a serializer, an instance of DOMLSSerializer
-		const XMLCh * tempStr = XERCESC_LIT("LS");
-		DOMImplementation  * impl = xercesc::DOMImplementationRegistry::getDOMImplementation(tempStr);
-		DOMLSSerializerPtr   theSerializer ( ((xercesc::DOMImplementationLS*)impl)->createLSSerializer() );
-		DOMConfiguration   * serializerConfig = theSerializer->getDomConfig();
+		// serialize directly into utf-8, writeToString would produce utf-16 string needing another conversion pass
+		serializer_lease lease(save_option, XERCESC_LIT("utf-8"), false);
+		lease.output()->setByteStream(&target);
+		lease.serializer()->write(element, lease.output());
+	}
 
-		if (save_option == pretty_print)
-		{
-			serializerConfig->setParameter(xercesc::XMLUni::fgDOMWRTFormatPrettyPrint, true);
-			serializerConfig->setParameter(xercesc::XMLUni::fgDOMWRTXercesPrettyPrint, false); // fixes double new-line
-		}
+	void print(std::string & str, xercesc::DOMElement * element, save_option save_option /* = pretty_print */)
+	{
+		string_target target(str);
+		return print(target, element, save_option);
+	}
 
-		XMLChPtr xml ( theSerializer->writeToString(element) );
-		return to_utf8(xml.get());
+	void print(std::streambuf & sb, xercesc::DOMElement * element, save_option save_option /* = pretty_print */)
+	{
+		streambuf_target target(&sb);
+		return print(target, element, save_option);
 	}
 
-	std::string save(xercesc::DOMDocument * document, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = L"utf-8" */)
+	void print(std::ostream & os, xercesc::DOMElement * element, save_option save_option /* = pretty_print */)
 	{
-		using namespace xercesc;
-		if (not document) throw std::invalid_argument("xercesc_utils::save: document is null");
-		if (not encoding) throw std::invalid_argument("xercesc_utils::save: encoding is null");
+		auto * sbuf = os.rdbuf();
+		if (not sbuf) throw std::invalid_argument("xercesc_utils::print: std::ostream does not have streambuf!");
+		return print(*sbuf, element, save_option);
+	}
 
-		// get a serializer, an instance of DOMLSSerializer
-		const XMLCh * tempStr = XERCESC_LIT("LS");
-		DOMImplementation  * impl = xercesc::DOMImplementationRegistry::getDOMImplementation(tempStr);
-		DOMLSSerializerPtr   theSerializer ( ((xercesc::DOMImplementationLS*)impl)->createLSSerializer() );
-		DOMLSOutputPtr       theOutputDesc ( ((xercesc::DOMImplementationLS*)impl)->createLSOutput() );
-		DOMConfiguration   * serializerConfig = theSerializer->getDomConfig();
+	std::string save(xercesc::DOMDocument * document, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = L"utf-8" */)
+	{
+		std::string result;
+		save(result, document, save_option, encoding);
+		return result;
+	}
 
-		serializerConfig->setParameter(xercesc::XMLUni::fgDOMXMLDeclaration, true);
-		if (save_option == pretty_print)
-		{
-			serializerConfig->setParameter(xercesc::XMLUni::fgDOMWRTFormatPrettyPrint, true);
-			serializerConfig->setParameter(xercesc::XMLUni::fgDOMWRTXercesPrettyPrint, false); // fixes double new-line
-		}
+	void save(std::string & str, xercesc::DOMDocument * document, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = XERCESC_LIT("utf-8") */, std::size_t size_hint /* = 0 */)
+	{
+		string_target target(str, size_hint);
+		return save(target, document, save_option, encoding);
+	}
 
-		theOutputDesc->setEncoding(encoding);
+	void save(std::vector<char> & buf, xercesc::DOMDocument * document, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = XERCESC_LIT("utf-8") */, std::size_t size_hint /* = 0 */)
+	{
+		vector_target target(buf, size_hint);
+		return save(target, document, save_option, encoding);
+	}
 
-		MemBufFormatTarget memTarget;
-		theOutputDesc->setByteStream(&memTarget);
-		theSerializer->write(document, theOutputDesc.get());
+	void save(std::vector<std::string> & chunks, xercesc::DOMDocument * document, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = XERCESC_LIT("utf-8") */, std::size_t size_hint /* = 0 */)
+	{
+		chunked_target target(chunks, chunked_target::default_chunk_size, size_hint);
+		return save(target, document, save_option, encoding);
+	}
 
-		auto * buf = memTarget.getRawBuffer();
-		auto len = memTarget.getLen();
+	void save_to_file(xercesc::DOMDocument * document, const xml_string & file, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = L"utf-8" */)
+	{
+		return save_to_file(document, file, file_target_options(), save_option, encoding);
+	}
 
-		return std::string(reinterpret_cast<const char *>(buf), len);
+	void save_to_file(xercesc::DOMDocument * document, const std::string & file, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = L"utf-8" */)
+	{
+		return save_to_file(document, file, file_target_options(), save_option, encoding);
 	}
 
-	void save_to_file(xercesc::DOMDocument * document, const xml_string & file, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = L"utf-8" */)
+	void save_to_file(xercesc::DOMDocument * document, const xml_string & file, const file_target_options & options, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = L"utf-8" */)
 	{
-		using namespace xercesc;
 		if (not document) throw std::invalid_argument("xercesc_utils::save: document is null");
 		if (not encoding) throw std::invalid_argument("xercesc_utils::save: encoding is null");
 
-		// get a serializer, an instance of DOMLSSerializer
-		const XMLCh * tempStr = XERCESC_LIT("LS");
-		DOMImplementation  * impl = xercesc::DOMImplementationRegistry::getDOMImplementation(tempStr);
-		DOMLSSerializerPtr   theSerializer(((xercesc::DOMImplementationLS*)impl)->createLSSerializer());
-		DOMLSOutputPtr       theOutputDesc(((xercesc::DOMImplementationLS*)impl)->createLSOutput());
-		DOMConfiguration   * serializerConfig = theSerializer->getDomConfig();
-
-		serializerConfig->setParameter(xercesc::XMLUni::fgDOMXMLDeclaration, true);
-		if (save_option == pretty_print)
-		{
-			serializerConfig->setParameter(xercesc::XMLUni::fgDOMWRTFormatPrettyPrint, true);
-			serializerConfig->setParameter(xercesc::XMLUni::fgDOMWRTXercesPrettyPrint, false); // fixes double new-line
-		}
+		file_target target(file, options);
+		save(target, document, save_option, encoding);
+		target.commit();
+	}
 
-		theOutputDesc->setEncoding(encoding);
+	void save_to_file(xercesc::DOMDocument * document, const std::string & file, const file_target_options & options, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = L"utf-8" */)
+	{
+		if (not document) throw std::invalid_argument("xercesc_utils::save: document is null");
+		if (not encoding) throw std::invalid_argument("xercesc_utils::save: encoding is null");
 
-		LocalFileFormatTarget fileTarget(file.c_str());
-		theOutputDesc->setByteStream(&fileTarget);
-		theSerializer->write(document, theOutputDesc.get());
+		file_target target(file, options);
+		save(target, document, save_option, encoding);
+		target.commit();
 	}
 
-	void save_to_file(xercesc::DOMDocument * document, const std::string & file, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = L"utf-8" */)
+	void save(std::streambuf & sb, xercesc::DOMDocument * document, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = XERCESC_LIT("utf-8") */)
 	{
-		return save_to_file(document, to_xmlch(file), save_option, encoding);
+		streambuf_target target(&sb);
+		return save(target, document, save_option, encoding);
 	}
 
-	void save(std::streambuf & sb, xercesc::DOMDocument * document, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = XERCESC_LIT("utf-8") */)
+	void save(xercesc::XMLFormatTarget & target, xercesc::DOMDocument * document, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = XERCESC_LIT("utf-8") */)
 	{
-		using namespace xercesc;
 		if (not document) throw std::invalid_argument("xercesc_utils::save: document is null");
 		if (not encoding) throw std::invalid_argument("xercesc_utils::save: encoding is null");
 
-		// get a serializer, an instance of DOMLSSerializer
-		const XMLCh * tempStr = XERCESC_LIT("LS");
-		DOMImplementation  * impl = xercesc::DOMImplementationRegistry::getDOMImplementation(tempStr);
-		DOMLSSerializerPtr   theSerializer(((xercesc::DOMImplementationLS*)impl)->createLSSerializer());
-		DOMLSOutputPtr       theOutputDesc(((xercesc::DOMImplementationLS*)impl)->createLSOutput());
-		DOMConfiguration   * serializerConfig = theSerializer->getDomConfig();
-
-		serializerConfig->setParameter(xercesc::XMLUni::fgDOMXMLDeclaration, true);
-		if (save_option == pretty_print)
-		{
-			serializerConfig->setParameter(xercesc::XMLUni::fgDOMWRTFormatPrettyPrint, true);
-			serializerConfig->setParameter(xercesc::XMLUni::fgDOMWRTXercesPrettyPrint, false); // fixes double new-line
-		}
-
-		theOutputDesc->setEncoding(encoding);
-
-		streambuf_target target(&sb);
-		theOutputDesc->setByteStream(&target);
-		theSerializer->write(document, theOutputDesc.get());
+		serializer_lease lease(save_option, encoding);
+		lease.output()->setByteStream(&target);
+		lease.serializer()->write(document, lease.output());
 	}
 
 	void save(std::ostream & os, xercesc::DOMDocument * doc, save_option save_option /* = pretty_print */, const XMLCh * encoding /* = XERCESC_LIT("utf-8") */)
@@ -333,22 +512,10 @@ namespace xercesc_utils
 
 	std::shared_ptr<xercesc::DOMDocument> load(const char * data, std::size_t size)
 	{
-		return wrapped_load_xml([data, size]
-		{
-			auto parser = std::make_shared<xercesc::XercesDOMParser>();
-			xercesc_utils::HandlerBasePtr err(new xercesc::HandlerBase);
-
-			xercesc::MemBufInputSource input(reinterpret_cast<const XMLByte *>(data), size, "input buffer");
-			input.setCopyBufToStream(false);
+		xercesc::MemBufInputSource input(reinterpret_cast<const XMLByte *>(data), size, "input buffer");
+		input.setCopyBufToStream(false);
 
-			parser->setDoNamespaces(true);
-			parser->setErrorHandler(err.get());
-			parser->parse(input);
-			parser->setErrorHandler(nullptr);
-
-			// aliasing constructor
-			return std::shared_ptr<xercesc::DOMDocument>(std::move(parser), parser->getDocument());
-		});
+		return load(input);
 	}
 
 	std::shared_ptr<xercesc::DOMDocument> load_from_file(const std::string & file)
@@ -361,29 +528,24 @@ namespace xercesc_utils
 	{
 		return wrapped_load_xml([&file]
 		{
-			auto parser = std::make_shared<xercesc::XercesDOMParser>();
-			xercesc_utils::HandlerBasePtr err(new xercesc::HandlerBase);
 			xercesc::LocalFileInputSource input = file.c_str();
-
-			parser->setDoNamespaces(true);
-			parser->setErrorHandler(err.get());
-			parser->parse(input);
-			parser->setErrorHandler(nullptr);
-
-			// aliasing constructor
-			return std::shared_ptr<xercesc::DOMDocument>(std::move(parser), parser->getDocument());
+			return load(input);
 		});
 	}
 
 	std::shared_ptr<xercesc::DOMDocument> load(std::streambuf & sb)
 	{
-		return wrapped_load_xml([&sb]
+		streambuf_input_source input(&sb);
+		return load(input);
+	}
+
+	std::shared_ptr<xercesc::DOMDocument> load(const xercesc::InputSource & input)
+	{
+		return wrapped_load_xml([&input]
 		{
 			auto parser = std::make_shared<xercesc::XercesDOMParser>();
 			xercesc_utils::HandlerBasePtr err(new xercesc::HandlerBase);
 
-			streambuf_input_source input(&sb);
-
 			parser->setDoNamespaces(true);
 			parser->setErrorHandler(err.get());
 			parser->parse(input);
@@ -402,41 +564,124 @@ namespace xercesc_utils
 	}
 
 
-	void DOMXPathNSResolverImpl::addNamespaceBinding(xml_string prefix, xml_string uri)
+	/************************************************************************/
+	/*                 namespace_bindings / resolver                        */
+	/************************************************************************/
+	std::size_t namespace_bindings::hash(xml_string_view str) noexcept
+	{
+		// FNV-1a, good enough for short prefixes and uris
+		std::size_t hash = 2166136261u;
+		for (XMLCh ch : str)
+			hash = (hash ^ ch) * 16777619u;
+
+		return hash;
+	}
+
+	std::size_t namespace_bindings::find(const std::deque<mapping> & mappings, xml_string_view key) noexcept
+	{
+		auto key_hash = hash(key);
+		std::size_t idx = 0, count = mappings.size();
+		for (; idx < count; ++idx)
+			if (mappings[idx].key_hash == key_hash and mappings[idx].key == key) break;
+
+		return idx;
+	}
+
+	void namespace_bindings::assign(std::deque<mapping> & mappings, xml_string_view key, xml_string_view value)
+	{
+		auto idx = find(mappings, key);
+		if (idx < mappings.size())
+			mappings[idx].value.assign(value.data(), value.size());
+		else
+			mappings.push_back({hash(key), xml_string(key), xml_string(value)});
+	}
+
+	void namespace_bindings::add(xml_string_view prefix, xml_string_view uri)
+	{
+		assign(m_prefix_mappings, uri, prefix);
+		assign(m_uri_mappings, prefix, uri);
+	}
+
+	const XMLCh * namespace_bindings::lookup_uri(xml_string_view prefix) const noexcept
+	{
+		auto idx = find(m_uri_mappings, prefix);
+		return idx < m_uri_mappings.size() ? m_uri_mappings[idx].value.c_str() : nullptr;
+	}
+
+	const XMLCh * namespace_bindings::lookup_prefix(xml_string_view uri) const noexcept
+	{
+		auto idx = find(m_prefix_mappings, uri);
+		return idx < m_prefix_mappings.size() ? m_prefix_mappings[idx].value.c_str() : nullptr;
+	}
+
+	auto namespace_bindings::create(std::initializer_list<std::pair<std::string_view, std::string_view>> items) -> std::shared_ptr<const namespace_bindings>
+	{
+		auto bindings = std::make_shared<namespace_bindings>();
+		for (auto & item : items)
+			bindings->add(to_xmlch(item.first), to_xmlch(item.second));
+
+		return bindings;
+	}
+
+	auto namespace_bindings::create(std::initializer_list<std::pair<xml_string, xml_string>> items) -> std::shared_ptr<const namespace_bindings>
+	{
+		auto bindings = std::make_shared<namespace_bindings>();
+		for (auto & item : items)
+			bindings->add(item.first, item.second);
+
+		return bindings;
+	}
+
+	namespace
 	{
-		m_prefix_mappings[uri] = prefix;
-		m_uri_mappings[prefix] = uri;
+		// all default constructed resolvers share one empty bindings object
+		const namespace_bindings_ptr & empty_bindings()
+		{
+			static const namespace_bindings_ptr empty = std::make_shared<namespace_bindings>();
+			return empty;
+		}
+	}
+
+	DOMXPathNSResolverImpl::DOMXPathNSResolverImpl()
+	    : m_bindings(empty_bindings()) {}
+
+	DOMXPathNSResolverImpl::DOMXPathNSResolverImpl(namespace_bindings_ptr bindings)
+	    : m_bindings(bindings ? std::move(bindings) : empty_bindings()) {}
+
+	void DOMXPathNSResolverImpl::add_binding(xml_string_view prefix, xml_string_view uri)
+	{
+		// copy-on-write: bindings are mutated in place only if nobody else shares them
+		std::shared_ptr<namespace_bindings> bindings;
+		if (m_bindings.use_count() == 1)
+			bindings = std::const_pointer_cast<namespace_bindings>(m_bindings);
+		else
+			bindings = std::make_shared<namespace_bindings>(*m_bindings);
+
+		bindings->add(prefix, uri);
+		if (bindings != m_bindings) m_replaced.push_back(std::move(m_bindings));
+		m_bindings = std::move(bindings);
 	}
 
 	void DOMXPathNSResolverImpl::addNamespaceBinding(const XMLCh * prefix, const XMLCh * uri)
 	{
-		m_prefix_mappings[uri] = prefix;
-		m_uri_mappings[prefix] = uri;
+		xml_string_view prefix_view = prefix ? xml_string_view(prefix) : xml_string_view();
+		xml_string_view uri_view = uri ? xml_string_view(uri) : xml_string_view();
+		return add_binding(prefix_view, uri_view);
 	}
 
 	const XMLCh * DOMXPathNSResolverImpl::lookupNamespaceURI(const XMLCh * prefix) const
 	{
-		auto it = m_uri_mappings.find(prefix);
-		if (it == m_uri_mappings.end()) return nullptr;
-
-		return it->second.c_str();
+		return lookupNamespaceURI(prefix ? xml_string_view(prefix) : xml_string_view());
 	}
 
 	const XMLCh * DOMXPathNSResolverImpl::lookupPrefix(const XMLCh * uri) const
 	{
-		auto it = m_prefix_mappings.find(uri);
-		if (it == m_prefix_mappings.end()) return nullptr;
-
-		return it->second.c_str();
+		return lookupPrefix(uri ? xml_string_view(uri) : xml_string_view());
 	}
 
 	DOMXPathNSResolverImpl * DOMXPathNSResolverImpl::clone() const
 	{
-		auto * clone = new DOMXPathNSResolverImpl;
-		clone->m_uri_mappings = m_uri_mappings;
-		clone->m_prefix_mappings = m_prefix_mappings;
-
-		return clone;
+		return new DOMXPathNSResolverImpl(m_bindings);
 	}
 
 	void DOMXPathNSResolverImpl::release()
@@ -447,20 +692,17 @@ namespace xercesc_utils
 
 	DOMXPathNSResolverImplPtr create_resolver(std::initializer_list<std::pair<std::string_view, std::string_view>> items)
 	{
-		DOMXPathNSResolverImplPtr resolver(new DOMXPathNSResolverImpl);
-		for (auto & item : items)
-			resolver->addNamespaceBinding(item.first, item.second);
-
-		return resolver;
+		return create_resolver(namespace_bindings::create(items));
 	}
 
 	DOMXPathNSResolverImplPtr create_resolver(std::initializer_list<std::pair<xml_string, xml_string>> items)
 	{
-		DOMXPathNSResolverImplPtr resolver(new DOMXPathNSResolverImpl);
-		for (auto & item : items)
-			resolver->addNamespaceBinding(item.first, item.second);
+		return create_resolver(namespace_bindings::create(items));
+	}
 
-		return resolver;
+	DOMXPathNSResolverImplPtr create_resolver(namespace_bindings_ptr bindings)
+	{
+		return DOMXPathNSResolverImplPtr(new DOMXPathNSResolverImpl(std::move(bindings)));
 	}
 
 	class CustomResolverDataHandler : public xercesc::DOMUserDataHandler
@@ -536,10 +778,19 @@ namespace xercesc_utils
 		return ret;
 	}
 
+	auto associate_namespaces(xercesc::DOMNode * node, namespace_bindings_ptr bindings) -> DOMXPathNSResolverImpl *
+	{
+		auto resolver = create_resolver(std::move(bindings));
+		auto ret = resolver.get();
+		associate_resolver(node, std::move(resolver));
+		return ret;
+	}
+
 	void set_namespace(xercesc::DOMElement * element, xml_string prefix, xml_string uri)
 	{
 		if (not element) throw std::invalid_argument("xercesc_utils::set_namespace: element is null");
 		element->setAttributeNS(XERCESC_LIT("http://www.w3.org/2000/xmlns/"), prefix.c_str(), uri.c_str());
+		invalidate_namespace_cache(element);
 	}
 
 	void set_namespace(xercesc::DOMDocument * doc, xml_string prefix, xml_string uri)
@@ -559,6 +810,269 @@ namespace xercesc_utils
 			set_namespace(doc, item.first, item.second);
 	}
 	
+	/************************************************************************/
+	/*                     namespace scope cache                            */
+	/************************************************************************/
+	namespace
+	{
+		const xml_string_view xmlns_uri = XERCESC_LIT("http://www.w3.org/2000/xmlns/");
+		const xml_string_view xmlns_name = XERCESC_LIT("xmlns");
+
+		inline xml_string_view forward_view(const XMLCh * str)
+		{
+			return str ? xml_string_view(str) : xml_string_view();
+		}
+
+		/// in-scope bindings of element: innermost first, shadowed outer bindings are dropped
+		struct namespace_scope
+		{
+			std::vector<std::pair<xml_string_view, const XMLCh *>> bindings; // prefix -> uri, uri can be null
+			// isDefaultNamespace has own rules: nearest unprefixed element or xmlns attribute
+			bool has_default = false;
+			const XMLCh * default_uri = nullptr;
+
+			const std::pair<xml_string_view, const XMLCh *> * find(xml_string_view prefix) const noexcept
+			{
+				for (auto & binding : bindings)
+					if (binding.first == prefix) return &binding;
+
+				return nullptr;
+			}
+		};
+
+		class namespace_cache
+		{
+			std::mutex m_mutex;
+			std::unordered_map<const xercesc::DOMElement *, const namespace_scope *> m_scopes;
+			std::deque<namespace_scope> m_storage;
+			const namespace_scope m_empty;
+
+		private:
+			const namespace_scope * build_scope(const xercesc::DOMElement * element, const namespace_scope * parent);
+			static const xercesc::DOMElement * parent_element(const xercesc::DOMNode * node);
+
+		public:
+			/// scope of element, built on first request
+			const namespace_scope * scope(const xercesc::DOMElement * element);
+			void clear();
+
+			std::mutex & mutex() noexcept { return m_mutex; }
+		};
+
+		const xercesc::DOMElement * namespace_cache::parent_element(const xercesc::DOMNode * node)
+		{
+			auto * parent = node->getParentNode();
+			return parent and parent->getNodeType() == xercesc::DOMNode::ELEMENT_NODE ? static_cast<const xercesc::DOMElement *>(parent) : nullptr;
+		}
+
+		const namespace_scope * namespace_cache::build_scope(const xercesc::DOMElement * element, const namespace_scope * parent)
+		{
+			namespace_scope own;
+
+			// same order as DOMElement::lookupNamespaceURI: element own namespace, then xmlns attributes, first binding wins
+			auto * element_ns = element->getNamespaceURI();
+			auto element_prefix = forward_view(element->getPrefix());
+			if (element_ns)
+				own.bindings.emplace_back(element_prefix, element_ns);
+
+			if (element_prefix.empty())
+				own.has_default = true, own.default_uri = element_ns;
+
+			auto * attrs = element->getAttributes();
+			XMLSize_t count = attrs ? attrs->getLength() : 0;
+			for (XMLSize_t i = 0; i < count; ++i)
+			{
+				auto * attr = attrs->item(i);
+				if (forward_view(attr->getNamespaceURI()) != xmlns_uri) continue;
+
+				auto name = forward_view(attr->getNodeName());
+				xml_string_view prefix = name == xmlns_name ? xml_string_view() : forward_view(attr->getLocalName());
+				if (not own.find(prefix))
+					own.bindings.emplace_back(prefix, attr->getNodeValue());
+
+				if (prefix.empty() and not own.has_default)
+					own.has_default = true, own.default_uri = attr->getNodeValue();
+			}
+
+			// nothing declared - share parent's scope
+			if (own.bindings.empty() and not own.has_default)
+				return parent;
+
+			for (auto & binding : parent->bindings)
+				if (not own.find(binding.first))
+					own.bindings.push_back(binding);
+
+			if (not own.has_default)
+				own.has_default = parent->has_default, own.default_uri = parent->default_uri;
+
+			m_storage.push_back(std::move(own));
+			return &m_storage.back();
+		}
+
+		const namespace_scope * namespace_cache::scope(const xercesc::DOMElement * element)
+		{
+			auto it = m_scopes.find(element);
+			if (it != m_scopes.end()) return it->second;
+
+			// collect not yet cached ancestors, then build scopes top down
+			std::vector<const xercesc::DOMElement *> chain;
+			const namespace_scope * parent = &m_empty;
+			for (auto * current = element; current; current = parent_element(current))
+			{
+				auto found = m_scopes.find(current);
+				if (found != m_scopes.end())
+				{
+					parent = found->second;
+					break;
+				}
+
+				chain.push_back(current);
+			}
+
+			for (auto rit = chain.rbegin(); rit != chain.rend(); ++rit)
+			{
+				parent = build_scope(*rit, parent);
+				m_scopes.emplace(*rit, parent);
+			}
+
+			return parent;
+		}
+
+		void namespace_cache::clear()
+		{
+			m_scopes.clear();
+			m_storage.clear();
+		}
+
+		class NamespaceCacheDataHandler : public xercesc::DOMUserDataHandler
+		{
+		public:
+			void handle(DOMOperationType operation, const XMLCh * const key, void * data, const xercesc::DOMNode * src, xercesc::DOMNode * dst) override
+			{
+				// cache belongs to one document: cloned/imported documents do not get it
+				if (data and operation == NODE_DELETED)
+					delete static_cast<namespace_cache *>(data);
+			}
+		};
+
+		const XMLCh * NAMESPACE_CACHE = XERCESC_LIT("xercesc_utils::namespace_cache");
+		NamespaceCacheDataHandler g_namespace_cache_handler;
+
+		namespace_cache * get_namespace_cache(const xercesc::DOMNode * node)
+		{
+			auto * doc = node->getNodeType() == xercesc::DOMNode::DOCUMENT_NODE ? static_cast<const xercesc::DOMDocument *>(node) : node->getOwnerDocument();
+			return doc ? static_cast<namespace_cache *>(doc->getUserData(NAMESPACE_CACHE)) : nullptr;
+		}
+
+		/// element, which namespace scope is used for node lookups, as in DOMNode lookup methods
+		const xercesc::DOMElement * scope_element(const xercesc::DOMNode * node)
+		{
+			using xercesc::DOMNode;
+			switch (node->getNodeType())
+			{
+				case DOMNode::ELEMENT_NODE:
+					return static_cast<const xercesc::DOMElement *>(node);
+				case DOMNode::ATTRIBUTE_NODE:
+					return static_cast<const xercesc::DOMAttr *>(node)->getOwnerElement();
+				case DOMNode::DOCUMENT_NODE:
+					return static_cast<const xercesc::DOMDocument *>(node)->getDocumentElement();
+				case DOMNode::ENTITY_NODE:
+				case DOMNode::NOTATION_NODE:
+				case DOMNode::DOCUMENT_FRAGMENT_NODE:
+				case DOMNode::DOCUMENT_TYPE_NODE:
+					return nullptr;
+				default:
+				{
+					// text, comments, etc.: nearest element ancestor
+					auto * parent = node->getParentNode();
+					while (parent and parent->getNodeType() != DOMNode::ELEMENT_NODE)
+						parent = parent->getParentNode();
+					return static_cast<const xercesc::DOMElement *>(parent);
+				}
+			}
+		}
+	} // 'anonymous' namespace
+
+	void enable_namespace_cache(xercesc::DOMDocument * doc)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::enable_namespace_cache: document is null");
+		if (doc->getUserData(NAMESPACE_CACHE)) return;
+
+		doc->setUserData(NAMESPACE_CACHE, new namespace_cache, &g_namespace_cache_handler);
+	}
+
+	void disable_namespace_cache(xercesc::DOMDocument * doc)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::disable_namespace_cache: document is null");
+
+		auto * prev = doc->setUserData(NAMESPACE_CACHE, nullptr, nullptr);
+		delete static_cast<namespace_cache *>(prev);
+	}
+
+	bool has_namespace_cache(const xercesc::DOMDocument * doc)
+	{
+		return doc and doc->getUserData(NAMESPACE_CACHE);
+	}
+
+	void invalidate_namespace_cache(const xercesc::DOMNode * node)
+	{
+		if (not node) return;
+		if (auto * cache = get_namespace_cache(node))
+		{
+			std::lock_guard<std::mutex> lock(cache->mutex());
+			cache->clear();
+		}
+	}
+
+	const XMLCh * lookup_namespace_uri(const xercesc::DOMNode * node, const XMLCh * prefix)
+	{
+		auto * cache = get_namespace_cache(node);
+		if (not cache) return node->lookupNamespaceURI(prefix);
+
+		auto * element = scope_element(node);
+		if (not element) return nullptr;
+
+		std::lock_guard<std::mutex> lock(cache->mutex());
+		auto * binding = cache->scope(element)->find(forward_view(prefix));
+		if (not binding) return nullptr;
+
+		// as DOMNode::lookupNamespaceURI: empty declaration(xmlns="") is reported as no namespace
+		auto * uri = binding->second;
+		return uri and *uri ? uri : nullptr;
+	}
+
+	const XMLCh * lookup_prefix(const xercesc::DOMNode * node, const XMLCh * uri)
+	{
+		auto * cache = get_namespace_cache(node);
+		if (not cache) return node->lookupPrefix(uri);
+		if (not uri or not *uri) return nullptr;
+
+		auto * element = scope_element(node);
+		if (not element) return nullptr;
+
+		std::lock_guard<std::mutex> lock(cache->mutex());
+		xml_string_view searched = uri;
+		// shadowed bindings are already dropped, so first match is in scope
+		for (auto & binding : cache->scope(element)->bindings)
+			if (not binding.first.empty() and forward_view(binding.second) == searched)
+				return binding.first.data();
+
+		return nullptr;
+	}
+
+	bool is_default_namespace(const xercesc::DOMNode * node, const XMLCh * uri)
+	{
+		auto * cache = get_namespace_cache(node);
+		if (not cache) return node->isDefaultNamespace(uri);
+
+		auto * element = scope_element(node);
+		if (not element) return false;
+
+		std::lock_guard<std::mutex> lock(cache->mutex());
+		auto * scope = cache->scope(element);
+		return scope->has_default and forward_view(scope->default_uri) == forward_view(uri);
+	}
+
 	namespace detail
 	{
 		[[noreturn]] static void throw_prefix_not_found(const XMLCh * prefix)
@@ -579,7 +1093,7 @@ namespace xercesc_utils
 
 		static xml_string_view lookupNamespaceURI(const xercesc::DOMNode * node, const XMLCh * prefix)
 		{
-			auto uri = node->lookupNamespaceURI(prefix);
+			auto uri = lookup_namespace_uri(node, prefix);
 			if (not uri) throw_prefix_not_found(prefix);
 			return uri;
 		}
@@ -604,7 +1118,7 @@ namespace xercesc_utils
 		try
 		{
 			auto * doc = element->getOwnerDocument();
-			auto * found_prefix = element->lookupPrefix(namespace_uri.c_str());
+			auto * found_prefix = lookup_prefix(element, namespace_uri.c_str());
 			auto pos = qualified_name.find(XERCESC_LIT(':'));
 			
 			if (found_prefix)
@@ -616,7 +1130,7 @@ namespace xercesc_utils
 				return (doc->*creator)(namespace_uri.c_str(), qualified_name.c_str());
 			}
 			
-			if (element->isDefaultNamespace(namespace_uri.c_str()))
+			if (is_default_namespace(element, namespace_uri.c_str()))
 			{
 				auto * local_name_first = qualified_name.data() + pos + 1;
 				//auto local_name_last  = qualified_name.data() + qualified_name.size();
@@ -653,6 +1167,7 @@ namespace xercesc_utils
 			auto * local_name_first = qualified_name.data() + pos + 1;
 			
 			auto * attr = element->getAttributeNodeNS(namespace_uri.c_str(), local_name_first);
+			bool declaration = namespace_uri == xmlns_uri;
 			if (not attr)
 			{
 				attr = create_attribute_ns(element, std::move(namespace_uri), std::move(qualified_name));
@@ -660,6 +1175,7 @@ namespace xercesc_utils
 			}
 			
 			attr->setValue(to_xmlch(value).c_str());
+			if (declaration) invalidate_namespace_cache(element);
 		}
 		catch (xercesc::DOMException & ex)
 		{
@@ -909,65 +1425,244 @@ namespace xercesc_utils
 		return element;
 	}
 
-	xercesc::DOMElement * find_path(xercesc::DOMElement * element, xml_string_view path)
-	{
-		using namespace detail;
+	xercesc::DOMElement * find_path(xercesc::DOMElement * element, xml_string_view path)
+	{
+		using namespace detail;
+
+		auto * first = path.data();
+		auto * last  = first + path.size();
+
+		if (element == nullptr || first == last) return element;
+
+		if (*first == separator)
+		{
+			return find_path(element->getOwnerDocument(), path);
+		}
+
+		decltype(first) next;
+		while (first != last)
+		{
+			next = std::find(first, last, separator);
+			element = find_child(element, xml_string_view(first, next - first));
+			if (!element) return nullptr;
+
+			first = skip_separartors(next);
+		}
+
+		return element;
+	}
+
+	xercesc::DOMElement * find_path(xercesc::DOMDocument * doc, xml_string_view path)
+	{
+		using namespace detail;
+
+		auto * first = path.data();
+		auto * last  = first + path.size();
+
+		if (doc == nullptr || first == last) return nullptr;
+
+		first = skip_separartors(first);
+		auto next = std::find(first, last, separator);
+		auto * element = find_root(doc, xml_string_view(first, next - first));
+
+		next = skip_separartors(next);
+		return find_path(element, xml_string_view(next, last - next));
+	}
+
+	xercesc::DOMElement * get_path(xercesc::DOMElement * element, xml_string_view path)
+	{
+		if (not element) throw std::invalid_argument("xercesc_utils::get_path: element is null");
+		element = find_path(element, path);
+
+		if (not element) throw xml_path_exception(path);
+		return element;
+	}
+
+	xercesc::DOMElement * get_path(xercesc::DOMDocument * doc, xml_string_view path)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::get_path: document is null");
+		auto * element = find_path(doc, path);
+
+		if (not element) throw xml_path_exception(path);
+		return element;
+	}
+
+	/************************************************************************/
+	/*                    interned name atoms                               */
+	/************************************************************************/
+	name_atom intern_name(xercesc::DOMDocument * doc, xml_string_view namespace_uri, xml_string_view local_name)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::intern_name: document is null");
+		if (local_name.empty()) throw std::invalid_argument("xercesc_utils::intern_name: local name is empty");
+
+		auto * impl = dynamic_cast<xercesc::DOMDocumentImpl *>(doc);
+		if (not impl) throw std::invalid_argument("xercesc_utils::intern_name: document is not xercesc DOMDocumentImpl");
+
+		// node names are pooled the same way: empty namespace is stored as nullptr
+		auto pooled = [impl](xml_string_view str) -> const XMLCh *
+		{
+			if (str.empty()) return nullptr;
+			xml_string copy(str);
+			return impl->getPooledString(copy.c_str());
+		};
+
+		return name_atom(doc, pooled(namespace_uri), pooled(local_name));
+	}
+
+	name_atom intern_name(xercesc::DOMElement * element, xml_string_view qualified_name)
+	{
+		if (not element) throw std::invalid_argument("xercesc_utils::intern_name: element is null");
+		using namespace detail;
+
+		auto * doc = element->getOwnerDocument();
+		auto * resolver = get_associated_resolver(doc);
+
+		xml_string_view searched_ns;
+		auto nspos = qualified_name.find(XERCESC_LIT(':'));
+		if (nspos != qualified_name.npos)
+		{
+			xml_string nsprefix(qualified_name.substr(0, nspos));
+			qualified_name.remove_prefix(nspos + 1);
+			searched_ns = resolver ? lookupNamespaceURI(resolver, nsprefix.c_str())
+			                       : lookupNamespaceURI(element,  nsprefix.c_str());
+		}
+
+		return intern_name(doc, searched_ns, qualified_name);
+	}
+
+	xercesc::DOMElement * find_child(xercesc::DOMElement * element, const name_atom & name)
+	{
+		if (not element) return nullptr;
+		if (element->getOwnerDocument() != name.document())
+			throw std::invalid_argument("xercesc_utils::find_child: name atom belongs to another document");
+
+		for (auto * node = element->getFirstElementChild(); node; node = node->getNextElementSibling())
+			if (name.matches(node)) return node;
+
+		return nullptr;
+	}
+
+	xercesc::DOMElement * next_sibling(xercesc::DOMElement * element, const name_atom & name)
+	{
+		if (not element) return nullptr;
+		if (element->getOwnerDocument() != name.document())
+			throw std::invalid_argument("xercesc_utils::next_sibling: name atom belongs to another document");
+
+		for (element = element->getNextElementSibling(); element; element = element->getNextElementSibling())
+			if (name.matches(element)) return element;
+
+		return nullptr;
+	}
+
+	atom_path compile_path(xercesc::DOMElement * element, xml_string_view path)
+	{
+		if (not element) throw std::invalid_argument("xercesc_utils::compile_path: element is null");
+		if (not path.empty() and path.front() == separator)
+			return compile_path(element->getOwnerDocument(), path);
+
+		atom_path result;
+		result.m_path.assign(path);
+
+		std::size_t pos = 0;
+		while (pos < path.size() and path[pos] == separator) ++pos;
+		while (pos < path.size())
+		{
+			auto next = std::min(path.find(separator, pos), path.size());
+			result.m_atoms.push_back(intern_name(element, path.substr(pos, next - pos)));
+
+			pos = next;
+			while (pos < path.size() and path[pos] == separator) ++pos;
+		}
+
+		return result;
+	}
+
+	atom_path compile_path(xercesc::DOMDocument * doc, xml_string_view path)
+	{
+		if (not doc) throw std::invalid_argument("xercesc_utils::compile_path: document is null");
+		using namespace detail;
+
+		atom_path result;
+		result.m_path.assign(path);
+		result.m_absolute = true;
+
+		// prefixes are resolved as in find_root: via associated resolver or namespaces in scope of document element
+		auto * resolver = get_associated_resolver(doc);
+		auto * root = doc->getDocumentElement();
+
+		std::size_t pos = 0;
+		while (pos < path.size() and path[pos] == separator) ++pos;
+		while (pos < path.size())
+		{
+			auto next = std::min(path.find(separator, pos), path.size());
+			auto name = path.substr(pos, next - pos);
+
+			xml_string_view searched_ns;
+			auto nspos = name.find(XERCESC_LIT(':'));
+			if (nspos != name.npos)
+			{
+				xml_string nsprefix(name.substr(0, nspos));
+				name.remove_prefix(nspos + 1);
+				searched_ns = resolver ? lookupNamespaceURI(resolver, nsprefix.c_str())
+				            : root     ? lookupNamespaceURI(root, nsprefix.c_str())
+				            :            lookupNamespaceURI(doc,  nsprefix.c_str());
+			}
+
+			result.m_atoms.push_back(intern_name(doc, searched_ns, name));
 
-		auto * first = path.data();
-		auto * last  = first + path.size();
+			pos = next;
+			while (pos < path.size() and path[pos] == separator) ++pos;
+		}
 
-		if (element == nullptr || first == last) return element;
+		return result;
+	}
 
-		if (*first == separator)
-		{
-			return find_path(element->getOwnerDocument(), path);
-		}
+	xercesc::DOMElement * find_path(xercesc::DOMElement * element, const atom_path & path)
+	{
+		if (not element) return nullptr;
+		if (path.absolute()) return find_path(element->getOwnerDocument(), path);
 
-		decltype(first) next;
-		while (first != last)
+		for (auto & name : path.atoms())
 		{
-			next = std::find(first, last, separator);
-			element = find_child(element, xml_string_view(first, next - first));
-			if (!element) return nullptr;
-
-			first = skip_separartors(next);
+			element = find_child(element, name);
+			if (not element) return nullptr;
 		}
 
 		return element;
 	}
 
-	xercesc::DOMElement * find_path(xercesc::DOMDocument * doc, xml_string_view path)
+	xercesc::DOMElement * find_path(xercesc::DOMDocument * doc, const atom_path & path)
 	{
-		using namespace detail;
+		if (not doc or path.atoms().empty()) return nullptr;
 
-		auto * first = path.data();
-		auto * last  = first + path.size();
+		auto & atoms = path.atoms();
+		if (doc != atoms.front().document())
+			throw std::invalid_argument("xercesc_utils::find_path: path is compiled for another document");
 
-		if (doc == nullptr || first == last) return nullptr;
+		auto * element = doc->getDocumentElement();
+		if (not element or not atoms.front().matches(element)) return nullptr;
 
-		first = skip_separartors(first);
-		auto next = std::find(first, last, separator);
-		auto * element = find_root(doc, xml_string_view(first, next - first));
+		for (auto it = atoms.begin() + 1; it != atoms.end() and element; ++it)
+			element = find_child(element, *it);
 
-		next = skip_separartors(next);
-		return find_path(element, xml_string_view(next, last - next));
+		return element;
 	}
 
-	xercesc::DOMElement * get_path(xercesc::DOMElement * element, xml_string_view path)
+	xercesc::DOMElement * get_path(xercesc::DOMElement * element, const atom_path & path)
 	{
 		if (not element) throw std::invalid_argument("xercesc_utils::get_path: element is null");
 		element = find_path(element, path);
 
-		if (not element) throw xml_path_exception(path);
+		if (not element) throw xml_path_exception(path.path());
 		return element;
 	}
 
-	xercesc::DOMElement * get_path(xercesc::DOMDocument * doc, xml_string_view path)
+	xercesc::DOMElement * get_path(xercesc::DOMDocument * doc, const atom_path & path)
 	{
 		if (not doc) throw std::invalid_argument("xercesc_utils::get_path: document is null");
 		auto * element = find_path(doc, path);
 
-		if (not element) throw xml_path_exception(path);
+		if (not element) throw xml_path_exception(path.path());
 		return element;
 	}
 
@@ -1093,7 +1788,10 @@ namespace xercesc_utils
 
 	void set_text_content(xercesc::DOMElement * element, std::string_view text)
 	{
+		// child elements are released
+		bool had_elements = element->getFirstElementChild();
 		element->setTextContent(to_xmlch(text).c_str());
+		if (had_elements) invalidate_namespace_cache(element);
 	}
 
 	std::string find_path_text(xercesc::DOMDocument * doc, xml_string_view path, std::string_view defval /*= empty_string*/)
@@ -1236,90 +1934,530 @@ namespace xercesc_utils
 	}
 
 
-	static xml_string prefix_name(xml_string_view node_name, xml_string_view prefix)
+	namespace
 	{
-		xml_string name;
-		if (prefix.empty())
+		/// renames subtree nodes, qualified names are built in one reused buffer
+		class subtree_renamer
+		{
+			xercesc::DOMDocument * m_doc;
+			const xml_string & m_namespace_uri;
+			const xml_string & m_prefix;
+			xml_string m_name;
+			std::vector<xercesc::DOMAttr *> m_attrs;
+			std::vector<xml_string_view> m_names;
+
+		private:
+			static xml_string_view local_name(const xercesc::DOMNode * node)
+			{
+				auto * name = node->getLocalName();
+				if (name) return name;
+
+				// DOM level 1 node: qualified name as is
+				xml_string_view qname = node->getNodeName();
+				auto pos = qname.find(XERCESC_LIT(':'));
+				return pos == qname.npos ? qname : qname.substr(pos + 1);
+			}
+
+			/// namespace declarations and xml:* attributes keep their names
+			static bool is_reserved(const xercesc::DOMAttr * attr)
+			{
+				xml_string_view ns = attr->getNamespaceURI() ? attr->getNamespaceURI() : XERCESC_LIT("");
+				if (ns == XERCESC_LIT("http://www.w3.org/2000/xmlns/") or ns == XERCESC_LIT("http://www.w3.org/XML/1998/namespace")) return true;
+
+				// DOM level 1 attributes
+				xml_string_view name = attr->getNodeName();
+				return name == XERCESC_LIT("xmlns") or name.substr(0, 6) == XERCESC_LIT("xmlns:") or name.substr(0, 4) == XERCESC_LIT("xml:");
+			}
+
+			/// prefix:local or just local for empty prefix, points into reused buffer
+			const XMLCh * qualified_name(xml_string_view local)
+			{
+				m_name.clear();
+				if (not m_prefix.empty())
+				{
+					m_name.append(m_prefix);
+					m_name.append(1, XERCESC_LIT(':'));
+				}
+
+				m_name.append(local);
+				return m_name.c_str();
+			}
+
+			/// unprefixed attributes are in no namespace
+			const XMLCh * attribute_namespace() const { return m_prefix.empty() ? nullptr : m_namespace_uri.c_str(); }
+
+			[[noreturn]] void throw_collision(xml_string_view local) const
+			{
+				xml_string name = m_prefix.empty() ? xml_string() : m_prefix + XERCESC_LIT(':');
+				name.append(local);
+				throw std::invalid_argument("xercesc_utils::rename_subtree: several attributes are renamed to " + to_utf8(name));
+			}
+
+			void check_attribute_names(const xercesc::DOMElement * element);
+			xercesc::DOMElement * rebuild_element(const xercesc::DOMElement * element);
+
+		public:
+			subtree_renamer(xercesc::DOMDocument * doc, const xml_string & namespace_uri, const xml_string & prefix)
+			    : m_doc(doc), m_namespace_uri(namespace_uri), m_prefix(prefix) {}
+
+			xercesc::DOMAttr * rename_attribute(xercesc::DOMAttr * attr);
+			xercesc::DOMElement * rename_element(xercesc::DOMElement * element);
+
+			void check_subtree(const xercesc::DOMElement * element);
+			void check_attribute(const xercesc::DOMAttr * attr);
+
+			xercesc::DOMElement * rename_in_place(xercesc::DOMElement * element);
+			xercesc::DOMElement * rebuild(xercesc::DOMElement * element);
+		};
+
+		/// renamed attributes get the same namespace, so their local names must differ, reserved attributes keep names
+		void subtree_renamer::check_attribute_names(const xercesc::DOMElement * element)
 		{
-			name.assign(node_name);
-			return name;
+			m_names.clear();
+			auto * attrs = element->getAttributes();
+			for (XMLSize_t i = 0, count = attrs ? attrs->getLength() : 0; i < count; ++i)
+			{
+				auto * attr = static_cast<xercesc::DOMAttr *>(attrs->item(i));
+				if (not is_reserved(attr)) m_names.push_back(local_name(attr));
+			}
+
+			std::sort(m_names.begin(), m_names.end());
+			auto it = std::adjacent_find(m_names.begin(), m_names.end());
+			if (it != m_names.end()) throw_collision(*it);
 		}
-		else
+
+		/// subtree is checked before any modification, so failed rename leaves it intact
+		void subtree_renamer::check_subtree(const xercesc::DOMElement * element)
 		{
-			name.reserve(prefix.size() + 1 + node_name.length());
-			name.append(prefix);
-			name.append(1, XERCESC_LIT(':'));
-			name.append(node_name);
-			return name;
+			const xercesc::DOMElement * current = element;
+			for (;;)
+			{
+				check_attribute_names(current);
+				if (auto * child = current->getFirstElementChild())
+				{
+					current = child;
+					continue;
+				}
+
+				while (current != element and not current->getNextElementSibling())
+					current = static_cast<const xercesc::DOMElement *>(current->getParentNode());
+
+				if (current == element) return;
+				current = current->getNextElementSibling();
+			}
 		}
-	}
 
+		void subtree_renamer::check_attribute(const xercesc::DOMAttr * attr)
+		{
+			auto * owner = attr->getOwnerElement();
+			if (not owner or is_reserved(attr)) return;
 
-	xercesc::DOMElement * rename_subtree(xercesc::DOMElement * element, const xml_string & namespace_uri, const xml_string & prefix)
-	{
-		if (not element) throw std::invalid_argument("xercesc_utils::rename_subtree: element is null");
+			auto local = local_name(attr);
+			auto * attrs = owner->getAttributes();
+			for (XMLSize_t i = 0, count = attrs->getLength(); i < count; ++i)
+			{
+				auto * other = static_cast<xercesc::DOMAttr *>(attrs->item(i));
+				if (other == attr or local_name(other) != local) continue;
 
-		auto * doc = element->getOwnerDocument();
-		for (auto * node = element->getFirstChild(); node; node = node->getNextSibling())
+				// renaming into the name other already has replaces it
+				xml_string_view other_ns = other->getNamespaceURI() ? other->getNamespaceURI() : XERCESC_LIT("");
+				xml_string_view target_ns = attribute_namespace() ? attribute_namespace() : XERCESC_LIT("");
+				if (other->getLocalName() and other_ns == target_ns) throw_collision(local);
+			}
+		}
+
+		xercesc::DOMAttr * subtree_renamer::rename_attribute(xercesc::DOMAttr * attr)
+		{
+			if (is_reserved(attr)) return attr;
+
+			auto * name = qualified_name(local_name(attr));
+			return static_cast<xercesc::DOMAttr *>(m_doc->renameNode(attr, attribute_namespace(), name));
+		}
+
+		xercesc::DOMElement * subtree_renamer::rename_element(xercesc::DOMElement * element)
+		{
+			// attribute map can be reordered by renaming, attributes are collected first
+			m_attrs.clear();
+			auto * attrs = element->getAttributes();
+			for (XMLSize_t i = 0, count = attrs ? attrs->getLength() : 0; i < count; ++i)
+				m_attrs.push_back(static_cast<xercesc::DOMAttr *>(attrs->item(i)));
+
+			for (auto * attr : m_attrs)
+				rename_attribute(attr);
+
+			auto * name = qualified_name(local_name(element));
+			return static_cast<xercesc::DOMElement *>(m_doc->renameNode(element, m_namespace_uri.c_str(), name));
+		}
+
+		xercesc::DOMElement * subtree_renamer::rename_in_place(xercesc::DOMElement * element)
+		{
+			// post order without stack: children are renamed before parent,
+			// renameNode can replace DOM level 1 element with new one, so next sibling and parent are taken beforehand
+			xercesc::DOMElement * current = element;
+			for (;;)
+			{
+				while (auto * child = current->getFirstElementChild())
+					current = child;
+
+				for (;;)
+				{
+					auto * next = current == element ? nullptr : current->getNextElementSibling();
+					auto * parent = current->getParentNode();
+					auto * renamed = rename_element(current);
+
+					if (current == element) return renamed;
+					if (next)
+					{
+						current = next;
+						break;
+					}
+
+					current = static_cast<xercesc::DOMElement *>(parent);
+				}
+			}
+		}
+
+		xercesc::DOMElement * subtree_renamer::rebuild_element(const xercesc::DOMElement * element)
+		{
+			auto * copy = m_doc->createElementNS(m_namespace_uri.c_str(), qualified_name(local_name(element)));
+
+			auto * attrs = element->getAttributes();
+			for (XMLSize_t i = 0, count = attrs ? attrs->getLength() : 0; i < count; ++i)
+			{
+				auto * attr = static_cast<xercesc::DOMAttr *>(attrs->item(i));
+				if (is_reserved(attr) and not attr->getNamespaceURI()) // DOM level 1 xmlns:p, xml:lang
+					copy->setAttribute(attr->getNodeName(), attr->getNodeValue());
+				else if (is_reserved(attr))
+					copy->setAttributeNS(attr->getNamespaceURI(), attr->getNodeName(), attr->getNodeValue());
+				else
+					copy->setAttributeNS(attribute_namespace(), qualified_name(local_name(attr)), attr->getNodeValue());
+			}
+
+			return copy;
+		}
+
+		xercesc::DOMElement * subtree_renamer::rebuild(xercesc::DOMElement * element)
 		{
-			auto type = node->getNodeType();
-			if (type == node->ELEMENT_NODE)
-				rename_subtree(static_cast<xercesc::DOMElement *>(node), namespace_uri, prefix);
-			else if (type == node->ATTRIBUTE_NODE)
+			struct frame
+			{
+				xercesc::DOMNode * next_child;
+				xercesc::DOMElement * copy;
+			};
+
+			auto * root = rebuild_element(element);
+			std::vector<frame> stack;
+			stack.push_back({element->getFirstChild(), root});
+
+			while (not stack.empty())
 			{
-				auto * attr = static_cast<xercesc::DOMAttr *>(node);
-				xml_string attr_name = prefix_name(node->getNodeName(), prefix);
-				doc->renameNode(attr, namespace_uri.data(), attr_name.c_str());
+				auto & top = stack.back();
+				auto * node = top.next_child;
+				if (not node)
+				{
+					stack.pop_back();
+					continue;
+				}
+
+				top.next_child = node->getNextSibling();
+				auto * copy = top.copy;
+				if (node->getNodeType() == xercesc::DOMNode::ELEMENT_NODE)
+				{
+					auto * child = rebuild_element(static_cast<xercesc::DOMElement *>(node));
+					copy->appendChild(child);
+					stack.push_back({node->getFirstChild(), child});
+				}
+				else // text, comments, etc. are moved as is
+					copy->appendChild(node);
 			}
+
+			if (auto * parent = element->getParentNode())
+				parent->replaceChild(root, element);
+
+			element->release();
+			return root;
 		}
+	} // 'anonymous' namespace
+
+	xercesc::DOMElement * rename_subtree(xercesc::DOMElement * element, const xml_string & namespace_uri, const xml_string & prefix, rename_mode mode /* = rename_mode::in_place */)
+	{
+		if (not element) throw std::invalid_argument("xercesc_utils::rename_subtree: element is null");
+
+		try
+		{
+			subtree_renamer renamer(element->getOwnerDocument(), namespace_uri, prefix);
+			renamer.check_subtree(element);
+			auto * renamed = mode == rename_mode::rebuild ? renamer.rebuild(element) : renamer.rename_in_place(element);
 
-		xml_string node_name = prefix_name(element->getNodeName(), prefix);
-		return static_cast<xercesc::DOMElement *>(doc->renameNode(element, namespace_uri.data(), node_name.c_str()));
+			invalidate_namespace_cache(renamed);
+			return renamed;
+		}
+		catch (xercesc::DOMException & ex)
+		{
+			auto err = xercesc_utils::to_utf8(ex.getMessage());
+			std::throw_with_nested(std::runtime_error(std::move(err)));
+		}
 	}
 
-	xercesc::DOMNode * rename_subtree(xercesc::DOMNode * node, const xml_string & namespace_uri, const xml_string & prefix)
+	xercesc::DOMNode * rename_subtree(xercesc::DOMNode * node, const xml_string & namespace_uri, const xml_string & prefix, rename_mode mode /* = rename_mode::in_place */)
 	{
 		if (not node) throw std::invalid_argument("xercesc_utils::rename_subtree: node is null");
 
 		auto type = node->getNodeType();
 		if (type == node->ELEMENT_NODE)
-			return rename_subtree(node, namespace_uri, prefix);
+			return rename_subtree(static_cast<xercesc::DOMElement *>(node), namespace_uri, prefix, mode);
 		else if (type == node->ATTRIBUTE_NODE)
 		{
-			auto * doc = node->getOwnerDocument();
-			auto * attr = static_cast<xercesc::DOMAttr *>(node);
-			xml_string attr_name = prefix_name(node->getNodeName(), prefix);
-			return doc->renameNode(attr, namespace_uri.data(), attr_name.c_str());
+			try
+			{
+				subtree_renamer renamer(node->getOwnerDocument(), namespace_uri, prefix);
+				renamer.check_attribute(static_cast<xercesc::DOMAttr *>(node));
+				auto * renamed = renamer.rename_attribute(static_cast<xercesc::DOMAttr *>(node));
+
+				invalidate_namespace_cache(renamed);
+				return renamed;
+			}
+			catch (xercesc::DOMException & ex)
+			{
+				auto err = xercesc_utils::to_utf8(ex.getMessage());
+				std::throw_with_nested(std::runtime_error(std::move(err)));
+			}
 		}
 
 		return node;
 	}
 
-	xercesc::DOMElement * find_xpath(xercesc::DOMElement * element, const xml_string & path)
+	/************************************************************************/
+	/*                     compiled xpath cache                             */
+	/************************************************************************/
+	namespace
 	{
-		if (not element) return nullptr;
-		auto * doc = element->getOwnerDocument();
+		class xpath_expression_cache
+		{
+		public:
+			struct entry
+			{
+				xml_string key;
+				DOMXPathExpressionPtr expression;
+				// Xerces does not promise DOMXPathExpression::evaluate is reentrant, evaluations of one expression are serialized
+				std::mutex mutex;
+			};
 
-		auto * resolver = get_associated_resolver(doc);
-		if (resolver)
-			return find_xpath(element, path, resolver);
-		else
+			using entry_ptr = std::shared_ptr<entry>;
+
+		private:
+			using lru_list = std::list<entry_ptr>;
+
+			mutable std::mutex m_mutex;
+			lru_list m_lru; // most recently used first
+			std::unordered_map<xml_string_view, lru_list::iterator> m_index; // keys are views of entry keys
+			std::atomic_size_t m_capacity = 256;
+			std::uint64_t m_hits = 0, m_misses = 0;
+
+		private:
+			void shrink(std::size_t capacity);
+
+		public:
+			std::size_t capacity() const noexcept { return m_capacity.load(std::memory_order_relaxed); }
+			void set_capacity(std::size_t capacity);
+
+			entry_ptr find(xml_string_view key);
+			/// returns already cached entry, if same key was inserted concurrently
+			entry_ptr insert(entry_ptr new_entry);
+
+			xpath_cache_statistics statistics() const;
+			void clear();
+		};
+
+		void xpath_expression_cache::shrink(std::size_t capacity)
+		{
+			while (m_lru.size() > capacity)
+			{
+				m_index.erase(m_lru.back()->key);
+				m_lru.pop_back();
+			}
+		}
+
+		void xpath_expression_cache::set_capacity(std::size_t capacity)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_capacity = capacity;
+			shrink(capacity);
+		}
+
+		auto xpath_expression_cache::find(xml_string_view key) -> entry_ptr
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto it = m_index.find(key);
+			if (it == m_index.end())
+			{
+				++m_misses;
+				return nullptr;
+			}
+
+			++m_hits;
+			m_lru.splice(m_lru.begin(), m_lru, it->second);
+			return *it->second;
+		}
+
+		auto xpath_expression_cache::insert(entry_ptr new_entry) -> entry_ptr
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto it = m_index.find(new_entry->key);
+			if (it != m_index.end()) return *it->second;
+
+			auto capacity = m_capacity.load(std::memory_order_relaxed);
+			if (not capacity) return new_entry;
+
+			shrink(capacity - 1);
+			m_lru.push_front(new_entry);
+			m_index.emplace(new_entry->key, m_lru.begin());
+			return new_entry;
+		}
+
+		xpath_cache_statistics xpath_expression_cache::statistics() const
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return {m_hits, m_misses, m_lru.size(), capacity()};
+		}
+
+		void xpath_expression_cache::clear()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_index.clear();
+			m_lru.clear();
+		}
+
+		xpath_expression_cache g_xpath_cache;
+
+		/// prefixes of qualified names in xpath: NCName before single ':', string literals are skipped
+		void collect_xpath_prefixes(xml_string_view path, std::vector<xml_string_view> & prefixes)
+		{
+			auto is_name_char = [](XMLCh ch)
+			{
+				return (ch >= 'a' and ch <= 'z') or (ch >= 'A' and ch <= 'Z') or (ch >= '0' and ch <= '9')
+				    or ch == '_' or ch == '-' or ch == '.' or ch >= 0x80;
+			};
+
+			XMLCh quote = 0;
+			for (std::size_t i = 0; i < path.size(); ++i)
+			{
+				XMLCh ch = path[i];
+				if (quote)
+				{
+					if (ch == quote) quote = 0;
+					continue;
+				}
+
+				if (ch == '\'' or ch == '"') quote = ch;
+				if (ch != ':') continue;
+
+				// axis separator: child::, descendant::, etc.
+				if (i + 1 < path.size() and path[i + 1] == ':')
+				{
+					++i;
+					continue;
+				}
+
+				auto first = i;
+				while (first and is_name_char(path[first - 1])) --first;
+
+				auto prefix = path.substr(first, i - first);
+				if (not prefix.empty() and std::find(prefixes.begin(), prefixes.end(), prefix) == prefixes.end())
+					prefixes.push_back(prefix);
+			}
+		}
+
+		/// expression text followed by \0 separated prefix/namespace pairs, default namespace goes first
+		xml_string xpath_cache_key(const xercesc::DOMElement * element, const xml_string & path, const xercesc::DOMXPathNSResolver * resolver)
+		{
+			std::vector<xml_string_view> prefixes;
+			collect_xpath_prefixes(path, prefixes);
+
+			xml_string key = path;
+			xml_string prefix_buffer;
+			auto append_binding = [&](const XMLCh * prefix)
+			{
+				auto * uri = resolver ? resolver->lookupNamespaceURI(prefix) : lookup_namespace_uri(element, prefix);
+				key += XMLCh(0);
+				if (prefix) key += prefix;
+				key += XMLCh(0);
+				if (uri) key += uri;
+			};
+
+			append_binding(nullptr);
+			for (auto prefix : prefixes)
+			{
+				prefix_buffer.assign(prefix.data(), prefix.size());
+				append_binding(prefix_buffer.c_str());
+			}
+
+			return key;
+		}
+
+		/// evaluates xpath with compiled expression from cache, without resolver namespaces in scope of element are used
+		DOMXPathResultPtr evaluate_xpath(xercesc::DOMElement * element, const xml_string & path, const xercesc::DOMXPathNSResolver * resolver,
+		                                 xercesc::DOMXPathResult::ResultType type)
 		{
-			DOMXPathNSResolverPtr resolver (doc->createNSResolver(element));
-			return find_xpath(element, path, resolver.get());
+			auto * doc = element->getOwnerDocument();
+			DOMXPathNSResolverPtr element_resolver;
+			auto compile_resolver = [&]
+			{
+				if (resolver) return resolver;
+
+				element_resolver.reset(doc->createNSResolver(element));
+				return static_cast<const xercesc::DOMXPathNSResolver *>(element_resolver.get());
+			};
+
+			if (not g_xpath_cache.capacity())
+				return DOMXPathResultPtr(doc->evaluate(path.c_str(), element, compile_resolver(), type, nullptr));
+
+			auto key = xpath_cache_key(element, path, resolver);
+			auto cached = g_xpath_cache.find(key);
+			if (not cached)
+			{
+				// compiled outside of cache lock, concurrent misses of the same key compile it twice, one copy is dropped
+				auto new_entry = std::make_shared<xpath_expression_cache::entry>();
+				new_entry->expression.reset(doc->createExpression(path.c_str(), compile_resolver()));
+				new_entry->key = std::move(key);
+				cached = g_xpath_cache.insert(std::move(new_entry));
+			}
+
+			std::lock_guard<std::mutex> lock(cached->mutex);
+			return DOMXPathResultPtr(cached->expression->evaluate(element, type, nullptr));
 		}
+	} // 'anonymous' namespace
+
+	void set_xpath_cache_capacity(std::size_t capacity)
+	{
+		g_xpath_cache.set_capacity(capacity);
+	}
+
+	auto get_xpath_cache_statistics() -> xpath_cache_statistics
+	{
+		return g_xpath_cache.statistics();
+	}
+
+	void clear_xpath_cache()
+	{
+		g_xpath_cache.clear();
+	}
+
+	xercesc::DOMElement * find_xpath(xercesc::DOMElement * element, const xml_string & path)
+	{
+		if (not element) return nullptr;
+
+		// without associated resolver namespaces in scope of element are used
+		auto * resolver = get_associated_resolver(element->getOwnerDocument());
+		return find_xpath(element, path, resolver);
 	}
 
 	xercesc::DOMElement * find_xpath(xercesc::DOMElement * element, const xml_string & path, xercesc::DOMXPathNSResolver * resolver)
 	{
 		if (not element) return nullptr;
-		auto * doc = element->getOwnerDocument();
 
 		try
 		{
-			DOMXPathResultPtr result(doc->evaluate(
-				path.c_str(), element, resolver,
-				xercesc::DOMXPathResult::ANY_UNORDERED_NODE_TYPE, nullptr));
+			auto result = evaluate_xpath(element, path, resolver, xercesc::DOMXPathResult::ANY_UNORDERED_NODE_TYPE);
 
 			if (not result) return nullptr;
 
@@ -1339,6 +2477,42 @@ namespace xercesc_utils
 	}
 
 
+	xpath_node_range::xpath_node_range(DOMXPathResultPtr result)
+	    : m_result(std::move(result))
+	{
+		m_size = m_result ? m_result->getSnapshotLength() : 0;
+	}
+
+	xercesc::DOMNode * xpath_node_range::at(std::size_t index) const
+	{
+		if (index >= m_size) throw std::out_of_range("xercesc_utils::xpath_node_range::at: index out of range");
+		return (*this)[index];
+	}
+
+	xpath_node_range select_xpath(xercesc::DOMElement * element, const xml_string & path)
+	{
+		if (not element) return {};
+
+		auto * resolver = get_associated_resolver(element->getOwnerDocument());
+		return select_xpath(element, path, resolver);
+	}
+
+	xpath_node_range select_xpath(xercesc::DOMElement * element, const xml_string & path, xercesc::DOMXPathNSResolver * resolver)
+	{
+		if (not element) return {};
+
+		try
+		{
+			return xpath_node_range(evaluate_xpath(element, path, resolver, xercesc::DOMXPathResult::ORDERED_NODE_SNAPSHOT_TYPE));
+		}
+		catch (xercesc::DOMException & ex)
+		{
+			auto err = xercesc_utils::to_utf8(ex.getMessage());
+			std::throw_with_nested(std::runtime_error(std::move(err)));
+		}
+	}
+
+
 	xercesc::DOMElement * get_xpath(xercesc::DOMElement * element, const xml_string & path)
 	{
 		if (not element) throw std::invalid_argument("xercesc_utils::get_xpath: element is null");
@@ -0,0 +1,383 @@
+﻿#include <cassert>
+#include <algorithm>
+#include <xercesc/xercesc_writer.hpp>
+
+namespace xercesc_utils
+{
+	namespace
+	{
+		const std::string_view xml_prefix = "xml";
+		const std::string_view xml_uri = "http://www.w3.org/XML/1998/namespace";
+
+		inline bool is_space(char ch)
+		{
+			return ch == ' ' or ch == '\t' or ch == '\r' or ch == '\n';
+		}
+
+		inline bool is_space(XMLCh ch)
+		{
+			return ch == ' ' or ch == '\t' or ch == '\r' or ch == '\n';
+		}
+
+		/// splits qualified name into prefix and local name
+		inline void split_name(std::string_view qualified_name, std::string_view & prefix, std::string_view & local_name)
+		{
+			auto pos = qualified_name.find(':');
+			if (pos == qualified_name.npos)
+				prefix = std::string_view(), local_name = qualified_name;
+			else
+				prefix = qualified_name.substr(0, pos), local_name = qualified_name.substr(pos + 1);
+		}
+	} // 'anonymous' namespace
+
+	xml_writer::xml_writer(utf8_output & out, save_option save_option /* = pretty_print */)
+	    : m_out(&out), m_pretty(save_option == pretty_print)
+	{
+		m_arena.reserve(1024);
+		m_elements.reserve(32);
+		m_bindings.reserve(16);
+	}
+
+	xml_writer::xml_writer(std::string & str, save_option save_option /* = pretty_print */)
+	    : m_own_output(std::in_place, str), m_out(&*m_own_output), m_pretty(save_option == pretty_print)
+	{
+		m_arena.reserve(1024);
+		m_elements.reserve(32);
+		m_bindings.reserve(16);
+	}
+
+	xml_writer::xml_writer(std::streambuf & sb, save_option save_option /* = pretty_print */)
+	    : m_own_output(std::in_place, sb), m_out(&*m_own_output), m_pretty(save_option == pretty_print)
+	{
+		m_arena.reserve(1024);
+		m_elements.reserve(32);
+		m_bindings.reserve(16);
+	}
+
+	xml_writer::xml_writer(xercesc::XMLFormatTarget & target, save_option save_option /* = pretty_print */)
+	    : m_own_output(std::in_place, target), m_out(&*m_own_output), m_pretty(save_option == pretty_print)
+	{
+		m_arena.reserve(1024);
+		m_elements.reserve(32);
+		m_bindings.reserve(16);
+	}
+
+	bool xml_writer::lookup_binding(std::string_view prefix, std::string_view & uri) const
+	{
+		for (auto it = m_bindings.rbegin(); it != m_bindings.rend(); ++it)
+		{
+			if (arena_view(it->prefix_offset, it->prefix_size) == prefix)
+			{
+				uri = arena_view(it->uri_offset, it->uri_size);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool xml_writer::is_bound(std::string_view prefix, std::string_view uri) const
+	{
+		std::string_view bound;
+		if (lookup_binding(prefix, bound)) return bound == uri;
+
+		// implicit bindings
+		if (prefix.empty()) return uri.empty();
+		if (prefix == xml_prefix) return uri == xml_uri;
+		return false;
+	}
+
+	bool xml_writer::find_prefix(std::string_view uri, std::string_view & prefix) const
+	{
+		if (uri == xml_uri)
+		{
+			prefix = xml_prefix;
+			return true;
+		}
+
+		for (auto it = m_bindings.rbegin(); it != m_bindings.rend(); ++it)
+		{
+			auto candidate = arena_view(it->prefix_offset, it->prefix_size);
+			if (candidate.empty() or arena_view(it->uri_offset, it->uri_size) != uri) continue;
+
+			// prefix can be rebound to other namespace by inner element
+			if (not is_bound(candidate, uri)) continue;
+
+			prefix = candidate;
+			return true;
+		}
+
+		return false;
+	}
+
+	std::string xml_writer::unused_prefix() const
+	{
+		std::string_view uri;
+		for (unsigned index = 1;; ++index)
+		{
+			auto prefix = "ns" + std::to_string(index);
+			if (not lookup_binding(prefix, uri)) return prefix;
+		}
+	}
+
+	void xml_writer::new_line(unsigned level)
+	{
+		if (not m_pretty) return;
+
+		if (not m_out->at_line_start())
+			m_out->append('\n');
+
+		for (unsigned i = 0; i < level; ++i)
+			m_out->append("  ");
+	}
+
+	void xml_writer::close_start_tag()
+	{
+		if (not m_start_tag_open) return;
+
+		m_out->append('>');
+		m_start_tag_open = false;
+	}
+
+	void xml_writer::write_namespace_declaration(std::string_view prefix, std::string_view uri)
+	{
+		binding_entry binding;
+		binding.prefix_offset = m_arena.size();
+		binding.prefix_size = prefix.size();
+		m_arena.append(prefix);
+		binding.uri_offset = m_arena.size();
+		binding.uri_size = uri.size();
+		m_arena.append(uri);
+		m_bindings.push_back(binding);
+
+		m_out->append(" xmlns");
+		if (not prefix.empty())
+		{
+			m_out->append(':');
+			m_out->append(prefix);
+		}
+
+		m_out->append("=\"");
+		m_out->append_escaped(uri, escape_mode::attribute);
+		m_out->append('"');
+	}
+
+	void xml_writer::write_declaration()
+	{
+		if (not m_elements.empty() or m_start_tag_open)
+			throw std::logic_error("xercesc_utils::xml_writer::write_declaration: xml declaration must be first");
+
+		m_out->append("<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"no\" ?>");
+	}
+
+	void xml_writer::start_element(std::string_view qualified_name)
+	{
+		return start_element(std::string_view(), qualified_name);
+	}
+
+	void xml_writer::start_element(std::string_view namespace_uri, std::string_view qualified_name)
+	{
+		if (qualified_name.empty()) throw std::invalid_argument("xercesc_utils::xml_writer::start_element: name is empty");
+
+		std::string_view prefix, local_name;
+		split_name(qualified_name, prefix, local_name);
+		// as DOM NAMESPACE_ERR: prefixed name requires namespace
+		if (namespace_uri.empty() and not prefix.empty())
+			throw std::invalid_argument("xercesc_utils::xml_writer::start_element: prefixed name without namespace, name = " + std::string(qualified_name));
+
+		close_start_tag();
+		new_line(static_cast<unsigned>(m_elements.size()));
+
+		// same prefix rules as create_node_ns
+		std::string_view found_prefix;
+		if (namespace_uri.empty())
+			local_name = qualified_name;
+		else if (find_prefix(namespace_uri, found_prefix))
+			prefix = found_prefix;
+		else if (is_bound(std::string_view(), namespace_uri))
+			prefix = std::string_view();
+
+		element_entry element;
+		element.bindings_size = m_bindings.size();
+		element.arena_size = m_arena.size();
+
+		// element name is kept in arena for end tag
+		element.name_offset = m_arena.size();
+		if (not prefix.empty())
+		{
+			m_arena.append(prefix);
+			m_arena.push_back(':');
+		}
+
+		m_arena.append(local_name);
+		element.name_size = m_arena.size() - element.name_offset;
+		m_elements.push_back(element);
+
+		m_out->append('<');
+		m_out->append(arena_view(element.name_offset, element.name_size));
+		m_start_tag_open = true;
+		m_prev_text = false;
+
+		if (not is_bound(prefix, namespace_uri))
+			write_namespace_declaration(prefix, namespace_uri);
+	}
+
+	void xml_writer::namespace_declaration(std::string_view prefix, std::string_view uri)
+	{
+		if (not m_start_tag_open) throw std::logic_error("xercesc_utils::xml_writer::namespace_declaration: no open start tag");
+
+		// declaration already in scope
+		if (is_bound(prefix, uri)) return;
+
+		write_namespace_declaration(prefix, uri);
+	}
+
+	template <class String>
+	void xml_writer::write_attribute(std::string_view namespace_uri, std::string_view qualified_name, const String & value)
+	{
+		if (not m_start_tag_open) throw std::logic_error("xercesc_utils::xml_writer::attribute: no open start tag");
+		if (qualified_name.empty()) throw std::invalid_argument("xercesc_utils::xml_writer::attribute: name is empty");
+
+		std::string_view prefix, local_name;
+		split_name(qualified_name, prefix, local_name);
+
+		std::string generated_prefix;
+		if (namespace_uri.empty())
+		{
+			// as DOM NAMESPACE_ERR: prefixed name requires namespace
+			if (not prefix.empty())
+				throw std::invalid_argument("xercesc_utils::xml_writer::attribute: prefixed name without namespace, name = " + std::string(qualified_name));
+			local_name = qualified_name;
+		}
+		else
+		{
+			// unprefixed attributes are not in default namespace, so unlike elements, prefix is always required
+			std::string_view found_prefix, bound_uri;
+			if (find_prefix(namespace_uri, found_prefix))
+				prefix = found_prefix;
+			else if (prefix.empty())
+				throw std::invalid_argument("xercesc_utils::xml_writer::attribute: attribute with namespace requires prefix");
+			else if (lookup_binding(prefix, bound_uri) or prefix == xml_prefix)
+			{
+				// prefix is bound to other namespace, maybe used by element name or other attribute of this tag:
+				// redeclaring it here would move them, so fresh prefix is taken
+				generated_prefix = unused_prefix();
+				prefix = generated_prefix;
+				write_namespace_declaration(prefix, namespace_uri);
+			}
+			else
+				write_namespace_declaration(prefix, namespace_uri);
+		}
+
+		m_out->append(' ');
+		if (not prefix.empty())
+		{
+			m_out->append(prefix);
+			m_out->append(':');
+		}
+
+		m_out->append(local_name);
+		m_out->append("=\"");
+		if constexpr (std::is_same_v<String, std::string_view>)
+			m_out->append_escaped(value, escape_mode::attribute);
+		else
+			m_out->append(value, escape_mode::attribute);
+		m_out->append('"');
+	}
+
+	void xml_writer::attribute(std::string_view qualified_name, std::string_view value)
+	{
+		return write_attribute(std::string_view(), qualified_name, value);
+	}
+
+	void xml_writer::attribute(std::string_view qualified_name, xml_string_view value)
+	{
+		return write_attribute(std::string_view(), qualified_name, value);
+	}
+
+	void xml_writer::attribute(std::string_view namespace_uri, std::string_view qualified_name, std::string_view value)
+	{
+		return write_attribute(namespace_uri, qualified_name, value);
+	}
+
+	void xml_writer::attribute(std::string_view namespace_uri, std::string_view qualified_name, xml_string_view value)
+	{
+		return write_attribute(namespace_uri, qualified_name, value);
+	}
+
+	template <class String>
+	void xml_writer::write_text(const String & text)
+	{
+		// element with text node is not empty even if text is dropped: <a>\n</a> as in native_save
+		close_start_tag();
+
+		// whitespace only text is replaced by pretty print formatting, as in native_save
+		if (m_pretty and std::all_of(text.begin(), text.end(), [](auto ch) { return is_space(ch); }))
+			return;
+
+		if constexpr (std::is_same_v<String, std::string_view>)
+			m_out->append_escaped(text, escape_mode::text);
+		else
+			m_out->append(text, escape_mode::text);
+
+		m_prev_text = true;
+	}
+
+	void xml_writer::text(std::string_view text)
+	{
+		return write_text(text);
+	}
+
+	void xml_writer::text(xml_string_view text)
+	{
+		return write_text(text);
+	}
+
+	void xml_writer::comment(std::string_view text)
+	{
+		close_start_tag();
+		new_line(static_cast<unsigned>(m_elements.size()));
+
+		m_out->append("<!--");
+		m_out->append(text);
+		m_out->append("-->");
+		m_prev_text = false;
+	}
+
+	void xml_writer::end_element()
+	{
+		if (m_elements.empty()) throw std::logic_error("xercesc_utils::xml_writer::end_element: no open element");
+
+		auto & element = m_elements.back();
+		if (m_start_tag_open)
+		{
+			m_out->append("/>");
+			m_start_tag_open = false;
+		}
+		else
+		{
+			// element with only text content is kept on one line
+			if (not m_prev_text) new_line(static_cast<unsigned>(m_elements.size() - 1));
+
+			m_out->append("</");
+			m_out->append(arena_view(element.name_offset, element.name_size));
+			m_out->append('>');
+		}
+
+		m_bindings.resize(element.bindings_size);
+		m_arena.resize(element.arena_size);
+		m_elements.pop_back();
+		m_prev_text = false;
+	}
+
+	void xml_writer::finish()
+	{
+		while (not m_elements.empty())
+			end_element();
+
+		if (m_pretty and not m_out->at_line_start())
+			m_out->append('\n');
+
+		m_out->flush();
+	}
+}
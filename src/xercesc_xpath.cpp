@@ -0,0 +1,745 @@
+﻿#include <algorithm>
+#include <xercesc/xercesc_xpath.hpp>
+
+namespace xercesc_utils
+{
+	namespace
+	{
+		const xml_string_view xmlns_uri = XERCESC_LIT("http://www.w3.org/2000/xmlns/");
+
+		inline xml_string_view forward_view(const XMLCh * str)
+		{
+			return str ? xml_string_view(str) : xml_string_view();
+		}
+
+		inline xml_string_view local_name(const xercesc::DOMNode * node)
+		{
+			auto * name = node->getLocalName();
+			return forward_view(name ? name : node->getNodeName());
+		}
+
+		[[noreturn]] void throw_unsupported(const xml_string & expression, std::size_t pos, const char * what)
+		{
+			std::string errmsg = "xercesc_utils::native_xpath: ";
+			errmsg += what;
+			errmsg += " at position ";
+			errmsg += std::to_string(pos);
+			errmsg += ", expression = ";
+			errmsg += to_utf8(expression);
+			throw std::invalid_argument(errmsg);
+		}
+
+		/// recursive descent parser over expression, whitespace is allowed only inside predicates
+		class xpath_parser
+		{
+			using step = native_xpath::step;
+			using predicate = native_xpath::predicate;
+			using name_test = native_xpath::name_test;
+
+			const xml_string & m_expr;
+			std::size_t m_pos = 0;
+
+		private:
+			[[noreturn]] void fail(const char * what) const { throw_unsupported(m_expr, m_pos, what); }
+
+			bool at_end() const noexcept { return m_pos >= m_expr.size(); }
+			XMLCh peek(std::size_t offset = 0) const noexcept { return m_pos + offset < m_expr.size() ? m_expr[m_pos + offset] : 0; }
+			bool accept(XMLCh ch) noexcept { if (peek() != ch) return false; ++m_pos; return true; }
+			bool accept(std::string_view token) noexcept;
+			void expect(XMLCh ch, const char * what) { if (not accept(ch)) fail(what); }
+			void skip_spaces() noexcept { while (peek() == ' ' or peek() == '\t' or peek() == '\n' or peek() == '\r') ++m_pos; }
+
+			static bool is_name_start(XMLCh ch) noexcept { return (ch >= 'a' and ch <= 'z') or (ch >= 'A' and ch <= 'Z') or ch == '_' or ch >= 0x80; }
+			static bool is_name_char(XMLCh ch) noexcept  { return is_name_start(ch) or (ch >= '0' and ch <= '9') or ch == '-' or ch == '.'; }
+
+			xml_string parse_ncname();
+			name_test parse_name_test();
+			std::size_t parse_number();
+			xml_string parse_literal();
+			predicate parse_predicate();
+			step parse_step();
+
+		public:
+			xpath_parser(const xml_string & expr) : m_expr(expr) {}
+			void parse(bool & absolute, std::vector<step> & steps);
+		};
+
+		bool xpath_parser::accept(std::string_view token) noexcept
+		{
+			if (m_expr.size() - std::min(m_pos, m_expr.size()) < token.size()) return false;
+			for (std::size_t i = 0; i < token.size(); ++i)
+				if (m_expr[m_pos + i] != static_cast<XMLCh>(token[i])) return false;
+
+			m_pos += token.size();
+			return true;
+		}
+
+		xml_string xpath_parser::parse_ncname()
+		{
+			if (not is_name_start(peek())) fail("name expected");
+
+			auto first = m_pos;
+			while (is_name_char(peek())) ++m_pos;
+			return m_expr.substr(first, m_pos - first);
+		}
+
+		auto xpath_parser::parse_name_test() -> name_test
+		{
+			name_test test;
+			if (accept('*'))
+			{
+				test.any_name = true;
+				return test;
+			}
+
+			test.local_name = parse_ncname();
+			if (peek() == ':' and peek(1) != ':')
+			{
+				++m_pos;
+				test.prefix = std::move(test.local_name);
+				test.has_prefix = true;
+
+				if (accept('*'))
+					test.any_name = true, test.local_name.clear();
+				else
+					test.local_name = parse_ncname();
+			}
+
+			return test;
+		}
+
+		std::size_t xpath_parser::parse_number()
+		{
+			if (not (peek() >= '0' and peek() <= '9')) fail("number expected");
+
+			std::size_t number = 0;
+			while (peek() >= '0' and peek() <= '9')
+				number = number * 10 + (m_expr[m_pos++] - '0');
+
+			return number;
+		}
+
+		xml_string xpath_parser::parse_literal()
+		{
+			XMLCh quote = peek();
+			if (quote != '\'' and quote != '"') fail("string literal expected");
+
+			auto first = ++m_pos;
+			while (not at_end() and peek() != quote) ++m_pos;
+			if (at_end()) fail("unterminated string literal");
+
+			return m_expr.substr(first, m_pos++ - first);
+		}
+
+		auto xpath_parser::parse_predicate() -> predicate
+		{
+			predicate pred;
+			skip_spaces();
+
+			if (peek() >= '0' and peek() <= '9')
+			{
+				pred.kind = predicate::position;
+				pred.number = parse_number();
+				if (not pred.number) fail("positions start from 1");
+			}
+			else if (accept("last()"))
+			{
+				pred.kind = predicate::last;
+				skip_spaces();
+				if (accept('-'))
+				{
+					skip_spaces();
+					pred.number = parse_number();
+				}
+			}
+			else if (accept('@'))
+			{
+				pred.name = parse_name_test();
+				skip_spaces();
+
+				pred.kind = predicate::attribute_exists;
+				if (accept("!="))
+					pred.kind = predicate::attribute_differs;
+				else if (accept('='))
+					pred.kind = predicate::attribute_equals;
+
+				if (pred.kind != predicate::attribute_exists)
+				{
+					skip_spaces();
+					pred.value = parse_literal();
+				}
+			}
+			else
+			{
+				if (accept("text()"))
+					pred.kind = predicate::text_equals;
+				else
+				{
+					pred.kind = predicate::child_equals;
+					pred.name = parse_name_test();
+				}
+
+				skip_spaces();
+				expect('=', "'=' expected");
+				skip_spaces();
+				pred.value = parse_literal();
+			}
+
+			skip_spaces();
+			expect(']', "']' expected");
+			return pred;
+		}
+
+		auto xpath_parser::parse_step() -> step
+		{
+			step st;
+			if (accept('.'))
+			{
+				if (peek() == '.') fail("parent axis is not supported");
+
+				st.step_axis = native_xpath::axis::self;
+				return st;
+			}
+
+			if (accept('@'))
+			{
+				st.kind = native_xpath::node_kind::attribute;
+				st.name = parse_name_test();
+			}
+			else if (accept("text()"))
+				st.kind = native_xpath::node_kind::text;
+			else
+			{
+				if (accept("child::")) {}
+				st.name = parse_name_test();
+			}
+
+			while (accept('['))
+			{
+				st.predicates.push_back(parse_predicate());
+				st.positional |= st.predicates.back().positional();
+			}
+
+			return st;
+		}
+
+		void xpath_parser::parse(bool & absolute, std::vector<step> & steps)
+		{
+			bool descendant = false;
+			if (accept('/'))
+			{
+				absolute = true;
+				descendant = accept('/');
+				// "/" alone selects document node
+				if (at_end() and not descendant) return;
+			}
+
+			for (;;)
+			{
+				steps.push_back(parse_step());
+				if (descendant)
+				{
+					if (steps.back().step_axis == native_xpath::axis::self) fail("'//.' is not supported");
+					steps.back().step_axis = native_xpath::axis::descendant;
+				}
+
+				if (at_end()) break;
+
+				expect('/', "'/' expected");
+				descendant = accept('/');
+			}
+		}
+
+		/************************************************************************/
+		/*                           evaluation                                 */
+		/************************************************************************/
+		/// name test with resolved namespace
+		struct resolved_test
+		{
+			const native_xpath::name_test * test;
+			xml_string_view namespace_uri;
+			bool any_namespace;
+
+			bool matches(const xercesc::DOMNode * node) const
+			{
+				if (not any_namespace and forward_view(node->getNamespaceURI()) != namespace_uri) return false;
+				return test->any_name or local_name(node) == test->local_name;
+			}
+		};
+
+		struct resolved_predicate
+		{
+			const native_xpath::predicate * pred;
+			resolved_test name;
+		};
+
+		struct resolved_step
+		{
+			const native_xpath::step * st;
+			resolved_test name;
+			std::vector<resolved_predicate> predicates;
+		};
+
+		class xpath_evaluator
+		{
+			using node_list = std::vector<xercesc::DOMNode *>;
+
+			xercesc::DOMNode * m_context;
+			const xercesc::DOMXPathNSResolver * m_resolver;
+			std::vector<resolved_step> m_steps;
+
+		private:
+			resolved_test resolve(const native_xpath::name_test & test) const;
+
+			static bool is_parent(const xercesc::DOMNode * node)
+			{
+				auto type = node->getNodeType();
+				return type == xercesc::DOMNode::ELEMENT_NODE or type == xercesc::DOMNode::DOCUMENT_NODE;
+			}
+
+			static const xercesc::DOMNode * parent_of(const xercesc::DOMNode * node)
+			{
+				if (node->getNodeType() == xercesc::DOMNode::ATTRIBUTE_NODE)
+					return static_cast<const xercesc::DOMAttr *>(node)->getOwnerElement();
+				return node->getParentNode();
+			}
+
+			static bool is_ancestor(const xercesc::DOMNode * ancestor, const xercesc::DOMNode * node)
+			{
+				for (node = parent_of(node); node; node = parent_of(node))
+					if (node == ancestor) return true;
+				return false;
+			}
+
+			static bool document_order(const xercesc::DOMNode * op1, const xercesc::DOMNode * op2);
+
+			/// does node match step node test, step predicates are not checked
+			static bool matches(const resolved_step & st, const xercesc::DOMNode * node);
+			static bool check(const resolved_predicate & pred, const xercesc::DOMNode * node, std::size_t position, std::size_t size);
+			static void filter(const resolved_step & st, node_list & nodes);
+
+			/// nodes selected by step from parent, attributes are not considered
+			static void select_children(const resolved_step & st, const xercesc::DOMNode * parent, node_list & result);
+			static void select_attributes(const resolved_step & st, const xercesc::DOMNode * parent, node_list & result);
+
+			/// steps append selected nodes in document order, return true if some of them are descendants of others
+			bool child_step(const resolved_step & st, const node_list & contexts, bool nested, std::size_t limit, node_list & result) const;
+			bool descendant_step(const resolved_step & st, const node_list & contexts, bool nested, std::size_t limit, node_list & result) const;
+
+		public:
+			xpath_evaluator(xercesc::DOMNode * context, const xercesc::DOMXPathNSResolver * resolver, const std::vector<native_xpath::step> & steps);
+			node_list evaluate(bool absolute, std::size_t limit) const;
+		};
+
+		xpath_evaluator::xpath_evaluator(xercesc::DOMNode * context, const xercesc::DOMXPathNSResolver * resolver, const std::vector<native_xpath::step> & steps)
+		    : m_context(context), m_resolver(resolver)
+		{
+			m_steps.reserve(steps.size());
+			for (auto & st : steps)
+			{
+				resolved_step rst {&st, resolve(st.name), {}};
+				rst.predicates.reserve(st.predicates.size());
+				for (auto & pred : st.predicates)
+					rst.predicates.push_back({&pred, resolve(pred.name)});
+
+				m_steps.push_back(std::move(rst));
+			}
+		}
+
+		resolved_test xpath_evaluator::resolve(const native_xpath::name_test & test) const
+		{
+			resolved_test result {&test, {}, false};
+			// * matches any namespace, prefix:* - any name in namespace, unprefixed name is in no namespace
+			if (not test.has_prefix)
+			{
+				result.any_namespace = test.any_name;
+				return result;
+			}
+
+			auto * uri = m_resolver ? m_resolver->lookupNamespaceURI(test.prefix.c_str()) : lookup_namespace_uri(m_context, test.prefix.c_str());
+			if (not uri) throw xml_namespace_exception("xml namespace not found, prefix = " + to_utf8(test.prefix));
+
+			result.namespace_uri = uri;
+			return result;
+		}
+
+		bool xpath_evaluator::document_order(const xercesc::DOMNode * op1, const xercesc::DOMNode * op2)
+		{
+			if (op1 == op2) return false;
+
+			std::vector<const xercesc::DOMNode *> chain1, chain2;
+			for (auto * node = op1; node; node = parent_of(node)) chain1.push_back(node);
+			for (auto * node = op2; node; node = parent_of(node)) chain2.push_back(node);
+
+			auto it1 = chain1.rbegin(), it2 = chain2.rbegin();
+			while (it1 != chain1.rend() and it2 != chain2.rend() and *it1 == *it2) ++it1, ++it2;
+
+			// ancestor goes before descendants
+			if (it1 == chain1.rend()) return true;
+			if (it2 == chain2.rend()) return false;
+
+			// attributes go right after owner element, before its children
+			bool attr1 = (*it1)->getNodeType() == xercesc::DOMNode::ATTRIBUTE_NODE;
+			bool attr2 = (*it2)->getNodeType() == xercesc::DOMNode::ATTRIBUTE_NODE;
+			if (attr1 != attr2) return attr1;
+
+			if (attr1)
+			{
+				auto * attrs = static_cast<const xercesc::DOMAttr *>(*it1)->getOwnerElement()->getAttributes();
+				for (XMLSize_t i = 0, count = attrs->getLength(); i < count; ++i)
+				{
+					auto * attr = attrs->item(i);
+					if (attr == *it1) return true;
+					if (attr == *it2) return false;
+				}
+
+				return false;
+			}
+
+			for (auto * node = (*it1)->getNextSibling(); node; node = node->getNextSibling())
+				if (node == *it2) return true;
+
+			return false;
+		}
+
+		bool xpath_evaluator::matches(const resolved_step & st, const xercesc::DOMNode * node)
+		{
+			switch (st.st->kind)
+			{
+				case native_xpath::node_kind::element:
+					return node->getNodeType() == xercesc::DOMNode::ELEMENT_NODE and st.name.matches(node);
+				case native_xpath::node_kind::text:
+				{
+					auto type = node->getNodeType();
+					return type == xercesc::DOMNode::TEXT_NODE or type == xercesc::DOMNode::CDATA_SECTION_NODE;
+				}
+				case native_xpath::node_kind::attribute:
+					// namespace declarations are not attributes in xpath data model
+					return forward_view(node->getNamespaceURI()) != xmlns_uri and st.name.matches(node);
+			}
+
+			return false;
+		}
+
+		bool xpath_evaluator::check(const resolved_predicate & rpred, const xercesc::DOMNode * node, std::size_t position, std::size_t size)
+		{
+			using predicate = native_xpath::predicate;
+			auto & pred = *rpred.pred;
+
+			switch (pred.kind)
+			{
+				case predicate::position:
+					return position == pred.number;
+
+				case predicate::last:
+					return size > pred.number and position == size - pred.number;
+
+				case predicate::attribute_exists:
+				case predicate::attribute_equals:
+				case predicate::attribute_differs:
+				{
+					if (node->getNodeType() != xercesc::DOMNode::ELEMENT_NODE) return false;
+
+					auto * attrs = node->getAttributes();
+					for (XMLSize_t i = 0, count = attrs->getLength(); i < count; ++i)
+					{
+						auto * attr = attrs->item(i);
+						if (forward_view(attr->getNamespaceURI()) == xmlns_uri or not rpred.name.matches(attr)) continue;
+
+						// as in xpath, [@a!='v'] is true if there is an attribute with other value
+						if (pred.kind == predicate::attribute_exists) return true;
+						if ((forward_view(attr->getNodeValue()) == pred.value) == (pred.kind == predicate::attribute_equals)) return true;
+					}
+
+					return false;
+				}
+
+				case predicate::text_equals:
+				case predicate::child_equals:
+				{
+					for (auto * child = node->getFirstChild(); child; child = child->getNextSibling())
+					{
+						auto type = child->getNodeType();
+						if (pred.kind == predicate::text_equals)
+						{
+							if ((type == xercesc::DOMNode::TEXT_NODE or type == xercesc::DOMNode::CDATA_SECTION_NODE)
+							    and forward_view(child->getNodeValue()) == pred.value)
+								return true;
+						}
+						else if (type == xercesc::DOMNode::ELEMENT_NODE and rpred.name.matches(child)
+						         and forward_view(child->getTextContent()) == pred.value)
+							return true;
+					}
+
+					return false;
+				}
+			}
+
+			return false;
+		}
+
+		void xpath_evaluator::filter(const resolved_step & st, node_list & nodes)
+		{
+			// predicates are applied in turn, positions are relative to result of previous predicate
+			for (auto & pred : st.predicates)
+			{
+				std::size_t size = nodes.size(), position = 0;
+				auto last = std::remove_if(nodes.begin(), nodes.end(), [&](auto * node) { return not check(pred, node, ++position, size); });
+				nodes.erase(last, nodes.end());
+			}
+		}
+
+		void xpath_evaluator::select_children(const resolved_step & st, const xercesc::DOMNode * parent, node_list & result)
+		{
+			auto first = result.size();
+			for (auto * child = parent->getFirstChild(); child; child = child->getNextSibling())
+			{
+				if (not matches(st, child)) continue;
+				if (not st.st->positional and not st.predicates.empty())
+				{
+					// without positional predicates nodes are checked one by one
+					bool passed = std::all_of(st.predicates.begin(), st.predicates.end(), [&](auto & pred) { return check(pred, child, 0, 0); });
+					if (not passed) continue;
+				}
+
+				result.push_back(child);
+			}
+
+			if (st.st->positional)
+			{
+				node_list group(result.begin() + first, result.end());
+				filter(st, group);
+				result.resize(first);
+				result.insert(result.end(), group.begin(), group.end());
+			}
+		}
+
+		void xpath_evaluator::select_attributes(const resolved_step & st, const xercesc::DOMNode * parent, node_list & result)
+		{
+			if (parent->getNodeType() != xercesc::DOMNode::ELEMENT_NODE) return;
+
+			auto first = result.size();
+			auto * attrs = parent->getAttributes();
+			for (XMLSize_t i = 0, count = attrs->getLength(); i < count; ++i)
+			{
+				auto * attr = attrs->item(i);
+				if (matches(st, attr)) result.push_back(attr);
+			}
+
+			if (not st.predicates.empty())
+			{
+				node_list group(result.begin() + first, result.end());
+				filter(st, group);
+				result.resize(first);
+				result.insert(result.end(), group.begin(), group.end());
+			}
+		}
+
+		bool xpath_evaluator::child_step(const resolved_step & st, const node_list & contexts, bool nested, std::size_t limit, node_list & result) const
+		{
+			bool attributes = st.st->kind == native_xpath::node_kind::attribute;
+			for (auto * context : contexts)
+			{
+				if (not is_parent(context)) continue;
+
+				if (attributes) select_attributes(st, context, result);
+				else            select_children(st, context, result);
+
+				// children of not nested contexts are already in document order
+				if (not nested and result.size() >= limit) break;
+			}
+
+			if (not nested) return false;
+
+			std::sort(result.begin(), result.end(), document_order);
+			// in document order descendants of node follow it immediately
+			for (std::size_t i = 1; i < result.size(); ++i)
+				if (is_ancestor(result[i - 1], result[i])) return true;
+
+			return false;
+		}
+
+		bool xpath_evaluator::descendant_step(const resolved_step & st, const node_list & contexts, bool nested, std::size_t limit, node_list & result) const
+		{
+			// per parent frame: nodes selected among its children, emitted when traversal reaches them
+			struct frame
+			{
+				xercesc::DOMNode * next_child;
+				std::size_t first, selected;
+				bool in_result; // parent itself was selected
+			};
+
+			bool attributes = st.st->kind == native_xpath::node_kind::attribute;
+			// attributes are never grouped: they are selected on element entry
+			bool grouped = st.st->positional and not attributes;
+
+			node_list pending;
+			std::vector<frame> stack;
+			const xercesc::DOMNode * covering = nullptr;
+			// selected elements on stack, node selected under any of them makes result nested
+			std::size_t selected_depth = 0;
+			bool result_nested = false;
+
+			auto enter = [&](const xercesc::DOMNode * parent, bool in_result)
+			{
+				// attributes go right after their element
+				if (attributes) select_attributes(st, parent, result);
+				auto first = pending.size();
+				if (grouped) select_children(st, parent, pending);
+				stack.push_back({parent->getFirstChild(), first, first, in_result});
+				selected_depth += in_result;
+			};
+
+			for (auto * context : contexts)
+			{
+				if (not is_parent(context)) continue;
+				// nested contexts are covered by traversal of their ancestor
+				if (nested and covering and is_ancestor(covering, context)) continue;
+				covering = context;
+
+				enter(context, false);
+				while (not stack.empty())
+				{
+					if (result.size() >= limit) return result_nested;
+
+					auto & top = stack.back();
+					auto * node = top.next_child;
+					if (not node)
+					{
+						pending.resize(top.first);
+						selected_depth -= top.in_result;
+						stack.pop_back();
+						continue;
+					}
+
+					top.next_child = node->getNextSibling();
+					bool selected = false;
+					if (grouped)
+					{
+						selected = top.selected < pending.size() and pending[top.selected] == node;
+						if (selected) result.push_back(pending[top.selected++]);
+					}
+					else if (not attributes and matches(st, node))
+					{
+						selected = std::all_of(st.predicates.begin(), st.predicates.end(), [&](auto & pred) { return check(pred, node, 0, 0); });
+						if (selected) result.push_back(node);
+					}
+
+					if (selected and selected_depth) result_nested = true;
+					if (node->getNodeType() == xercesc::DOMNode::ELEMENT_NODE)
+						enter(node, selected);
+				}
+			}
+
+			return result_nested;
+		}
+
+		auto xpath_evaluator::evaluate(bool absolute, std::size_t limit) const -> node_list
+		{
+			node_list contexts, result;
+			if (absolute)
+			{
+				auto * doc = m_context->getNodeType() == xercesc::DOMNode::DOCUMENT_NODE ? m_context : m_context->getOwnerDocument();
+				contexts.push_back(doc);
+			}
+			else
+				contexts.push_back(m_context);
+
+			// context list is always in document order, nested - some contexts can be descendants of others
+			bool nested = false;
+			for (std::size_t i = 0; i < m_steps.size() and not contexts.empty(); ++i)
+			{
+				auto & st = m_steps[i];
+				// only last step may stop early
+				auto step_limit = i + 1 == m_steps.size() ? limit : std::size_t(-1);
+
+				result.clear();
+				switch (st.st->step_axis)
+				{
+					case native_xpath::axis::self:
+						continue;
+					case native_xpath::axis::child:
+						nested = child_step(st, contexts, nested, step_limit, result);
+						break;
+					case native_xpath::axis::descendant:
+						nested = descendant_step(st, contexts, nested, step_limit, result);
+						break;
+				}
+
+				contexts.swap(result);
+			}
+
+			if (contexts.size() > limit) contexts.resize(limit);
+			return contexts;
+		}
+	} // 'anonymous' namespace
+
+	native_xpath::native_xpath(xml_string expression)
+	    : m_expression(std::move(expression))
+	{
+		parse();
+	}
+
+	void native_xpath::parse()
+	{
+		if (m_expression.empty()) throw std::invalid_argument("xercesc_utils::native_xpath: expression is empty");
+
+		xpath_parser parser(m_expression);
+		parser.parse(m_absolute, m_steps);
+	}
+
+	std::vector<xercesc::DOMNode *> native_xpath::evaluate(xercesc::DOMNode * context, const xercesc::DOMXPathNSResolver * resolver, std::size_t limit) const
+	{
+		if (not context) return {};
+
+		xpath_evaluator evaluator(context, resolver, m_steps);
+		return evaluator.evaluate(m_absolute, limit);
+	}
+
+	std::vector<xercesc::DOMNode *> native_xpath::select(xercesc::DOMNode * context) const
+	{
+		if (not context) return {};
+
+		auto * doc = context->getNodeType() == xercesc::DOMNode::DOCUMENT_NODE ? context : context->getOwnerDocument();
+		return evaluate(context, get_associated_resolver(doc), std::size_t(-1));
+	}
+
+	std::vector<xercesc::DOMNode *> native_xpath::select(xercesc::DOMNode * context, const xercesc::DOMXPathNSResolver * resolver) const
+	{
+		return evaluate(context, resolver, std::size_t(-1));
+	}
+
+	xercesc::DOMNode * native_xpath::find(xercesc::DOMNode * context) const
+	{
+		if (not context) return nullptr;
+
+		auto * doc = context->getNodeType() == xercesc::DOMNode::DOCUMENT_NODE ? context : context->getOwnerDocument();
+		auto result = evaluate(context, get_associated_resolver(doc), 1);
+		return result.empty() ? nullptr : result.front();
+	}
+
+	xercesc::DOMNode * native_xpath::find(xercesc::DOMNode * context, const xercesc::DOMXPathNSResolver * resolver) const
+	{
+		auto result = evaluate(context, resolver, 1);
+		return result.empty() ? nullptr : result.front();
+	}
+
+	xercesc::DOMNode * native_find_xpath(xercesc::DOMNode * context, const xml_string & path)
+	{
+		return native_xpath(path).find(context);
+	}
+
+	xercesc::DOMNode * native_get_xpath(xercesc::DOMNode * context, const xml_string & path)
+	{
+		if (not context) throw std::invalid_argument("xercesc_utils::native_get_xpath: context is null");
+
+		auto * node = native_xpath(path).find(context);
+		if (not node) throw xml_path_exception(path);
+		return node;
+	}
+
+	std::vector<xercesc::DOMNode *> native_select_xpath(xercesc::DOMNode * context, const xml_string & path)
+	{
+		return native_xpath(path).select(context);
+	}
+}
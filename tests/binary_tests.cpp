@@ -0,0 +1,291 @@
+﻿#include <random>
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_binary.hpp>
+
+using namespace xercesc_utils;
+
+namespace
+{
+	using bytes = std::vector<unsigned char>;
+
+	const char base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	xml_string encode_base64(const bytes & data, bool padding = true)
+	{
+		xml_string result;
+		std::size_t i = 0;
+		for (; i + 3 <= data.size(); i += 3)
+		{
+			unsigned group = data[i] << 16 | data[i + 1] << 8 | data[i + 2];
+			for (int shift : {18, 12, 6, 0}) result += base64_alphabet[group >> shift & 63];
+		}
+
+		auto rest = data.size() - i;
+		if (rest)
+		{
+			unsigned group = data[i] << 16 | (rest == 2 ? data[i + 1] << 8 : 0);
+			result += base64_alphabet[group >> 18];
+			result += base64_alphabet[group >> 12 & 63];
+			if (rest == 2) result += base64_alphabet[group >> 6 & 63];
+			if (padding) result.append(3 - rest, '=');
+		}
+
+		return result;
+	}
+
+	xml_string encode_hex(const bytes & data, bool upper = false)
+	{
+		const char * digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+		xml_string result;
+		for (auto byte : data)
+		{
+			result += digits[byte >> 4];
+			result += digits[byte & 15];
+		}
+
+		return result;
+	}
+
+	/// plain reference decoder: whitespace is skipped, text is valid
+	bytes reference_decode_base64(const xml_string & text)
+	{
+		bytes result;
+		unsigned bits = 0, count = 0;
+		for (auto ch : text)
+		{
+			auto * pos = std::char_traits<char>::find(base64_alphabet, 64, static_cast<char>(ch));
+			if (not pos) continue;
+
+			bits = bits << 6 | unsigned(pos - base64_alphabet);
+			if (++count % 4 == 0) result.insert(result.end(), {static_cast<unsigned char>(bits >> 16), static_cast<unsigned char>(bits >> 8), static_cast<unsigned char>(bits)});
+		}
+
+		if (count % 4 == 2) result.push_back(static_cast<unsigned char>(bits >> 4));
+		if (count % 4 == 3) result.insert(result.end(), {static_cast<unsigned char>(bits >> 10), static_cast<unsigned char>(bits >> 2)});
+		return result;
+	}
+
+	bytes random_bytes(std::mt19937 & rng, std::size_t size)
+	{
+		bytes result(size);
+		for (auto & byte : result) byte = static_cast<unsigned char>(rng());
+		return result;
+	}
+
+	/// payload element with text split into parts: text node, CDATA section, text inside nested elements, in turn
+	xercesc::DOMElement * make_payload(xercesc::DOMDocument * doc, const std::vector<xml_string> & parts)
+	{
+		auto * root = doc->getDocumentElement();
+		while (auto * child = root->getFirstChild()) root->removeChild(child)->release();
+
+		for (std::size_t i = 0; i < parts.size(); ++i)
+		{
+			auto * data = parts[i].c_str();
+			switch (i % 3)
+			{
+				case 0:
+					root->appendChild(doc->createTextNode(data));
+					break;
+				case 1:
+					root->appendChild(doc->createCDATASection(data));
+					break;
+				default:
+					auto * outer = root->appendChild(doc->createElement(XERCESC_LIT("outer")));
+					outer->appendChild(doc->createElement(XERCESC_LIT("inner")))->appendChild(doc->createTextNode(data));
+			}
+		}
+
+		return root;
+	}
+
+	xercesc::DOMElement * make_payload(xercesc::DOMDocument * doc, const xml_string & text)
+	{
+		return make_payload(doc, std::vector<xml_string> {text});
+	}
+
+	bool decodes(xercesc::DOMDocument * doc, const xml_string & text, binary_encoding encoding)
+	{
+		try
+		{
+			get_text_binary(make_payload(doc, text), encoding);
+			return true;
+		}
+		catch (std::runtime_error &)
+		{
+			return false;
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(binary_tests)
+
+BOOST_AUTO_TEST_CASE(random_payloads_match_reference)
+{
+	auto doc = load("<payload/>");
+	std::mt19937 rng(42);
+
+	// sizes below and above 16 char blocks, and above output block
+	std::vector<std::size_t> sizes;
+	for (std::size_t size = 0; size <= 64; ++size) sizes.push_back(size);
+	for (std::size_t size : {255, 1000, 30000}) sizes.push_back(size);
+
+	for (auto size : sizes)
+	{
+		BOOST_TEST_CONTEXT("size = " << size)
+		{
+			auto data = random_bytes(rng, size);
+			for (bool padding : {true, false})
+			{
+				auto text = encode_base64(data, padding);
+				BOOST_REQUIRE(reference_decode_base64(text) == data);
+				BOOST_CHECK(get_text_binary(make_payload(doc.get(), text)) == data);
+			}
+
+			for (bool upper : {false, true})
+				BOOST_CHECK(get_text_binary(make_payload(doc.get(), encode_hex(data, upper)), binary_encoding::hex) == data);
+
+			// streambuf sink receives the same bytes
+			std::stringbuf sb;
+			get_text_binary(make_payload(doc.get(), encode_base64(data)), sb);
+			BOOST_CHECK(sb.str() == std::string(data.begin(), data.end()));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(payload_split_across_nodes)
+{
+	auto doc = load("<payload/>");
+	std::mt19937 rng(7);
+	auto data = random_bytes(rng, 60);
+
+	for (auto encoding : {binary_encoding::base64, binary_encoding::hex})
+	{
+		auto text = encoding == binary_encoding::hex ? encode_hex(data) : encode_base64(data);
+		for (std::size_t first = 0; first <= text.size(); ++first)
+		{
+			BOOST_TEST_CONTEXT("encoding = " << int(encoding) << ", split = " << first)
+			{
+				// text, CDATA, nested element, text
+				auto second = std::min(text.size(), first + 17);
+				auto third = std::min(text.size(), second + 5);
+				std::vector<xml_string> parts {text.substr(0, first), text.substr(first, second - first), text.substr(second, third - second), text.substr(third)};
+				BOOST_CHECK(get_text_binary(make_payload(doc.get(), parts), encoding) == data);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(whitespace_at_every_offset)
+{
+	auto doc = load("<payload/>");
+	std::mt19937 rng(3);
+	auto data = random_bytes(rng, 40);
+	const XMLCh spaces[] = {' ', '\t', '\r', '\n'};
+
+	for (auto encoding : {binary_encoding::base64, binary_encoding::hex})
+	{
+		auto text = encoding == binary_encoding::hex ? encode_hex(data) : encode_base64(data, true);
+		for (std::size_t offset = 0; offset <= text.size(); ++offset)
+		{
+			BOOST_TEST_CONTEXT("encoding = " << int(encoding) << ", offset = " << offset)
+			{
+				auto spaced = text;
+				spaced.insert(offset, 1, spaces[offset % 4]);
+				BOOST_CHECK(get_text_binary(make_payload(doc.get(), spaced), encoding) == data);
+
+				spaced.insert(offset, xml_string(offset % 20, spaces[(offset + 1) % 4]));
+				BOOST_CHECK(get_text_binary(make_payload(doc.get(), spaced), encoding) == data);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(invalid_base64_throws)
+{
+	auto doc = load("<payload/>");
+	const xml_string block = XERCESC_LIT("QUJDREVGR0hJSktM"); // 16 chars
+
+	for (const xml_string & text : {
+		xml_string(XERCESC_LIT("Q")),                 // single sextet
+		xml_string(XERCESC_LIT("QQ=")),               // incomplete padding
+		xml_string(XERCESC_LIT("Q===")),              // padding after single sextet
+		xml_string(XERCESC_LIT("=QQQ")),              // padding first
+		xml_string(XERCESC_LIT("QUJD=")),             // padding after complete group
+		xml_string(XERCESC_LIT("QQ=A")),              // data inside padding
+		xml_string(XERCESC_LIT("QQ==QQ==")),          // data after padding
+		xml_string(XERCESC_LIT("QQ== Q")),
+		block + XERCESC_LIT("QQ==") + block,          // block after padding
+		block + XERCESC_LIT("QUJ!") + block,          // invalid char after block
+		xml_string(XERCESC_LIT("QUJDREVGR0hJS-tM")),  // invalid char inside block
+	})
+	{
+		BOOST_TEST_CONTEXT("text = " << to_utf8(text))
+		{
+			BOOST_CHECK(not decodes(doc.get(), text, binary_encoding::base64));
+		}
+	}
+
+	// trailing data after padding in next node
+	BOOST_CHECK_THROW(get_text_binary(make_payload(doc.get(), std::vector<xml_string> {XERCESC_LIT("QQ=="), XERCESC_LIT("QQ")})), std::runtime_error);
+	BOOST_CHECK_THROW(get_text_binary(make_payload(doc.get(), std::vector<xml_string> {XERCESC_LIT("QQ="), XERCESC_LIT(""), XERCESC_LIT("=Q")})), std::runtime_error);
+
+	// padding split across nodes and whitespace after padding are fine
+	BOOST_CHECK(get_text_binary(make_payload(doc.get(), std::vector<xml_string> {XERCESC_LIT("QQ="), XERCESC_LIT("= \n")})) == bytes {'A'});
+}
+
+BOOST_AUTO_TEST_CASE(wide_chars_rejected)
+{
+	auto doc = load("<payload/>");
+	std::mt19937 rng(5);
+	auto data = random_bytes(rng, 30);
+
+	for (auto encoding : {binary_encoding::base64, binary_encoding::hex})
+	{
+		auto text = encoding == binary_encoding::hex ? encode_hex(data) : encode_base64(data);
+		BOOST_REQUIRE(decodes(doc.get(), text, encoding));
+
+		// units which are valid chars in low byte: both in 16 char blocks and in scalar tail
+		for (std::size_t offset = 0; offset < text.size(); ++offset)
+		{
+			for (XMLCh high : {0x0100, 0x7F00, 0xFF00})
+			{
+				BOOST_TEST_CONTEXT("encoding = " << int(encoding) << ", offset = " << offset << ", high = " << int(high))
+				{
+					auto wide = text;
+					wide[offset] = static_cast<XMLCh>(wide[offset] | high);
+					BOOST_CHECK(not decodes(doc.get(), wide, encoding));
+				}
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(invalid_hex_throws)
+{
+	auto doc = load("<payload/>");
+	const xml_string block = XERCESC_LIT("00112233445566778899aabbccddeeff"); // two 16 char blocks
+
+	for (const xml_string & text : {
+		xml_string(XERCESC_LIT("0")),
+		xml_string(XERCESC_LIT("abc")),
+		xml_string(XERCESC_LIT("a b c")),
+		block + XERCESC_LIT("f"),                     // odd count after blocks
+		XERCESC_LIT("f") + block,                     // odd count before blocks
+		block + XERCESC_LIT("0g"),
+		xml_string(XERCESC_LIT("0123456789abcdeg")),  // invalid digit inside block
+	})
+	{
+		BOOST_TEST_CONTEXT("text = " << to_utf8(text))
+		{
+			BOOST_CHECK(not decodes(doc.get(), text, binary_encoding::hex));
+		}
+	}
+
+	// odd digit counts in several nodes add up to even count
+	BOOST_CHECK(get_text_binary(make_payload(doc.get(), std::vector<xml_string> {XERCESC_LIT("a"), XERCESC_LIT("b0"), XERCESC_LIT("1")}), binary_encoding::hex) == (bytes {0xab, 0x01}));
+	BOOST_CHECK_THROW(get_text_binary(make_payload(doc.get(), std::vector<xml_string> {XERCESC_LIT("a"), XERCESC_LIT("b0")}), binary_encoding::hex), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
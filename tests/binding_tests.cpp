@@ -0,0 +1,155 @@
+﻿#include <boost/test/unit_test.hpp>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_binding.hpp>
+
+using namespace xercesc_utils;
+
+namespace
+{
+	struct person
+	{
+		std::string name;
+		int age = 0;
+		double score = 0;
+		bool active = false;
+		long id = 0;
+		std::string flag;
+		std::optional<std::string> email;
+		std::optional<int> rank;
+	};
+
+	/// p and q are bound to one namespace: aliased paths must reach the same elements
+	struct aliased
+	{
+		std::string name;
+		int age = 0;
+	};
+}
+
+template <> struct xercesc_utils::xml_binding<person>
+{
+	static constexpr xml_field fields[] = {
+		bind_field<&person::name>("p:info/p:name"),
+		bind_field<&person::age>("p:info/p:age"),
+		bind_field<&person::score>("p:score"),
+		bind_field<&person::active>("p:info/@active"),
+		bind_field<&person::id>("@id"),
+		bind_field<&person::flag>("@m:flag"),
+		bind_field<&person::email>("p:contacts/m:email"),
+		bind_field<&person::rank>("p:rank"),
+	};
+};
+
+template <> struct xercesc_utils::xml_binding<aliased>
+{
+	static constexpr xml_field fields[] = {
+		bind_field<&aliased::name>("p:info/p:name"),
+		bind_field<&aliased::age>("q:info/q:age"),
+	};
+};
+
+BOOST_AUTO_TEST_SUITE(binding_tests)
+
+BOOST_AUTO_TEST_CASE(save_and_load_round_trip)
+{
+	auto doc = load(R"(<p:person xmlns:p="urn:p" xmlns:m="urn:m"/>)");
+	auto * root = doc->getDocumentElement();
+
+	person saved {"Ann & Bob", 42, 1.5, true, 7, "yes", std::string("ann@example.com"), std::nullopt};
+	save_struct(doc.get(), saved);
+
+	// written as path helpers would write it, empty optional is not written
+	BOOST_CHECK_EQUAL(get_path_text(root, "p:info/p:name"), "Ann & Bob");
+	BOOST_CHECK_EQUAL(get_path_text(root, "p:info/p:age"), "42");
+	BOOST_CHECK_EQUAL(get_attribute_text(get_path(root, "p:info"), "active"), "true");
+	BOOST_CHECK_EQUAL(get_attribute_text(root, "m:flag"), "yes");
+	BOOST_CHECK_EQUAL(get_path_text(root, "p:contacts/m:email"), "ann@example.com");
+	BOOST_CHECK(not find_path(root, "p:rank"));
+
+	auto loaded = load_struct<person>(load(save(doc.get())).get()->getDocumentElement());
+	BOOST_CHECK_EQUAL(loaded.name, saved.name);
+	BOOST_CHECK_EQUAL(loaded.age, saved.age);
+	BOOST_CHECK_EQUAL(loaded.score, saved.score);
+	BOOST_CHECK_EQUAL(loaded.active, saved.active);
+	BOOST_CHECK_EQUAL(loaded.id, saved.id);
+	BOOST_CHECK_EQUAL(loaded.flag, saved.flag);
+	BOOST_CHECK(loaded.email == saved.email);
+	BOOST_CHECK(not loaded.rank);
+
+	// existing values are overwritten, elements are not duplicated
+	saved.age = 43;
+	saved.rank = 1;
+	save_struct(root, saved);
+	BOOST_CHECK_EQUAL(root->getChildElementCount(), 4u);
+	BOOST_CHECK_EQUAL(load_struct<person>(root).age, 43);
+	BOOST_CHECK(load_struct<person>(root).rank == 1);
+}
+
+BOOST_AUTO_TEST_CASE(optional_fields_are_reset)
+{
+	auto doc = load(R"(<p:person xmlns:p="urn:p" xmlns:m="urn:m" id="1" m:flag="no">)"
+	                R"(<p:info active="0"><p:name>n</p:name><p:age>+3</p:age></p:info><p:score>-0.25</p:score></p:person>)");
+
+	person object;
+	object.email = "old";
+	object.rank = 5;
+	load_struct(doc.get(), object);
+
+	BOOST_CHECK_EQUAL(object.age, 3);
+	BOOST_CHECK_EQUAL(object.score, -0.25);
+	BOOST_CHECK(not object.active);
+	BOOST_CHECK(not object.email);
+	BOOST_CHECK(not object.rank);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_documents_throw)
+{
+	const char * const prefix = R"(<p:person xmlns:p="urn:p" xmlns:m="urn:m" id="1" m:flag="no"><p:score>1</p:score>)";
+
+	// missing non optional field
+	auto missing = load(std::string(prefix) + "<p:info active=\"1\"><p:name>n</p:name></p:info></p:person>");
+	BOOST_CHECK_THROW(load_struct<person>(missing->getDocumentElement()), xml_path_exception);
+
+	for (auto * age : {"x1", "", "1.5", "99999999999"})
+	{
+		BOOST_TEST_CONTEXT("age = " << age)
+		{
+			auto doc = load(std::string(prefix) + "<p:info active=\"1\"><p:name>n</p:name><p:age>" + age + "</p:age></p:info></p:person>");
+			try
+			{
+				load_struct<person>(doc->getDocumentElement());
+				BOOST_ERROR("invalid value is accepted");
+			}
+			catch (xml_path_exception &)
+			{
+				BOOST_ERROR("invalid value is reported as missing");
+			}
+			catch (std::runtime_error & ex)
+			{
+				BOOST_CHECK_THROW(std::rethrow_if_nested(ex), std::invalid_argument);
+			}
+		}
+	}
+
+	// prefix not bound in scope of element
+	auto unbound = load(R"(<person id="1"/>)");
+	BOOST_CHECK_THROW(load_struct<person>(unbound->getDocumentElement()), xml_namespace_exception);
+}
+
+BOOST_AUTO_TEST_CASE(prefix_aliases_match_one_element)
+{
+	auto doc = load(R"(<r:root xmlns:r="urn:r" xmlns:p="urn:x" xmlns:q="urn:x"><p:info><p:name>n</p:name><q:age>5</q:age></p:info></r:root>)");
+	auto * root = doc->getDocumentElement();
+
+	auto object = load_struct<aliased>(root);
+	BOOST_CHECK_EQUAL(object.name, get_path_text(root, "p:info/p:name"));
+	BOOST_CHECK_EQUAL(object.age, 5);
+
+	// save reaches existing elements through either alias
+	object.age = 6;
+	save_struct(root, object);
+	BOOST_CHECK_EQUAL(root->getChildElementCount(), 1u);
+	BOOST_CHECK_EQUAL(get_path_text(root, "p:info/p:age"), "6");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
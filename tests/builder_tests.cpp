@@ -0,0 +1,130 @@
+﻿#include <boost/test/unit_test.hpp>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_builder.hpp>
+#include <xercesc/xercesc_serializer.hpp>
+
+using namespace xercesc_utils;
+
+namespace
+{
+	// p and q are aliases of one namespace
+	const char * const skeleton = R"(<r:root xmlns:r="urn:r" xmlns:m="urn:m" xmlns:p="urn:a" xmlns:q="urn:a"><r:header><r:id>0</r:id></r:header></r:root>)";
+
+	const std::pair<const char *, const char *> fields[] =
+	{
+		{"r:root/r:header/r:id",         "42"},
+		{"r:root/r:header/r:date",       "2024-01-01"},
+		{"r:root/r:body/m:item/r:x",     "x & y"},
+		{"r:root/r:body/m:item/r:y",     "<y>"},
+		{"r:root/r:body/r:plain",        "plain"},
+		{"r:root/r:body/p:alias/p:a",    "1"},
+		{"r:root/r:body/q:alias/q:b",    "2"},   // same element as p:alias
+		{"r:root/r:body/m:item/r:x",     "x2"},  // overwrites
+		{"/r:root/r:tail",               "tail"},
+	};
+
+	std::string expected_document()
+	{
+		auto doc = load(skeleton);
+		for (auto & [path, value] : fields) set_path_text(doc.get(), path, value);
+		return native_save(doc.get());
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(builder_tests)
+
+BOOST_AUTO_TEST_CASE(set_text_matches_set_path_text)
+{
+	auto doc = load(skeleton);
+	document_builder builder(doc.get());
+	for (auto & [path, value] : fields) builder.set_text(path, value);
+
+	BOOST_CHECK_EQUAL(native_save(doc.get()), expected_document());
+	BOOST_CHECK(builder.current() == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(apply_matches_set_path_text)
+{
+	// apply walks paths in sorted order, reference sets them in the same order
+	auto reference = load(skeleton);
+	std::map<std::string, std::string> values;
+	for (auto & [path, value] : fields)
+		if (*path != '/') values[path] = value;
+	for (auto & [path, value] : values) set_path_text(reference.get(), path, value);
+
+	auto doc = load(skeleton);
+	document_builder(doc.get()).apply(values);
+	BOOST_CHECK_EQUAL(native_save(doc.get()), native_save(reference.get()));
+
+	// relative to cursor, initializer list overload
+	auto relative = load(skeleton);
+	document_builder builder(relative.get());
+	builder.acquire("r:root/r:body").apply({{"m:item/r:x", "x2"}, {"m:item/r:y", "<y>"}, {"r:plain", "plain"}, {"p:alias/p:a", "1"}, {"q:alias/q:b", "2"}});
+	builder.up(2).apply({{"r:root/r:header/r:id", "42"}, {"r:root/r:header/r:date", "2024-01-01"}});
+
+	auto expected = load(skeleton);
+	for (auto * path : {"r:root/r:body/m:item/r:x", "r:root/r:body/m:item/r:y", "r:root/r:body/p:alias/p:a", "r:root/r:body/q:alias/q:b", "r:root/r:body/r:plain", "r:root/r:header/r:id", "r:root/r:header/r:date"})
+		set_path_text(expected.get(), path, values[path]);
+
+	BOOST_CHECK_EQUAL(native_save(relative.get()), native_save(expected.get()));
+}
+
+BOOST_AUTO_TEST_CASE(prefix_aliases_share_element)
+{
+	auto doc = load(skeleton);
+	document_builder builder(doc.get());
+	builder.set_text("r:root/p:x/p:a", "1").set_text("r:root/q:x/q:b", "2");
+
+	auto * root = doc->getDocumentElement();
+	BOOST_CHECK_EQUAL(get_path_text(root, "p:x/q:a"), "1");
+	BOOST_CHECK_EQUAL(get_path_text(root, "q:x/p:b"), "2");
+	BOOST_CHECK_EQUAL(find_child(root, "p:x"), find_child(root, "q:x"));
+	BOOST_CHECK(not next_sibling(find_child(root, "p:x"), "q:x"));
+}
+
+BOOST_AUTO_TEST_CASE(set_text_releases_remembered_children)
+{
+	auto doc = load("<root/>");
+	document_builder builder(doc.get());
+	builder.set_text("root/a/b", "1").set_text("root/a/c", "2");
+
+	// children of a are released, builder must create new b instead of reusing released one
+	builder.acquire("root/a").set_text("text").up();
+	builder.set_text("/root/a/b", "3");
+
+	auto expected = load("<root/>");
+	set_path_text(expected.get(), "root/a/b", "1");
+	set_path_text(expected.get(), "root/a/c", "2");
+	set_text_content(get_path(expected.get(), "root/a"), "text");
+	set_path_text(expected.get(), "root/a/b", "3");
+
+	BOOST_CHECK_EQUAL(native_save(doc.get()), native_save(expected.get()));
+	BOOST_CHECK_EQUAL(native_save(doc.get(), as_is), R"(<?xml version="1.0" encoding="utf-8" standalone="no" ?><root><a>text<b>3</b></a></root>)");
+}
+
+BOOST_AUTO_TEST_CASE(append_and_up)
+{
+	auto doc = load("<root/>");
+	document_builder builder(doc.get());
+
+	builder.acquire("root/list");
+	BOOST_CHECK_EQUAL(to_utf8(builder.current()->getNodeName()), "list");
+
+	for (auto * value : {"1", "2", "3"})
+		builder.append("item").set_attribute("n", value).set_text("v", value).up();
+
+	// acquire finds first of appended items
+	builder.set_text("item/v", "first");
+
+	BOOST_CHECK_EQUAL(to_utf8(builder.up().current()->getNodeName()), "root");
+	BOOST_CHECK(builder.up().current() == nullptr);
+	BOOST_CHECK(builder.acquire("root/list/item/v").up(4).current() == nullptr);
+	BOOST_CHECK_THROW(builder.up(), std::runtime_error);
+	BOOST_CHECK_THROW(builder.append("item"), std::runtime_error);
+
+	BOOST_CHECK_EQUAL(native_save(doc.get(), as_is),
+		R"(<?xml version="1.0" encoding="utf-8" standalone="no" ?><root><list>)"
+		R"(<item n="1"><v>first</v></item><item n="2"><v>2</v></item><item n="3"><v>3</v></item></list></root>)");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
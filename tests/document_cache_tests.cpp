@@ -0,0 +1,179 @@
+﻿#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_document_cache.hpp>
+
+using namespace xercesc_utils;
+
+namespace
+{
+	/// temporary file, removed on destruction
+	struct temp_file
+	{
+		std::string path;
+
+		temp_file(const char * name, std::string_view content) : path((std::filesystem::temp_directory_path() / name).string()) { write(content); }
+		~temp_file() { std::error_code ec; std::filesystem::remove(path, ec); }
+
+		void write(std::string_view content) const
+		{
+			std::ofstream os(path, std::ios::binary | std::ios::trunc);
+			os.write(content.data(), content.size());
+		}
+	};
+
+	/// runs function in several threads started at once
+	template <class Function>
+	void run_concurrently(std::size_t count, Function function)
+	{
+		std::atomic<bool> start {false};
+		std::vector<std::thread> threads;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			threads.emplace_back([&start, &function, i]
+			{
+				while (not start.load()) std::this_thread::yield();
+				function(i);
+			});
+		}
+
+		start = true;
+		for (auto & thread : threads) thread.join();
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(document_cache_tests)
+
+BOOST_AUTO_TEST_CASE(concurrent_requests_share_single_load)
+{
+	temp_file file("xercesc_utils_cache_single.xml", "<settings><port>80</port></settings>");
+	document_cache cache;
+
+	const std::size_t count = 8;
+	std::vector<document_cache::document_ptr> documents(count);
+	run_concurrently(count, [&](std::size_t i) { documents[i] = cache.load_from_file(file.path); });
+
+	for (auto & document : documents)
+		BOOST_CHECK_EQUAL(document, documents.front());
+
+	auto stats = cache.statistics();
+	BOOST_CHECK_EQUAL(stats.misses, 1u);
+	BOOST_CHECK_EQUAL(stats.hits + stats.waits, count - 1);
+	BOOST_CHECK_EQUAL(stats.size, 1u);
+	BOOST_CHECK_EQUAL(documents.front()->frozen().get_path_text("settings/port"), "80");
+}
+
+BOOST_AUTO_TEST_CASE(changed_file_is_reloaded)
+{
+	temp_file file("xercesc_utils_cache_reload.xml", "<settings><port>80</port></settings>");
+	document_cache cache;
+
+	auto old_document = cache.load_from_file(file.path);
+	BOOST_CHECK_EQUAL(cache.load_from_file(file.path), old_document);
+
+	// size differs, so identity changes even with coarse mtime
+	file.write("<settings><port>8080</port></settings>");
+	auto new_document = cache.load_from_file(file.path);
+	BOOST_CHECK_NE(new_document, old_document);
+	BOOST_CHECK_EQUAL(new_document->frozen().get_path_text("settings/port"), "8080");
+
+	// holders of old document keep it
+	BOOST_CHECK_EQUAL(get_path_text(old_document->lock().get(), "settings/port"), "80");
+
+	auto stats = cache.statistics();
+	BOOST_CHECK_EQUAL(stats.misses, 2u);
+	BOOST_CHECK_EQUAL(stats.hits, 1u);
+	BOOST_CHECK_EQUAL(stats.size, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(lru_eviction_under_budget)
+{
+	const std::string content = "<settings><port>80</port></settings>";
+	temp_file a("xercesc_utils_cache_a.xml", content), b("xercesc_utils_cache_b.xml", content), c("xercesc_utils_cache_c.xml", content);
+
+	document_cache_options options;
+	options.memory_factor = 1.0;
+	options.memory_budget = 2 * content.size();
+	document_cache cache(options);
+
+	cache.load_from_file(a.path);
+	cache.load_from_file(b.path);
+	cache.load_from_file(a.path);  // b is least recently used now
+	cache.load_from_file(c.path);
+
+	auto stats = cache.statistics();
+	BOOST_CHECK_EQUAL(stats.evictions, 1u);
+	BOOST_CHECK_EQUAL(stats.size, 2u);
+	BOOST_CHECK_EQUAL(stats.memory, 2 * content.size());
+
+	cache.load_from_file(a.path);
+	cache.load_from_file(c.path);
+	BOOST_CHECK_EQUAL(cache.statistics().hits, stats.hits + 2);
+	cache.load_from_file(b.path);
+	BOOST_CHECK_EQUAL(cache.statistics().misses, stats.misses + 1);
+
+	// shrinking budget evicts immediately, documents over budget are not cached
+	options.memory_budget = content.size() - 1;
+	cache.set_options(options);
+	BOOST_CHECK_EQUAL(cache.statistics().size, 0u);
+	cache.load_from_file(a.path);
+	BOOST_CHECK_EQUAL(cache.statistics().size, 0u);
+	BOOST_CHECK_EQUAL(cache.statistics().memory, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(errors_are_reported_to_waiters)
+{
+	temp_file file("xercesc_utils_cache_error.xml", "<settings><port>80</settings>");
+	document_cache cache;
+
+	const std::size_t count = 8;
+	std::atomic<std::size_t> failures {0};
+	run_concurrently(count, [&](std::size_t)
+	{
+		try
+		{
+			cache.load_from_file(file.path);
+		}
+		catch (std::exception &)
+		{
+			++failures;
+		}
+	});
+
+	// every request either parsed itself or waited for failed parse
+	BOOST_CHECK_EQUAL(failures.load(), count);
+	auto stats = cache.statistics();
+	BOOST_CHECK_EQUAL(stats.misses + stats.waits, count);
+	BOOST_CHECK_EQUAL(stats.hits, 0u);
+	BOOST_CHECK_EQUAL(stats.size, 0u);
+
+	// errors are not cached
+	file.write("<settings><port>80</port></settings>");
+	BOOST_CHECK_EQUAL(cache.load_from_file(file.path)->frozen().get_path_text("settings/port"), "80");
+}
+
+BOOST_AUTO_TEST_CASE(frozen_under_document_lock)
+{
+	temp_file file("xercesc_utils_cache_frozen.xml", "<settings><port>80</port></settings>");
+	document_cache cache;
+	auto document = cache.load_from_file(file.path);
+
+	// snapshot is built by thread holding document lock while other threads wait for it
+	std::string other_port;
+	std::thread other;
+	{
+		auto locked = document->lock();
+		other = std::thread([&document, &other_port] { other_port = document->frozen().get_path_text("settings/port"); });
+		BOOST_CHECK_EQUAL(document->frozen().get_path_text("settings/port"), get_path_text(locked.get(), "settings/port"));
+	}
+
+	other.join();
+	BOOST_CHECK_EQUAL(other_port, "80");
+
+	BOOST_CHECK_EQUAL(&document->frozen(), &document->frozen());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,249 @@
+﻿#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+
+#include <boost/test/unit_test.hpp>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_frozen.hpp>
+
+using namespace xercesc_utils;
+
+namespace
+{
+	const char * const catalog = R"(<?xml version="1.0" encoding="utf-8"?>
+<c:catalog xmlns:c="urn:catalog" xmlns:m="urn:meta" version="2">
+  <c:header>
+    <c:code> CAT-1 </c:code>
+    <m:owner m:id="7">owner &amp; co</m:owner>
+  </c:header>
+  <c:items>
+    <c:item id="1"><c:name>first</c:name></c:item>
+    <c:item id="2"><c:name>second</c:name><m:note>mixed <b>bold</b> text</m:note></c:item>
+    <c:item id="3"><c:name><![CDATA[<third>]]></c:name></c:item>
+  </c:items>
+  <plain>no namespace</plain>
+</c:catalog>)";
+
+	const char * const paths[] =
+	{
+		"c:catalog",
+		"c:catalog/c:header/c:code",
+		"c:catalog/c:header/m:owner",
+		"/c:catalog//c:items/c:item/c:name",
+		"c:catalog/c:items/c:item/m:note",
+		"c:catalog/plain",
+		"c:catalog/c:missing",
+		"c:catalog/c:items/c:item/c:missing",
+	};
+
+	/// temporary file, removed with its cache sibling on destruction
+	struct temp_file
+	{
+		std::string path;
+
+		explicit temp_file(const char * name) : path((std::filesystem::temp_directory_path() / name).string()) {}
+		~temp_file() { std::error_code ec; std::filesystem::remove(path, ec); }
+	};
+
+	std::string read_bytes(const std::string & file)
+	{
+		std::ifstream is(file, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+	}
+
+	void write_bytes(const std::string & file, const std::string & bytes)
+	{
+		std::ofstream os(file, std::ios::binary | std::ios::trunc);
+		os.write(bytes.data(), bytes.size());
+	}
+
+	void check_same_paths(const frozen_document & expected, const frozen_document & actual)
+	{
+		for (auto * path : paths)
+		{
+			BOOST_TEST_CONTEXT("path = " << path)
+			{
+				auto expected_element = expected.find_path(path);
+				auto actual_element = actual.find_path(path);
+
+				BOOST_REQUIRE_EQUAL(bool(expected_element), bool(actual_element));
+				if (expected_element) BOOST_CHECK_EQUAL(expected_element.text(), actual_element.text());
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(frozen_tests)
+
+BOOST_AUTO_TEST_CASE(paths_match_dom)
+{
+	auto doc = load(catalog);
+	auto frozen = freeze(doc.get());
+
+	for (auto * path : paths)
+	{
+		BOOST_TEST_CONTEXT("path = " << path)
+		{
+			auto * element = find_path(doc.get(), path);
+			auto frozen_element = frozen.find_path(path);
+
+			BOOST_REQUIRE_EQUAL(bool(element), bool(frozen_element));
+			if (not element) continue;
+
+			BOOST_CHECK_EQUAL(frozen_element.text(), get_text_content(element));
+			BOOST_CHECK_EQUAL(frozen_element.local_name(), to_utf8(element->getLocalName()));
+			BOOST_CHECK_EQUAL(frozen_element.namespace_uri(), element->getNamespaceURI() ? to_utf8(element->getNamespaceURI()) : "");
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(navigation_and_attributes)
+{
+	auto doc = load(catalog);
+	auto frozen = freeze(doc.get());
+	auto items = frozen.get_path("c:catalog/c:items");
+
+	std::vector<std::string> ids, names;
+	for (auto item = items.find_child("c:item"); item; item = item.next_sibling("c:item"))
+	{
+		ids.emplace_back(item.find_attribute_view("id"));
+		names.push_back(item.get_path_text("c:name"));
+		BOOST_CHECK(item.parent() == items);
+	}
+
+	BOOST_CHECK((ids == std::vector<std::string> {"1", "2", "3"}));
+	BOOST_CHECK((names == std::vector<std::string> {"first", "second", "<third>"}));
+
+	auto owner = frozen.get_path("c:catalog/c:header/m:owner");
+	BOOST_CHECK_EQUAL(owner.text_view(), "owner & co");
+	BOOST_CHECK_EQUAL(owner.get_attribute_text("m:id"), "7");
+	BOOST_CHECK(not owner.has_attribute("id"));
+	BOOST_CHECK_EQUAL(owner.find_attribute_text("id", "none"), "none");
+	BOOST_CHECK_EQUAL(frozen.root().find_attribute_view("version"), "2");
+
+	// path segments take the first matching element, as find_path does
+	BOOST_CHECK(not items.find_path("c:item/m:note"));
+
+	// element with child elements has no own text, text() concatenates descendants
+	auto note = items.find_child("c:item").next_sibling("c:item").find_child("m:note");
+	BOOST_CHECK_EQUAL(note.text(), "mixed bold text");
+	BOOST_CHECK(note.text_view().empty());
+}
+
+BOOST_AUTO_TEST_CASE(missing_paths_and_prefixes)
+{
+	auto doc = load(catalog);
+	auto frozen = freeze(doc.get());
+
+	BOOST_CHECK_THROW(frozen.get_path("c:catalog/c:missing"), xml_path_exception);
+	BOOST_CHECK_THROW(frozen.get_path_text("c:catalog/c:missing"), xml_path_exception);
+	BOOST_CHECK_EQUAL(frozen.find_path_text("c:catalog/c:missing", "default"), "default");
+	BOOST_CHECK_THROW(frozen.find_path("c:catalog/x:item"), xml_namespace_exception);
+	BOOST_CHECK_THROW(frozen.root().get_attribute_text("missing"), xml_path_exception);
+}
+
+BOOST_AUTO_TEST_CASE(resolver_bindings_are_captured)
+{
+	auto doc = load(catalog);
+	associate_resolver(doc.get(), create_resolver({{"cat", "urn:catalog"}, {"meta", "urn:meta"}}));
+	auto frozen = freeze(doc.get());
+
+	// prefixes are resolved via captured bindings, as find_path does with associated resolver
+	BOOST_CHECK_EQUAL(frozen.get_path_text("cat:catalog/cat:header/cat:code"), "CAT-1");
+	BOOST_CHECK_EQUAL(frozen.get_path_text("cat:catalog/cat:header/meta:owner"), get_path_text(doc.get(), "cat:catalog/cat:header/meta:owner"));
+
+	// snapshot does not depend on source document
+	doc.reset();
+	BOOST_CHECK_EQUAL(frozen.get_path("cat:catalog/cat:items").find_child("cat:item").find_attribute_view("id"), "1");
+}
+
+BOOST_AUTO_TEST_CASE(file_round_trip)
+{
+	temp_file file("xercesc_utils_frozen_round_trip.frozen");
+	auto frozen = load_frozen(catalog);
+	save_frozen(frozen, file.path, {42, 7});
+
+	frozen_file_info info;
+	BOOST_REQUIRE(read_frozen_info(file.path, info));
+	BOOST_CHECK_EQUAL(info.source_size, 42u);
+	BOOST_CHECK_EQUAL(info.source_mtime, 7);
+
+	check_same_paths(frozen, open_frozen(file.path));
+	check_same_paths(frozen, open_frozen(file.path, true));
+}
+
+BOOST_AUTO_TEST_CASE(invalid_files_throw)
+{
+	temp_file file("xercesc_utils_frozen_invalid.frozen");
+	auto frozen = load_frozen(catalog);
+	save_frozen(frozen, file.path);
+	const auto bytes = read_bytes(file.path);
+	frozen_file_info info;
+
+	// truncated: inside header and inside tables
+	for (auto size : {std::size_t(16), bytes.size() / 2, bytes.size() - 1})
+	{
+		BOOST_TEST_CONTEXT("size = " << size)
+		{
+			write_bytes(file.path, bytes.substr(0, size));
+			BOOST_CHECK_THROW(open_frozen(file.path), std::runtime_error);
+			BOOST_CHECK(not read_frozen_info(file.path, info));
+		}
+	}
+
+	// version follows 8 bytes of magic
+	auto corrupted = bytes;
+	corrupted[8] ^= 0x7f;
+	write_bytes(file.path, corrupted);
+	BOOST_CHECK_THROW(open_frozen(file.path), std::runtime_error);
+	BOOST_CHECK(not read_frozen_info(file.path, info));
+
+	// last byte belongs to arena or its padding: only checksum can detect it
+	corrupted = bytes;
+	corrupted.back() ^= 0x7f;
+	write_bytes(file.path, corrupted);
+	BOOST_CHECK_THROW(open_frozen(file.path, true), std::runtime_error);
+	BOOST_CHECK_NO_THROW(open_frozen(file.path, false));
+
+	// broken index in node table is rejected even without checksum verification
+	auto & tables = frozen.tables();
+	auto node_table = std::string(reinterpret_cast<const char *>(tables.nodes), tables.node_count * sizeof(frozen::node_entry));
+	auto nodes_offset = bytes.find(node_table);
+	BOOST_REQUIRE_NE(nodes_offset, std::string::npos);
+
+	auto check_corrupted_node = [&](std::size_t field_offset, frozen::index_type value)
+	{
+		auto corrupted = bytes;
+		std::memcpy(&corrupted[nodes_offset + field_offset], &value, sizeof(value));
+		write_bytes(file.path, corrupted);
+		BOOST_CHECK_THROW(open_frozen(file.path, false), std::runtime_error);
+	};
+
+	check_corrupted_node(offsetof(frozen::node_entry, first_child), frozen::index_type(tables.node_count));
+	check_corrupted_node(offsetof(frozen::node_entry, parent), 0);                                       // cycle
+	check_corrupted_node(sizeof(frozen::node_entry) + offsetof(frozen::node_entry, next_sibling), 0);    // back link
+	check_corrupted_node(offsetof(frozen::node_entry, name), frozen::index_type(tables.name_count));
+	check_corrupted_node(offsetof(frozen::node_entry, attribute_count), frozen::index_type(tables.attribute_count + 1));
+	check_corrupted_node(offsetof(frozen::node_entry, text) + offsetof(frozen::string_ref, offset), frozen::index_type(tables.arena_size + 1));
+}
+
+BOOST_AUTO_TEST_CASE(cache_is_rebuilt)
+{
+	temp_file source("xercesc_utils_frozen_cache.xml");
+	temp_file cache("xercesc_utils_frozen_cache.xml.frozen");
+	write_bytes(source.path, catalog);
+	auto expected = load_frozen(catalog);
+
+	check_same_paths(expected, load_frozen_cached(source.path, cache.path));
+	BOOST_REQUIRE(std::filesystem::exists(cache.path));
+	check_same_paths(expected, load_frozen_cached(source.path, cache.path));
+
+	// invalid cache is replaced by fresh snapshot
+	write_bytes(cache.path, read_bytes(cache.path).substr(0, 64));
+	check_same_paths(expected, load_frozen_cached(source.path, cache.path));
+	BOOST_CHECK_NO_THROW(open_frozen(cache.path, true));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
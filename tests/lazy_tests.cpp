@@ -0,0 +1,105 @@
+﻿#include <boost/test/unit_test.hpp>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_lazy.hpp>
+
+using namespace xercesc_utils;
+
+namespace
+{
+	const char * const catalog = R"(<?xml version="1.0" encoding="utf-8"?>
+<!DOCTYPE catalog [ <!ENTITY note "<item>"> ]>
+<!-- <item>commented</item> -->
+<c:catalog xmlns:c="urn:catalog" xmlns="urn:default">
+  <c:item id="1"><name>first</name></c:item>
+  <?pi <item>?>
+  <c:item id="2" xmlns:m="urn:meta"><name><![CDATA[</c:item> <x>]]></name><m:note a='>'/></c:item>
+  <c:other/>
+  <c:item id="3"><c:item>nested</c:item></c:item>
+</c:catalog>
+)";
+
+	std::unique_ptr<lazy_document> make_lazy(std::string data, const lazy_index_options & options = {})
+	{
+		auto storage = std::make_shared<const std::string>(std::move(data));
+		return std::make_unique<lazy_document>(*storage, storage, options);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(lazy_tests)
+
+BOOST_AUTO_TEST_CASE(index_skips_markup)
+{
+	auto doc = make_lazy(catalog);
+
+	BOOST_CHECK_EQUAL(doc->root_name(), "c:catalog");
+	BOOST_REQUIRE_EQUAL(doc->size(), 4u);
+	BOOST_CHECK_EQUAL(doc->at(0).name, "c:item");
+	BOOST_CHECK_EQUAL(doc->at(2).name, "c:other");
+	BOOST_CHECK_EQUAL(doc->source(0), R"(<c:item id="1"><name>first</name></c:item>)");
+	BOOST_CHECK_EQUAL(doc->source(1), R"(<c:item id="2" xmlns:m="urn:meta"><name><![CDATA[</c:item> <x>]]></name><m:note a='>'/></c:item>)");
+	BOOST_CHECK_EQUAL(doc->source(2), "<c:other/>");
+	BOOST_CHECK_EQUAL(doc->source(3), R"(<c:item id="3"><c:item>nested</c:item></c:item>)");
+
+	BOOST_CHECK_EQUAL(doc->find("c:item"), 0u);
+	BOOST_CHECK_EQUAL(doc->find("c:item", 1), 1u);
+	BOOST_CHECK_EQUAL(doc->find("c:item", 2), 3u);
+	BOOST_CHECK_EQUAL(doc->find("c:missing"), lazy_document::npos);
+}
+
+BOOST_AUTO_TEST_CASE(index_depth)
+{
+	auto root = make_lazy(catalog, {0});
+	BOOST_REQUIRE_EQUAL(root->size(), 1u);
+	BOOST_CHECK_EQUAL(root->at(0).name, "c:catalog");
+
+	auto grandchildren = make_lazy(catalog, {2});
+	std::vector<std::string_view> names;
+	for (auto & rec : grandchildren->records()) names.push_back(rec.name);
+	BOOST_CHECK((names == std::vector<std::string_view> {"name", "name", "m:note", "c:item"}));
+
+	// declarations of ancestors, including the indexed element's parent item
+	auto & context = grandchildren->namespace_context(grandchildren->at(2));
+	BOOST_CHECK(context.find(R"(xmlns:m="urn:meta")") != context.npos);
+	BOOST_CHECK(context.find(R"(xmlns:c="urn:catalog")") != context.npos);
+}
+
+BOOST_AUTO_TEST_CASE(elements_resolve_ancestor_namespaces)
+{
+	auto doc = make_lazy(catalog);
+
+	auto * first = doc->element(0);
+	BOOST_CHECK(to_utf8(first->getNamespaceURI()) == "urn:catalog");
+	// unprefixed children are in default namespace declared on document element
+	auto * name = first->getFirstElementChild();
+	BOOST_CHECK(to_utf8(name->getNamespaceURI()) == "urn:default");
+	BOOST_CHECK_EQUAL(get_text_content(name), "first");
+
+	auto * second = doc->element(1);
+	BOOST_CHECK_EQUAL(get_text_content(second->getFirstElementChild()), "</c:item> <x>");
+	auto * note = second->getLastElementChild();
+	BOOST_CHECK(to_utf8(note->getNamespaceURI()) == "urn:meta");
+	BOOST_CHECK_EQUAL(get_attribute_text(note, "a"), ">");
+
+	// element is kept until release, load parses again each time
+	BOOST_CHECK(doc->element(0) == first);
+	auto loaded = doc->load(0);
+	BOOST_CHECK(loaded->getDocumentElement() != first);
+	BOOST_CHECK_EQUAL(get_text_content(loaded->getDocumentElement()), "first");
+
+	doc->release_all();
+	BOOST_CHECK_THROW(doc->element(doc->size()), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(broken_markup_throws)
+{
+	BOOST_CHECK_THROW(make_lazy("<root><a></root"), std::runtime_error);
+	BOOST_CHECK_THROW(make_lazy("</a><root/>"), std::runtime_error);
+	BOOST_CHECK_THROW(make_lazy("<!-- no root -->"), std::runtime_error);
+	BOOST_CHECK_THROW(make_lazy("<root><!-- unterminated </root>"), std::runtime_error);
+
+	// errors inside subtree are reported when it's loaded
+	auto doc = make_lazy("<root><a><b></c></a></root>");
+	BOOST_CHECK_THROW(doc->element(0), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,11 @@
+﻿#define BOOST_TEST_MODULE xercesc_utils_tests
+#include <boost/test/unit_test.hpp>
+#include <xercesc/xercesc_utils.hpp>
+
+struct xercesc_fixture
+{
+	xercesc_fixture()  { xercesc_utils::xercesc_init(); }
+	~xercesc_fixture() { xercesc_utils::xercesc_free(); }
+};
+
+BOOST_GLOBAL_FIXTURE(xercesc_fixture);
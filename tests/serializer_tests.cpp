@@ -0,0 +1,206 @@
+﻿#include <boost/test/unit_test.hpp>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_serializer.hpp>
+
+using namespace xercesc_utils;
+
+namespace
+{
+	const char * const corpus[] =
+	{
+		"<root/>",
+		R"(<root a="1" b="x &amp; &lt; &gt; &quot; '"><child>text &amp; &lt; &gt; " '</child><empty/></root>)",
+		// characters escaped by XMLFormatter AttrEscapes/CharEscapes beyond markup ones
+		"<root a=\"line&#xA;feed\" b=\"carriage&#xD;return\" c=\"tab&#x9;char\">text&#xD;with cr\nand lf\tand tab</root>",
+		R"(<p:root xmlns:p="urn:p" xmlns="urn:d"><p:a p:attr="1"/><b xmlns=""><c/></b><d>text</d></p:root>)",
+		R"(<root><!-- comment --><?pi data?><a><![CDATA[cdata ]]]]><![CDATA[> section]]></a></root>)",
+		"<root>\xD0\xBF\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82 \xF0\x9F\x98\x80</root>",
+		"<root>\n  <a>  spaced  </a>\n  <b/>\n</root>",
+	};
+
+	/// many root children for parallel save: text ending with new line before batch boundaries,
+	/// comments, namespaces declared on root and children, attributes with entity references
+	std::shared_ptr<xercesc::DOMDocument> make_parallel_document()
+	{
+		std::string xml = R"(<!DOCTYPE p:root [ <!ENTITY e "entity"> ]><p:root xmlns:p="urn:p" a="&amp;">)";
+		for (int i = 0; i < 100; ++i)
+		{
+			auto n = std::to_string(i);
+			xml += "<p:item id=\"" + n + "\" note=\"a &amp; b\"><p:name>item " + n + "</p:name><q:x xmlns:q=\"urn:q\"/></p:item>";
+			xml += "tail " + n + "\n";
+			if (i % 7 == 0) xml += "<!-- comment " + n + " -->\n  ";
+		}
+		xml += "&e;</p:root>";
+
+		auto doc = load(xml);
+		int i = 0;
+		for (auto * item = doc->getDocumentElement()->getFirstElementChild(); item; item = item->getNextElementSibling(), ++i)
+		{
+			if (i % 3) continue;
+
+			// value of several nodes, DOMAttr::getValue would build it in document pool
+			auto * attr = doc->createAttribute(XERCESC_LIT("ref"));
+			attr->appendChild(doc->createTextNode(XERCESC_LIT("x & ")));
+			attr->appendChild(doc->createEntityReference(XERCESC_LIT("e")));
+			attr->appendChild(doc->createTextNode(XERCESC_LIT(" y")));
+			item->setAttributeNode(attr);
+		}
+
+		return doc;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(serializer_tests)
+
+BOOST_AUTO_TEST_CASE(native_save_matches_save)
+{
+	for (auto * xml : corpus)
+	{
+		auto doc = load(xml);
+		for (auto option : {pretty_print, as_is})
+		{
+			BOOST_TEST_CONTEXT("xml = " << xml << ", pretty_print = " << bool(option))
+			{
+				BOOST_CHECK_EQUAL(native_save(doc.get(), option), save(doc.get(), option));
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(native_print_matches_print)
+{
+	for (auto * xml : corpus)
+	{
+		auto doc = load(xml);
+		for (auto option : {pretty_print, as_is})
+		{
+			BOOST_TEST_CONTEXT("xml = " << xml << ", pretty_print = " << bool(option))
+			{
+				BOOST_CHECK_EQUAL(native_print(doc->getDocumentElement(), option), print(doc->getDocumentElement(), option));
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(native_save_parallel_matches_native_save)
+{
+	auto doc = make_parallel_document();
+	for (auto option : {pretty_print, as_is})
+	{
+		auto expected = native_save(doc.get(), option);
+		BOOST_CHECK(expected.find(R"(ref="x &amp; &e; y")") != expected.npos);
+
+		for (unsigned nthreads = 2; nthreads <= 8; ++nthreads)
+		{
+			BOOST_TEST_CONTEXT("pretty_print = " << bool(option) << ", nthreads = " << nthreads)
+			{
+				BOOST_CHECK_EQUAL(native_save_parallel(doc.get(), option, nthreads), expected);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(attribute_namespace_fixup)
+{
+	auto doc = load(R"(<p:e xmlns:p="urn:a"><c/></p:e>)");
+	auto * root = doc->getDocumentElement();
+	auto * child = root->getFirstElementChild();
+	root->setAttributeNS(XERCESC_LIT("urn:x"), XERCESC_LIT("a"), XERCESC_LIT("1"));    // namespace without prefix
+	root->setAttributeNS(XERCESC_LIT("urn:b"), XERCESC_LIT("p:x"), XERCESC_LIT("2"));  // p is bound to urn:a by this element
+	child->setAttributeNS(XERCESC_LIT("urn:b"), XERCESC_LIT("p:z"), XERCESC_LIT("3")); // p is bound to urn:a in outer scope
+	child->setAttributeNS(XERCESC_LIT("urn:y"), XERCESC_LIT("q:w"), XERCESC_LIT("4")); // unbound prefix is declared as is
+
+	for (auto option : {pretty_print, as_is})
+	{
+		auto xml = native_save(doc.get(), option);
+		BOOST_TEST_CONTEXT("xml = " << xml)
+		{
+			// p is not rebound, prefix generated on root for urn:b is reused by child
+			BOOST_CHECK(xml.find(R"(xmlns:p=)") == xml.rfind(R"(xmlns:p=)"));
+			BOOST_CHECK(xml.find(R"("urn:b")") == xml.rfind(R"("urn:b")"));
+
+			auto reparsed = load(xml);
+			auto * reparsed_root = reparsed->getDocumentElement();
+			auto * reparsed_child = reparsed_root->getFirstElementChild();
+			BOOST_CHECK(to_utf8(reparsed_root->getNamespaceURI()) == "urn:a");
+			BOOST_CHECK_EQUAL(to_utf8(reparsed_root->getAttributeNS(XERCESC_LIT("urn:x"), XERCESC_LIT("a"))), "1");
+			BOOST_CHECK_EQUAL(to_utf8(reparsed_root->getAttributeNS(XERCESC_LIT("urn:b"), XERCESC_LIT("x"))), "2");
+			BOOST_CHECK_EQUAL(to_utf8(reparsed_child->getAttributeNS(XERCESC_LIT("urn:b"), XERCESC_LIT("z"))), "3");
+			BOOST_CHECK_EQUAL(to_utf8(reparsed_child->getAttributeNS(XERCESC_LIT("urn:y"), XERCESC_LIT("w"))), "4");
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(streaming_writer_matches_native_save)
+{
+	// root has children before writer starts: they are written first
+	const char * const source = R"(<!-- head --><p:root xmlns:p="urn:p" a="1"><p:header>h &amp; h</p:header><!-- c -->text</p:root><!-- tail -->)";
+
+	auto append_items = [](xercesc::DOMElement * root, auto && written)
+	{
+		for (int i = 0; i < 5; ++i)
+		{
+			auto * item = create_element_ns(root, "urn:p", "p:item");
+			root->appendChild(item);
+			set_attribute_ns(item, "", "id", std::to_string(i));
+			auto * name = create_element_ns(item, "urn:q", "q:name");
+			item->appendChild(name);
+			set_text_content(name, "item " + std::to_string(i));
+			written(item);
+		}
+	};
+
+	for (auto option : {pretty_print, as_is})
+	{
+		BOOST_TEST_CONTEXT("pretty_print = " << bool(option))
+		{
+			auto expected_doc = load(source);
+			append_items(expected_doc->getDocumentElement(), [](auto *) {});
+
+			std::string str;
+			auto doc = load(source);
+			{
+				utf8_output out(str);
+				streaming_document_writer writer(out, doc->getDocumentElement(), option);
+				append_items(doc->getDocumentElement(), [&writer](auto * item) { writer.write(item); });
+				writer.finish();
+			}
+
+			BOOST_CHECK_EQUAL(str, native_save(expected_doc.get(), option));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(whitespace_survives_reparse)
+{
+	auto doc = load(corpus[2]);
+	auto reparsed = load(native_save(doc.get(), as_is));
+	auto * root = reparsed->getDocumentElement();
+
+	BOOST_CHECK_EQUAL(get_attribute_text(root, "a"), "line\nfeed");
+	BOOST_CHECK_EQUAL(get_attribute_text(root, "b"), "carriage\rreturn");
+	BOOST_CHECK_EQUAL(get_attribute_text(root, "c"), "tab\tchar");
+	BOOST_CHECK_EQUAL(to_utf8(root->getTextContent()), "text\rwith cr\nand lf\tand tab");
+}
+
+BOOST_AUTO_TEST_CASE(append_escaped_matches_append)
+{
+	const char * text = "a&b<c>d\"e\nf\rg\th";
+	for (auto mode : {escape_mode::text, escape_mode::attribute})
+	{
+		std::string escaped, transcoded;
+		utf8_output(escaped).append_escaped(text, mode);
+		utf8_output(transcoded).append(to_xmlch(text), mode);
+		BOOST_CHECK_EQUAL(escaped, transcoded);
+	}
+
+	std::string attribute;
+	utf8_output(attribute).append_escaped(text, escape_mode::attribute);
+	BOOST_CHECK_EQUAL(attribute, "a&amp;b&lt;c>d&quot;e&#xA;f&#xD;g&#x9;h");
+
+	std::string content;
+	utf8_output(content).append_escaped(text, escape_mode::text);
+	BOOST_CHECK_EQUAL(content, "a&amp;b&lt;c&gt;d\"e\nf&#xD;g\th");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,116 @@
+﻿#include <boost/test/unit_test.hpp>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_serializer.hpp>
+#include <xercesc/xercesc_template.hpp>
+
+using namespace xercesc_utils;
+
+namespace
+{
+	const char * const skeleton = R"(<?xml version="1.0" encoding="utf-8"?>
+<r:response xmlns:r="urn:r" version="1">
+  <r:id>0</r:id>
+  <r:status code="200"><r:text>OK</r:text></r:status>
+  <!-- fixed -->
+  <r:body><r:text>old <b>markup</b> replaced</r:text><r:tail>&amp; fixed</r:tail></r:body>
+</r:response>)";
+
+	const std::vector<std::string> slots =
+	{
+		"r:response/r:body/r:text",   // text slot replacing mixed content
+		"r:response/r:id",
+		"r:response/r:status/@code",  // existing attribute
+		"r:response/r:status/@note",  // attribute missing in skeleton
+		"r:response/r:status/r:text",
+		"r:response/@version",
+	};
+}
+
+BOOST_AUTO_TEST_SUITE(template_tests)
+
+BOOST_AUTO_TEST_CASE(render_matches_native_save_of_instantiate)
+{
+	auto doc = load(skeleton);
+
+	const std::vector<std::vector<std::string_view>> value_sets =
+	{
+		{"text", "42", "404", "note", "Not found", "2"},
+		{"a & b < c > \"d\" 'e'", "]]>", "x\"y'z&<>", "line\nfeed\ttab\rcr", " spaced ", "\xC3\xA9\xF0\x9F\x98\x80"},
+		{"<tag attr=\"v\"/>", "&amp;", "\n", " ", "\xD0\xBF\xD1\x80\xD0\xB8", "&#x41;"},
+	};
+
+	for (auto option : {pretty_print, as_is})
+	{
+		document_template tmpl(doc.get(), slots, option);
+		BOOST_CHECK_EQUAL(tmpl.slot_count(), slots.size());
+
+		for (auto & values : value_sets)
+		{
+			BOOST_TEST_CONTEXT("pretty_print = " << bool(option) << ", values = " << values.front())
+			{
+				auto rendered = tmpl.render(values);
+				BOOST_CHECK_EQUAL(rendered, native_save(tmpl.instantiate(values).get(), option));
+
+				// every overload writes the same bytes
+				std::string appended = "prefix";
+				tmpl.render(appended, values);
+				BOOST_CHECK_EQUAL(appended, "prefix" + rendered);
+
+				std::size_t values_size = 0;
+				for (auto value : values) values_size += value.size();
+				BOOST_CHECK_LE(tmpl.fixed_size() + values_size, rendered.size());
+			}
+		}
+
+		// skeleton is copied: instance is independent from source document and other instances
+		auto first = tmpl.instantiate({"1", "2", "3", "4", "5", "6"});
+		auto second = tmpl.instantiate({"a", "b", "c", "d", "e", "f"});
+		BOOST_CHECK_EQUAL(get_path_text(first.get(), "r:response/r:id"), "2");
+		BOOST_CHECK_EQUAL(get_path_text(second.get(), "r:response/r:id"), "b");
+		BOOST_CHECK_EQUAL(get_path_text(doc.get(), "r:response/r:id"), "0");
+		BOOST_CHECK_EQUAL(tmpl.slot_index("r:response/r:status/@note"), 3u);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(invalid_slots_throw)
+{
+	auto doc = load(R"(<r xmlns:p="urn:a" xmlns:q="urn:a"><p:a x="1"><b/></p:a><c/></r>)");
+	auto make = [&doc](std::vector<std::string> slots) { document_template tmpl(doc.get(), slots); };
+
+	// text slot and attributes of the same element can be combined
+	BOOST_CHECK_NO_THROW(make({"r/p:a", "r/p:a/@x", "r/p:a/@y", "r/c"}));
+
+	BOOST_CHECK_THROW(make({"r/c", "r/c"}), std::invalid_argument);            // duplicate
+	BOOST_CHECK_THROW(make({"r/p:a", "r/q:a"}), std::invalid_argument);        // same element via prefix alias
+	BOOST_CHECK_THROW(make({"r/p:a/@x", "r/q:a/@x"}), std::invalid_argument);
+	BOOST_CHECK_THROW(make({"r/p:a", "r/p:a/b"}), std::invalid_argument);      // nested text slots
+	BOOST_CHECK_THROW(make({"r/p:a/b", "r"}), std::invalid_argument);
+	BOOST_CHECK_THROW(make({"r/p:a", "r/p:a/b/@z"}), std::invalid_argument);  // attribute inside text slot
+	BOOST_CHECK_THROW(make({"r/c/@"}), std::invalid_argument);
+	BOOST_CHECK_THROW(make({"r/missing"}), xml_path_exception);
+
+	document_template tmpl(doc.get(), {"r/c"});
+	BOOST_CHECK_THROW(tmpl.render({}), std::invalid_argument);
+	BOOST_CHECK_THROW(tmpl.render({"1", "2"}), std::invalid_argument);
+	BOOST_CHECK_THROW(tmpl.slot_index("r/missing"), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(marker_characters_in_skeleton_throw)
+{
+	// U+E000, U+E001 and both around a number which looks like slot marker, in text and in attribute
+	for (auto * xml : {"<r><a/><b>\xEE\x80\x80</b></r>", "<r><a/><b>\xEE\x80\x81</b></r>", "<r><a/><b x=\"\xEE\x80\x80" "0\xEE\x80\x81\"/></r>",
+	                   "<r><a/><b>\xEE\x80\x80" "1\xEE\x80\x81</b></r>"})
+	{
+		BOOST_TEST_CONTEXT("skeleton = " << xml)
+		{
+			auto doc = load(xml);
+			BOOST_CHECK_THROW(document_template(doc.get(), {"r/a"}), std::invalid_argument);
+		}
+	}
+
+	// markers inside text slot content are replaced, so they don't matter
+	auto doc = load("<r><a>\xEE\x80\x80</a></r>");
+	BOOST_CHECK_EQUAL(document_template(doc.get(), {"r/a"}, as_is).render({"v"}), R"(<?xml version="1.0" encoding="utf-8" standalone="no" ?><r><a>v</a></r>)");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
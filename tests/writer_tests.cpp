@@ -0,0 +1,111 @@
+﻿#include <boost/test/unit_test.hpp>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_serializer.hpp>
+#include <xercesc/xercesc_writer.hpp>
+
+using namespace xercesc_utils;
+
+namespace
+{
+	void write_orders(xml_writer & writer)
+	{
+		writer.write_declaration();
+		writer.start_element("urn:o", "o:orders");
+		writer.start_element("urn:o", "x:order");  // prefix o is already bound
+		writer.attribute("id", "4<2");
+		writer.attribute("urn:m", "m:flag", u"é\"\n");
+		writer.text("a & b");
+		writer.end_element();
+		writer.start_element("urn:d", "item");     // default namespace is declared
+		writer.start_element("urn:d", "p:sub");    // default namespace, written without prefix
+		writer.start_element("plain");             // default namespace is undeclared
+		writer.end_element();
+		writer.comment(" c ");
+		writer.finish();
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(writer_tests)
+
+BOOST_AUTO_TEST_CASE(output_matches_native_save)
+{
+	for (auto option : {pretty_print, as_is})
+	{
+		std::string str;
+		xml_writer writer(str, option);
+		write_orders(writer);
+
+		BOOST_TEST_CONTEXT("pretty_print = " << bool(option))
+		{
+			BOOST_CHECK_EQUAL(native_save(load(str).get(), option), str);
+		}
+	}
+
+	std::string str;
+	xml_writer writer(str, as_is);
+	write_orders(writer);
+	BOOST_CHECK_EQUAL(str, "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"no\" ?>"
+	                       "<o:orders xmlns:o=\"urn:o\"><o:order id=\"4&lt;2\" xmlns:m=\"urn:m\" m:flag=\"\xC3\xA9&quot;&#xA;\">a &amp; b</o:order>"
+	                       "<item xmlns=\"urn:d\"><sub><plain xmlns=\"\"/><!-- c --></sub></item></o:orders>");
+}
+
+BOOST_AUTO_TEST_CASE(whitespace_text_keeps_element_open)
+{
+	std::string str;
+	xml_writer writer(str);
+	writer.write_declaration();
+	writer.start_element("root");
+	writer.start_element("a");
+	writer.text("\n  ");
+	writer.end_element();
+	writer.start_element("b");
+	writer.text("");
+	writer.end_element();
+	writer.start_element("c");
+	writer.end_element();
+	writer.finish();
+
+	BOOST_CHECK_EQUAL(str, "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"no\" ?>\n"
+	                       "<root>\n  <a>\n  </a>\n  <b>\n  </b>\n  <c/>\n</root>\n");
+	BOOST_CHECK_EQUAL(native_save(load(str).get(), pretty_print), str);
+}
+
+BOOST_AUTO_TEST_CASE(conflicting_attribute_prefix_is_replaced)
+{
+	std::string str;
+	xml_writer writer(str, as_is);
+	writer.start_element("urn:a", "p:e");
+	writer.attribute("urn:b", "p:x", "1");     // p is bound to urn:a on this tag
+	writer.start_element("c");
+	writer.attribute("urn:c", "p:y", "2");     // p is bound to urn:a in outer scope
+	writer.finish();
+
+	BOOST_CHECK_EQUAL(str, R"(<p:e xmlns:p="urn:a" xmlns:ns1="urn:b" ns1:x="1"><c xmlns:ns2="urn:c" ns2:y="2"/></p:e>)");
+
+	auto doc = load(str);
+	auto * root = doc->getDocumentElement();
+	auto * child = root->getFirstElementChild();
+	BOOST_CHECK(to_utf8(root->getNamespaceURI()) == "urn:a");
+	BOOST_CHECK_EQUAL(to_utf8(root->getAttributeNS(to_xmlch("urn:b").c_str(), to_xmlch("x").c_str())), "1");
+	BOOST_CHECK_EQUAL(to_utf8(child->getAttributeNS(to_xmlch("urn:c").c_str(), to_xmlch("y").c_str())), "2");
+}
+
+BOOST_AUTO_TEST_CASE(misuse_throws)
+{
+	std::string str;
+	xml_writer writer(str);
+	BOOST_CHECK_THROW(writer.attribute("a", "1"), std::logic_error);
+	BOOST_CHECK_THROW(writer.end_element(), std::logic_error);
+
+	BOOST_CHECK_THROW(writer.start_element("p:root"), std::invalid_argument);
+	BOOST_CHECK_THROW(writer.start_element("", "p:root"), std::invalid_argument);
+	BOOST_CHECK(str.empty());
+
+	writer.start_element("root");
+	BOOST_CHECK_THROW(writer.attribute("urn:a", "x", "1"), std::invalid_argument);
+	BOOST_CHECK_THROW(writer.attribute("p:x", "1"), std::invalid_argument);
+	BOOST_CHECK_THROW(writer.attribute("", "p:x", u"1"), std::invalid_argument);
+	BOOST_CHECK_THROW(writer.write_declaration(), std::logic_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,104 @@
+﻿#include <boost/test/unit_test.hpp>
+#include <xercesc/xercesc_utils.hpp>
+#include <xercesc/xercesc_xpath.hpp>
+
+using namespace xercesc_utils;
+
+namespace
+{
+	// items nest, so descendant steps get nested contexts
+	const char * const items = R"(<?xml version="1.0" encoding="utf-8"?>
+<root xmlns:m="urn:m">
+  <items id="items">
+    <item id="1" type="x"><item id="1.1" type="x"><item id="1.1.1" type="z"/></item>t1</item>
+    <item id="2" type="y"><m:item id="2.m"/><name>two</name></item>
+    <item id="3" type="x"/>
+  </items>
+</root>)";
+
+	/// element as name#id, attribute as @name=value, text as 'value'
+	std::string describe(const std::vector<xercesc::DOMNode *> & nodes)
+	{
+		std::string result;
+		for (auto * node : nodes)
+		{
+			if (not result.empty()) result += ' ';
+			switch (node->getNodeType())
+			{
+				case xercesc::DOMNode::ELEMENT_NODE:
+					result += to_utf8(node->getNodeName()) + '#' + to_utf8(static_cast<xercesc::DOMElement *>(node)->getAttribute(XERCESC_LIT("id")));
+					break;
+				case xercesc::DOMNode::ATTRIBUTE_NODE:
+					result += '@' + to_utf8(node->getNodeName()) + '=' + to_utf8(node->getNodeValue());
+					break;
+				default:
+					result += '\'' + to_utf8(node->getNodeValue()) + '\'';
+			}
+		}
+
+		return result;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE(xpath_tests)
+
+BOOST_AUTO_TEST_CASE(shared_subset_matches_select_xpath)
+{
+	auto doc = load(items);
+	auto * root = doc->getDocumentElement();
+
+	for (auto * path : {"items", "items/item", "items/*", "*/item", "items/item/@id", "items/item/@*", ".//item", ".//item/@type", "items/missing"})
+	{
+		BOOST_TEST_CONTEXT("path = " << path)
+		{
+			auto range = select_xpath(root, path);
+			std::vector<xercesc::DOMNode *> expected(range.begin(), range.end());
+			auto actual = native_select_xpath(root, path);
+
+			BOOST_CHECK_EQUAL(describe(actual), describe(expected));
+			BOOST_CHECK(actual == expected);
+			BOOST_CHECK_EQUAL(native_find_xpath(root, path), expected.empty() ? nullptr : expected.front());
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(extended_subset)
+{
+	auto doc = load(items);
+	auto * root = doc->getDocumentElement();
+
+	const std::pair<const char *, const char *> cases[] =
+	{
+		{"items/item[2]",                 "item#2"},
+		{"items/item[last()]",            "item#3"},
+		{"items/item[last()-1]",          "item#2"},
+		{"items/item[last()-5]",          ""},
+		{"items/item[@type!='x']",        "item#2"},
+		{"items/item[@type='x'][last()]", "item#3"},
+		{"items/*[name='two']",           "item#2"},
+		{"items/item/text()",             "'t1'"},
+		{"//item[text()='t1']",           "item#1"},
+		{"//@type",                       "@type=x @type=x @type=z @type=y @type=x"},
+		{"//item[@type='x']/@id",         "@id=1 @id=1.1 @id=3"},
+		{"//item[1]",                     "item#1 item#1.1 item#1.1.1"},
+		{"//m:item",                      "m:item#2.m"},
+		{"/root/items/item[3]",           "item#3"},
+		// nested contexts: results are merged in document order without duplicates
+		{"//item//item",                  "item#1.1 item#1.1.1"},
+		{"//item/item",                   "item#1.1 item#1.1.1"},
+		{"//item/*",                      "item#1.1 item#1.1.1 m:item#2.m name#"},
+		{"//item//item/@id",              "@id=1.1 @id=1.1.1"},
+	};
+
+	for (auto & [path, expected] : cases)
+	{
+		BOOST_TEST_CONTEXT("path = " << path)
+		{
+			auto nodes = native_select_xpath(root, path);
+			BOOST_CHECK_EQUAL(describe(nodes), expected);
+			BOOST_CHECK_EQUAL(native_find_xpath(root, path), nodes.empty() ? nullptr : nodes.front());
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()